@@ -60,6 +60,7 @@ class Editor:
         self.water_rect = None
         self.lava_list = []
         self.lava_rect = None
+        self.fluid_list = [] # cell fluid, not editable here but kept when saving
         self.player_spawn_pos = [40, 40]
         self.portal_pos = [50.0, 10.0]
         self.load(self.path)
@@ -107,6 +108,7 @@ class Editor:
                 self.water_list.append(pygame.Rect(rect[0] * 8, rect[1] * 8, rect[2] * 8, rect[3] * 8))
             for rect in data['level']['lava']:
                 self.lava_list.append(pygame.Rect(rect[0] * 8, rect[1] * 8, rect[2] * 8, rect[3] * 8))
+            self.fluid_list = data['level'].get('fluid', [])
             self.off_grid.extend(data['level']['off_grid'])
             for tile in self.off_grid:
                 tile['type'] = CONVERT_TYPES[tile['type']]
@@ -142,7 +144,7 @@ class Editor:
                     if tile['type'] == CONVERT_TYPES[key]:
                         tile_type = key
                 off_grid.append({'pos': tile['pos'], 'type': tile_type, 'variant': tile['variant']});
-            json.dump({'level': {'tiles': tiles, 'entities': entities, 'springs': springs, 'off_grid': off_grid, 'water': [[int(rect.x / 8), int(rect.y / 8), int(rect.w / 8), int(rect.h / 8)] for rect in self.water_list], 'lava': [[int(rect.x / 8), int(rect.y / 8), int(rect.w / 8), int(rect.h / 8)] for rect in self.lava_list]}, 'player_spawn_pos': self.player_spawn_pos, 'portal_pos': self.portal_pos}, f)
+            json.dump({'level': {'tiles': tiles, 'entities': entities, 'springs': springs, 'off_grid': off_grid, 'water': [[int(rect.x / 8), int(rect.y / 8), int(rect.w / 8), int(rect.h / 8)] for rect in self.water_list], 'lava': [[int(rect.x / 8), int(rect.y / 8), int(rect.w / 8), int(rect.h / 8)] for rect in self.lava_list], 'fluid': self.fluid_list}, 'player_spawn_pos': self.player_spawn_pos, 'portal_pos': self.portal_pos}, f)
             f.close()
 
     def load_tileset(self, sheet):
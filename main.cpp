@@ -1,20 +1,44 @@
 #include <iostream>
 #include <fstream>
+#include <string>
+#include <cstdlib>
 
 #define SDL_MAIN_HANDLED
 
 #include "SDL2/SDL.h"
 #include "src/game.hpp"
+#include "src/bench.hpp"
 
 int main(int argc, char* argv[])
 {
+    if (argc > 2 && std::string{argv[1]} == "--bench")
+    {
+        return Bench::run(argv[2]);
+    }
+    // --headless [frames] [level]: no window, GPU or sound, prints frame times at the end
+    const bool headless{argc > 1 && std::string{argv[1]} == "--headless"};
+    if (headless)
+    {
+        SDL_SetHint(SDL_HINT_VIDEODRIVER, "dummy");
+        SDL_SetHint(SDL_HINT_AUDIODRIVER, "dummy");
+        SDL_SetHint(SDL_HINT_RENDER_DRIVER, "software");
+        SDL_SetHint(SDL_HINT_RENDER_VSYNC, "0");
+    }
     if (SDL_Init(SDL_INIT_VIDEO))
     {
         std::cerr << "Failed to initialize SDL! SDL_Error: " << SDL_GetError() << '\n';
         return 0;
     }
+    int result{0};
     Game game{};
-    game.start();
+    if (headless)
+    {
+        const int frames{argc > 2 ? std::atoi(argv[2]) : HEADLESS_DEFAULT_FRAMES};
+        const int level{argc > 3 ? std::atoi(argv[3]) - 1 : 0};
+        result = game.startHeadless(frames, level);
+    } else {
+        game.start();
+    }
     game.Close();
     std::cout << "Finished!\n";
 
@@ -24,5 +48,5 @@ int main(int argc, char* argv[])
     Mix_Quit();
     SDL_Quit();
     std::cout << "Quit SDL!\n";
-    return 0;
+    return result;
 }
\ No newline at end of file
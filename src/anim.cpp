@@ -1,45 +1,38 @@
 #include "./anim.hpp"
 
-Anim::Anim(int w, int h, int length, double speed, bool loop, Texture* texture)
- : _width{w}, _height{h}, _length{length}, _speed{speed}, _loop{loop}, _texture{texture}
+Anim::Anim(const AnimDef& def)
+ : _def{&def}
 {
 }
 
-Anim::~Anim()
+void Anim::play(const AnimDef& def)
 {
-}
-
-void Anim::setTex(Texture* texture)
-{
-    _texture = texture;
+    if (_def != &def)
+    {
+        _def = &def;
+        reset();
+    }
 }
 
 void Anim::reset()
 {
     _finished = false;
     _frame = 0.0;
-    _step = 0;
 }
 
 void Anim::tick(const double& time_step)
 {
-    _frame += _speed * time_step;
-    if (!_loop)
+    _frame += _def->speed * time_step;
+    if (_def->isFinished(_frame))
     {
-        if (_frame > (double)_length)
-        {
-            _finished = true;
-        }
-        // cap frame to last anim. frame
-        _step = std::min(static_cast<int>(_frame), _length - 1);
-    } else {
-        _step = static_cast<int>(_frame) % _length;
+        _finished = true;
     }
 }
 
-void Anim::render(int x, int y, const int scrollX, const int scrollY, SDL_Renderer* renderer)
+void Anim::render(Texture& texture, int x, int y, const int scrollX, const int scrollY, SDL_Renderer* renderer, const double angle, const SDL_RendererFlip flip) const
 {
-    SDL_Rect clip_rect {_step * _width, 0, _width, _height}; // all animation spritesheets are single strips
-    SDL_Point center {_width / 2, _height / 2};
-    _texture->render(x - scrollX, y - scrollY, renderer, _angle, &center, _flipped, &clip_rect);
-}
\ No newline at end of file
+    const int step{getStep()};
+    SDL_Rect clip_rect {step * _def->width, 0, _def->width, _def->height}; // all animation spritesheets are single strips
+    SDL_Point center {_def->width / 2, _def->height / 2};
+    texture.render(x - scrollX, y - scrollY, renderer, angle, &center, flip, &clip_rect);
+}
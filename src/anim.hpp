@@ -2,57 +2,68 @@
 #define ANIM_H
 
 #include "./texture.hpp"
+#include "./texman.hpp"
 #include <cmath>
+#include <algorithm>
 
-class Anim
+// frame size, length & speed of a single strip spritesheet. Never changes, so every instance
+// playing it points at the same one
+struct AnimDef
 {
-private:
-    SDL_RendererFlip _flipped {SDL_FLIP_NONE};
+    int width;
+    int height;
+    int length;
+    double speed;
+    bool loop;
+
+    // frame of the strip to show for a frame counter
+    int getStep(const double frame) const
+    {
+        return loop ? static_cast<int>(frame) % length : std::min(static_cast<int>(frame), length - 1);
+    }
 
-    double _angle{0};
+    bool isFinished(const double frame) const {return !loop && frame > static_cast<double>(length);}
+};
 
-    const int _width;
-    const int _height;
+// an AnimDef with the texture it plays from. Textures live in TexMan, so it's a member pointer
+struct ClipDef
+{
+    Texture TexMan::* texture; // nullptr for no sprite
+    AnimDef anim;
+};
 
-    const int _length;
-    double _frame{0.0};
-    double _speed;
-    bool _loop;
+inline constexpr ClipDef NO_CLIP{nullptr, {0, 0, 1, 0.0, true}};
 
+// what one instance needs to play an AnimDef, the def itself is shared
+class Anim
+{
+private:
+    const AnimDef* _def;
+    double _frame{0.0};
     bool _finished{false};
 
-    int _step{0};
-
-    Texture* _texture;
-
 public:
-    Anim(int w, int h, int length, double speed, bool loop, Texture* texture);
-    ~Anim();
+    Anim(const AnimDef& def);
+
+    const AnimDef& getDef() const {return *_def;}
 
-    void setTex(Texture* texture);
-    Texture* getTex() {return _texture;}
+    // switch to another def, starting from the beginning. Does nothing if it's already playing
+    void play(const AnimDef& def);
 
-    SDL_RendererFlip getFlipped() {return _flipped;}
-    void setFlipped(SDL_RendererFlip flip) {_flipped = flip;}
-    bool getFinished() {return _finished;}
+    bool getFinished() const {return _finished;}
     void setFinished(bool val) {_finished = val;}
-    void setAngle(double val) {_angle = val;}
-    double getAngle() {return _angle;}
     void reset();
 
-    double getFrame() {return _frame;}
+    double getFrame() const {return _frame;}
+    void setFrame(double frame) {_frame = frame;}
 
-    void setFrame(double frame)
-    {
-        _frame = frame;
-        _step = static_cast<int>(_frame) % _length;
-    }
+    int getStep() const {return _def->getStep(_frame);}
 
     // update
     void tick(const double& time_step);
 
     // render
-    void render(int x, int y, const int scrollX, const int scrollY, SDL_Renderer* renderer);
+    void render(Texture& texture, int x, int y, const int scrollX, const int scrollY, SDL_Renderer* renderer, const double angle = 0.0, const SDL_RendererFlip flip = SDL_FLIP_NONE) const;
 };
 
-#endif
\ No newline at end of file
+#endif
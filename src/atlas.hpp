@@ -0,0 +1,243 @@
+#ifndef ATLAS_H
+#define ATLAS_H
+
+#include "SDL2/SDL.h"
+
+#include "./texture.hpp"
+
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <numeric>
+
+// packs a pile of small images into a few big pages at load, so everything drawn from them shares
+// one SDL_Texture and batches together. The Textures turn into views of their bit of the page
+
+inline constexpr int ATLAS_PAGE_SIZE{1024}; // px, or the renderer's max if that's smaller
+inline constexpr int ATLAS_PADDING{1}; // px between sprites so linear filtering can't bleed
+
+struct AtlasPlacement
+{
+    int page; // -1 if it's too big for a page
+    SDL_Rect rect;
+};
+
+struct AtlasShelf
+{
+    int y;
+    int height;
+    int x; // where the next one goes
+};
+
+// shelf packer: tallest first, left to right along a shelf, a new shelf under the last one when a row
+// fills up & a new page when that runs out. With sprites this close in size it wastes very little
+class AtlasPacker
+{
+private:
+    std::vector<std::vector<AtlasShelf>> _Pages{};
+    std::vector<SDL_Point> _Used{}; // furthest right & down anything on each page goes
+    int _page_size{ATLAS_PAGE_SIZE};
+
+    bool place(const int page, const int w, const int h, SDL_Rect& rect)
+    {
+        std::vector<AtlasShelf>& shelves{_Pages[page]};
+        for (AtlasShelf& shelf : shelves)
+        {
+            if (h <= shelf.height && shelf.x + w <= _page_size)
+            {
+                rect = {shelf.x, shelf.y, w, h};
+                shelf.x += w + ATLAS_PADDING;
+                return true;
+            }
+        }
+        const int y{shelves.empty() ? 0 : shelves.back().y + shelves.back().height + ATLAS_PADDING};
+        if (y + h > _page_size)
+        {
+            return false;
+        }
+        shelves.push_back(AtlasShelf{y, h, w + ATLAS_PADDING});
+        rect = {0, y, w, h};
+        return true;
+    }
+
+public:
+    AtlasPacker()
+    {
+    }
+
+    // placements come back in the same order as sizes
+    void pack(const std::vector<SDL_Point>& sizes, const int page_size, std::vector<AtlasPlacement>& placements)
+    {
+        _Pages.clear();
+        _Used.clear();
+        _page_size = page_size;
+        placements.assign(sizes.size(), AtlasPlacement{-1, SDL_Rect{0, 0, 0, 0}});
+
+        std::vector<std::size_t> order(sizes.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&](const std::size_t a, const std::size_t b)
+        {
+            return sizes[a].y != sizes[b].y ? sizes[a].y > sizes[b].y : sizes[a].x > sizes[b].x;
+        });
+
+        for (const std::size_t i : order)
+        {
+            const int w{sizes[i].x};
+            const int h{sizes[i].y};
+            if (w > _page_size || h > _page_size)
+            {
+                continue;
+            }
+            SDL_Rect rect{};
+            int page{0};
+            while (page < static_cast<int>(_Pages.size()) && !place(page, w, h, rect))
+            {
+                ++page;
+            }
+            if (page == static_cast<int>(_Pages.size()))
+            {
+                _Pages.emplace_back();
+                _Used.push_back(SDL_Point{0, 0});
+                place(page, w, h, rect);
+            }
+            _Used[page].x = std::max(_Used[page].x, rect.x + w);
+            _Used[page].y = std::max(_Used[page].y, rect.y + h);
+            placements[i] = AtlasPlacement{page, rect};
+        }
+    }
+
+    int getPages() const {return static_cast<int>(_Pages.size());}
+    // pages only need to be as big as what's on them
+    SDL_Point getPageSize(const int page) const {return _Used[page];}
+};
+
+class Atlas
+{
+private:
+    std::vector<SDL_Texture*> _Pages{};
+    AtlasPacker _Packer{};
+    std::vector<AtlasPlacement> _Placements{};
+    int _sprites{0};
+    long _area{0}; // px of sprite
+    long _page_area{0}; // px of page
+
+public:
+    Atlas()
+    {
+    }
+
+    ~Atlas()
+    {
+        free();
+    }
+
+    // destroys the pages, so free the views first
+    void free()
+    {
+        for (SDL_Texture* page : _Pages)
+        {
+            RenderState::forget(page);
+            SDL_DestroyTexture(page);
+        }
+        _Pages.clear();
+        _sprites = 0;
+        _area = 0;
+        _page_area = 0;
+    }
+
+    // textures need their pixels loaded (loadPixelsFromFile) but no texture made yet. Anything that
+    // doesn't fit on a page just becomes a texture of its own
+    bool pack(const std::vector<Texture*>& textures, SDL_Renderer* renderer)
+    {
+        free();
+        int page_size{ATLAS_PAGE_SIZE};
+        SDL_RendererInfo info{};
+        if (SDL_GetRendererInfo(renderer, &info) == 0 && info.max_texture_width > 0 && info.max_texture_height > 0)
+        {
+            page_size = std::min({page_size, info.max_texture_width, info.max_texture_height});
+        }
+
+        std::vector<SDL_Point> sizes{};
+        for (Texture* texture : textures)
+        {
+            sizes.push_back(texture->getSurface() != NULL ? SDL_Point{texture->getWidth(), texture->getHeight()} : SDL_Point{page_size + 1, 0});
+        }
+        _Packer.pack(sizes, page_size, _Placements);
+
+        bool success{true};
+        std::vector<SDL_Surface*> surfaces{};
+        for (int p{0}; p < _Packer.getPages(); ++p)
+        {
+            const SDL_Point size{_Packer.getPageSize(p)};
+            SDL_Surface* surface{SDL_CreateRGBSurfaceWithFormat(0, size.x, size.y, 32, SDL_PIXELFORMAT_ARGB8888)};
+            if (surface == NULL)
+            {
+                std::cout << "ATLAS::PACK Unable to create page surface! SDL_Error: " << SDL_GetError() << '\n';
+                success = false;
+            } else {
+                SDL_FillRect(surface, NULL, SDL_MapRGBA(surface->format, 0, 0, 0, 0));
+            }
+            surfaces.push_back(surface);
+            _page_area += static_cast<long>(size.x) * size.y;
+        }
+
+        for (std::size_t i{0}; i < textures.size(); ++i)
+        {
+            SDL_Surface* pixels{textures[i]->getSurface()};
+            const AtlasPlacement& placement{_Placements[i]};
+            if (pixels == NULL || placement.page < 0 || surfaces[placement.page] == NULL)
+            {
+                continue;
+            }
+            // black is see-through, same as loadFromPixels
+            SDL_SetColorKey(pixels, SDL_TRUE, SDL_MapRGB(pixels->format, 0, 0, 0));
+            SDL_SetSurfaceBlendMode(pixels, SDL_BLENDMODE_NONE);
+            SDL_Rect dst{placement.rect};
+            SDL_BlitSurface(pixels, NULL, surfaces[placement.page], &dst);
+        }
+
+        for (int p{0}; p < _Packer.getPages(); ++p)
+        {
+            SDL_Texture* page{surfaces[p] != NULL ? SDL_CreateTextureFromSurface(renderer, surfaces[p]) : NULL};
+            if (page == NULL && surfaces[p] != NULL)
+            {
+                std::cout << "ATLAS::PACK Unable to create page texture! SDL_Error: " << SDL_GetError() << '\n';
+                success = false;
+            }
+            if (page != NULL)
+            {
+                SDL_SetTextureBlendMode(page, SDL_BLENDMODE_BLEND);
+            }
+            _Pages.push_back(page);
+            SDL_FreeSurface(surfaces[p]);
+        }
+
+        for (std::size_t i{0}; i < textures.size(); ++i)
+        {
+            const AtlasPlacement& placement{_Placements[i]};
+            if (textures[i]->getSurface() == NULL)
+            {
+                continue;
+            }
+            if (placement.page < 0 || _Pages[placement.page] == NULL)
+            {
+                textures[i]->loadFromPixels(renderer);
+                continue;
+            }
+            const SDL_Point size{_Packer.getPageSize(placement.page)};
+            textures[i]->setView(_Pages[placement.page], placement.rect, size.x, size.y);
+            _area += static_cast<long>(placement.rect.w) * placement.rect.h;
+            ++_sprites;
+        }
+        return success;
+    }
+
+    int getPages() const {return static_cast<int>(_Pages.size());}
+    int getSprites() const {return _sprites;}
+    // how much of the pages is sprite, 0-1
+    double getFill() const {return _page_area > 0 ? static_cast<double>(_area) / static_cast<double>(_page_area) : 0.0;}
+    const AtlasPacker& getPacker() const {return _Packer;}
+    const std::vector<AtlasPlacement>& getPlacements() const {return _Placements;}
+};
+
+#endif
@@ -0,0 +1,145 @@
+#ifndef BACKGROUND_H
+#define BACKGROUND_H
+
+#include "SDL2/SDL.h"
+
+#include "./texman.hpp"
+#include "./spritebatch.hpp"
+#include "./stars.hpp"
+#include "./clouds.hpp"
+
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <cstdint>
+
+// which layers a background has
+enum BackgroundLayers : uint8_t
+{
+    BACKGROUND_STARS = 1 << 0,
+    BACKGROUND_MOON = 1 << 1,
+    BACKGROUND_BACKDROP = 1 << 2,
+    BACKGROUND_CLOUDS = 1 << 3,
+    BACKGROUND_ALL = BACKGROUND_STARS | BACKGROUND_MOON | BACKGROUND_BACKDROP | BACKGROUND_CLOUDS
+};
+
+inline constexpr int BACKGROUND_STAR_COUNT{100};
+inline constexpr int BACKGROUND_CLOUD_COUNT{12};
+inline constexpr int BACKGROUND_CLOUD_STRIP_WIDTH{512}; // px, how far the baked clouds go before they repeat
+inline constexpr int BACKGROUND_CLOUD_STRIP_HEIGHT{64};
+
+// a texture tiled sideways across the view & scrolled slower than the world. Only the copies that
+// are on screen get drawn, so it's a couple of quads however wide the level is
+struct ParallaxStrip
+{
+    Texture* texture;
+    SpriteLayer layer;
+    double depth; // how much of the camera's movement it follows, 0 stays put
+    double drift; // px per tick it moves sideways on its own
+    int y; // screen y of its top when the camera is at the top of the level
+    double offset{0.0}; // how far it's drifted
+};
+
+// everything behind the level, far to near: the backdrop, stars, the moon & clouds. Every layer goes
+// through the SpriteBatch, either as loose sprites that batch into one submission (stars) or as a
+// texture that's tiled & scrolled (the backdrop, and the clouds, which are baked into a strip once
+// at load)
+class Background
+{
+private:
+    StarManager _Stars{BACKGROUND_STAR_COUNT};
+    CloudManager _Clouds{BACKGROUND_CLOUD_COUNT};
+    Texture _CloudStrip{};
+    std::vector<ParallaxStrip> _Strips{};
+    Texture* _moon{nullptr};
+    uint8_t _layers{0};
+
+    void renderStrip(ParallaxStrip& strip, const double& time_step, const int scrollX, const int scrollY, const int width, const int height, SpriteBatch& batch)
+    {
+        const int strip_width{strip.texture->getWidth()};
+        if (strip_width <= 0)
+        {
+            return;
+        }
+        strip.offset = std::fmod(strip.offset + strip.drift * time_step, static_cast<double>(strip_width));
+        const double scrolled{static_cast<double>(scrollX) * strip.depth - strip.offset};
+        int x{-static_cast<int>(std::fmod(scrolled, static_cast<double>(strip_width)))};
+        if (x > 0)
+        {
+            x -= strip_width;
+        }
+        const int y{strip.y - static_cast<int>(static_cast<double>(scrollY) * strip.depth)};
+        if (y >= height || y + strip.texture->getHeight() <= 0)
+        {
+            return;
+        }
+        for (; x < width; x += strip_width)
+        {
+            batch.draw(*strip.texture, strip.layer, x, y);
+        }
+    }
+
+public:
+    Background()
+    {
+    }
+
+    ~Background()
+    {
+        free();
+    }
+
+    void free()
+    {
+        _CloudStrip.free();
+        _Strips.clear();
+        _moon = nullptr;
+        _layers = 0;
+    }
+
+    // needs the renderer for baking the clouds
+    bool load(TexMan& texman, SDL_Renderer* renderer, const uint8_t layers)
+    {
+        free();
+        _layers = layers;
+        bool success{true};
+        _Stars.setTex(&texman.lightTex);
+        _moon = &texman.moon;
+        if (layers & BACKGROUND_BACKDROP)
+        {
+            _Strips.push_back(ParallaxStrip{&texman.backdropTex, SpriteLayer::BACKDROP, 0.05, 0.0, 0});
+        }
+        if (layers & BACKGROUND_CLOUDS)
+        {
+            _Clouds.setTex(&texman.cloud_dark);
+            if (_CloudStrip.createBlank(BACKGROUND_CLOUD_STRIP_WIDTH, BACKGROUND_CLOUD_STRIP_HEIGHT, renderer, SDL_TEXTUREACCESS_TARGET))
+            {
+                _CloudStrip.setBlendMode(SDL_BLENDMODE_BLEND);
+                _Clouds.bake(_CloudStrip, renderer);
+                _Strips.push_back(ParallaxStrip{&_CloudStrip, SpriteLayer::CLOUDS, 0.2, 0.05, 120});
+            } else {
+                std::cout << "BACKGROUND::LOAD Failed to create the cloud strip!\n";
+                success = false;
+            }
+        }
+        return success;
+    }
+
+    void render(const double& time_step, const int scrollX, const int scrollY, const int width, const int height, SpriteBatch& batch)
+    {
+        for (ParallaxStrip& strip : _Strips)
+        {
+            renderStrip(strip, time_step, scrollX, scrollY, width, height, batch);
+        }
+        if (_layers & BACKGROUND_STARS)
+        {
+            _Stars.update(time_step, scrollX, scrollY, width, height, batch);
+        }
+        if ((_layers & BACKGROUND_MOON) && _moon != nullptr)
+        {
+            batch.draw(*_moon, SpriteLayer::SKY, width - 32, 32);
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,204 @@
+#ifndef BEHAVIOUR_H
+#define BEHAVIOUR_H
+
+#include <coroutine>
+#include <exception>
+#include <utility>
+#include <algorithm>
+#include <vector>
+#include <array>
+#include <cstdint>
+#include <cmath>
+
+// entity behaviours as coroutines. A behaviour runs until it co_awaits a wait, then it costs nothing
+// at all until its timer comes round on the TimerWheel or a system signals something it's waiting for
+
+// things a behaviour can wait for, posted by the systems as they happen
+enum BehaviourSignal : uint8_t
+{
+    SIGNAL_NONE = 0,
+    SIGNAL_STOMPED = 1 << 0 // jumped on by the player
+};
+
+class Behaviour;
+
+struct BehaviourPromise
+{
+    double ticks{0.0}; // how long it asked to sleep for, 0 for until it's signalled
+    uint8_t waiting{SIGNAL_NONE}; // signals that wake it early
+    uint8_t woke{SIGNAL_NONE}; // what woke it, SIGNAL_NONE if it was the timer
+    uint32_t token{0}; // bumped whenever it's woken or rescheduled, so old timers can be told apart
+
+    Behaviour get_return_object();
+    std::suspend_always initial_suspend() noexcept {return {};}
+    std::suspend_always final_suspend() noexcept {return {};}
+    void return_void() {}
+    void unhandled_exception() {std::terminate();}
+};
+
+using BehaviourHandle = std::coroutine_handle<BehaviourPromise>;
+
+// owns the coroutine, it's destroyed along with whatever it's suspended in
+class Behaviour
+{
+private:
+    BehaviourHandle _handle{};
+
+public:
+    using promise_type = BehaviourPromise;
+
+    Behaviour()
+    {
+    }
+
+    explicit Behaviour(const BehaviourHandle handle)
+        : _handle{handle}
+    {
+    }
+
+    Behaviour(const Behaviour&) = delete;
+    Behaviour& operator=(const Behaviour&) = delete;
+
+    Behaviour(Behaviour&& other) noexcept
+        : _handle{std::exchange(other._handle, {})}
+    {
+    }
+
+    Behaviour& operator=(Behaviour&& other) noexcept
+    {
+        if (this != &other)
+        {
+            free();
+            _handle = std::exchange(other._handle, {});
+        }
+        return *this;
+    }
+
+    ~Behaviour()
+    {
+        free();
+    }
+
+    void free()
+    {
+        if (_handle)
+        {
+            _handle.destroy();
+            _handle = {};
+        }
+    }
+
+    bool valid() const {return static_cast<bool>(_handle);}
+    bool done() const {return _handle.done();}
+    void resume() {_handle.resume();}
+    BehaviourPromise& getPromise() {return _handle.promise();}
+};
+
+inline Behaviour BehaviourPromise::get_return_object()
+{
+    return Behaviour{BehaviourHandle::from_promise(*this)};
+}
+
+// what a behaviour co_awaits, gives back the signal that woke it (SIGNAL_NONE if the time ran out)
+struct BehaviourWait
+{
+    double ticks;
+    uint8_t signals;
+    BehaviourHandle handle{};
+
+    bool await_ready() const noexcept {return ticks <= 0.0 && signals == SIGNAL_NONE;}
+
+    void await_suspend(const BehaviourHandle h) noexcept
+    {
+        handle = h;
+        BehaviourPromise& promise{h.promise()};
+        promise.ticks = ticks;
+        promise.waiting = signals;
+        promise.woke = SIGNAL_NONE;
+    }
+
+    uint8_t await_resume() const noexcept {return handle ? handle.promise().woke : static_cast<uint8_t>(SIGNAL_NONE);}
+};
+
+// ticks are 60ths of a second of game time, same as time_step
+inline BehaviourWait waitTicks(const double ticks)
+{
+    return BehaviourWait{ticks, SIGNAL_NONE};
+}
+
+// until one of signals happens, or ticks run out (0 waits as long as it takes)
+inline BehaviourWait waitUntil(const uint8_t signals, const double ticks = 0.0)
+{
+    return BehaviourWait{ticks, signals};
+}
+
+inline constexpr std::size_t TIMER_WHEEL_SLOTS{256}; // ticks, longer waits go round more than once
+
+struct TimerEntry
+{
+    uint64_t due; // tick it fires on
+    uint32_t id; // whose it is
+    uint32_t token; // BehaviourPromise::token when it was scheduled
+};
+
+// hashed timer wheel: a slot for each tick, timers go in the slot their due tick lands in. Advancing
+// only ever looks at the slots that came round, so sleeping timers cost nothing
+class TimerWheel
+{
+private:
+    std::array<std::vector<TimerEntry>, TIMER_WHEEL_SLOTS> _Slots{};
+    double _time{0.0}; // game time, in ticks
+    uint64_t _now{0}; // last whole tick fired
+    std::size_t _size{0};
+
+public:
+    TimerWheel()
+    {
+    }
+
+    void clear()
+    {
+        for (std::vector<TimerEntry>& slot : _Slots)
+        {
+            slot.clear();
+        }
+        _size = 0;
+    }
+
+    double getTime() const {return _time;}
+    std::size_t size() const {return _size;}
+
+    // rounded up to a whole tick so it never fires early
+    void schedule(const double ticks, const uint32_t id, const uint32_t token)
+    {
+        const uint64_t due{_now + std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(ticks)))};
+        _Slots[due % TIMER_WHEEL_SLOTS].push_back(TimerEntry{due, id, token});
+        ++_size;
+    }
+
+    // moves game time on, appending every timer that came due in the order they fired
+    void advance(const double time_step, std::vector<TimerEntry>& due)
+    {
+        _time += time_step;
+        while (static_cast<double>(_now + 1) <= _time)
+        {
+            ++_now;
+            std::vector<TimerEntry>& slot{_Slots[_now % TIMER_WHEEL_SLOTS]};
+            // anything here for a later lap stays put
+            std::size_t kept{0};
+            for (const TimerEntry& entry : slot)
+            {
+                if (entry.due == _now)
+                {
+                    due.push_back(entry);
+                } else {
+                    slot[kept++] = entry;
+                }
+            }
+            _size -= slot.size() - kept;
+            slot.resize(kept);
+        }
+    }
+};
+
+#endif
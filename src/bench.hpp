@@ -0,0 +1,640 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include "./constants.hpp"
+#include "./cellfluid.hpp"
+#include "./entities.hpp"
+#include "./flowfield.hpp"
+#include "./flock.hpp"
+#include "./spritebatch.hpp"
+#include "./background.hpp"
+#include "./shockwaves.hpp"
+#include "./coin.hpp"
+#include "./particles.hpp"
+#include "./renderstate.hpp"
+#include "./atlas.hpp"
+#include "./texman.hpp"
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+
+// command line benchmarks, run with: Defblade --bench <name>
+// these don't open a window, they just time the simulation code
+namespace Bench
+{
+    using Clock = std::chrono::steady_clock;
+
+    inline double getSeconds(const Clock::time_point start)
+    {
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    }
+
+    // a level sized grid with a floor, some basins and ledges, and a big block of water up top to pour over them
+    inline void makeFluidLevel(CellFluid& fluid)
+    {
+        std::vector<uint8_t> solid(LEVEL_TILE_WIDTH * LEVEL_TILE_HEIGHT, 0);
+        for (int x{0}; x < LEVEL_TILE_WIDTH; ++x)
+        {
+            solid[(LEVEL_TILE_HEIGHT - 1) * LEVEL_TILE_WIDTH + x] = 1;
+        }
+        for (int b{0}; b < 6; ++b)
+        {
+            // basin: floor with walls on each side
+            const int left{4 + b * 20};
+            const int floor{LEVEL_TILE_HEIGHT - 8 - (b % 3) * 10};
+            for (int x{left}; x < left + 14; ++x)
+            {
+                solid[floor * LEVEL_TILE_WIDTH + x] = 1;
+            }
+            for (int y{floor - 5}; y < floor; ++y)
+            {
+                solid[y * LEVEL_TILE_WIDTH + left] = 1;
+                solid[y * LEVEL_TILE_WIDTH + left + 13] = 1;
+            }
+        }
+        fluid.init(LEVEL_TILE_WIDTH, LEVEL_TILE_HEIGHT, solid);
+        fluid.fillRect(SDL_Rect{10, 2, LEVEL_TILE_WIDTH - 20, 16}, CELL_MAX_MASS);
+    }
+
+    inline int fluid()
+    {
+        constexpr int steps{1200};
+        for (const int threads : {1, CELL_MAX_THREADS})
+        {
+            CellFluid fluid{};
+            makeFluidLevel(fluid);
+            fluid.setThreads(threads);
+            const float start_mass{fluid.getTotalMass()};
+            const Clock::time_point start{Clock::now()};
+            int peak{0};
+            for (int i{0}; i < steps; ++i)
+            {
+                fluid.forceStep();
+                peak = std::max(peak, fluid.getActive());
+            }
+            const double seconds{getSeconds(start)};
+            std::cout << "fluid (" << threads << " thread" << (threads > 1 ? "s" : "") << "): "
+                      << fluid.getUpdates() << " cell updates in " << seconds * 1000.0 << "ms, "
+                      << static_cast<double>(fluid.getUpdates()) / seconds / 1000000.0 << "M cells/s, "
+                      << seconds / steps * 1000000.0 << "us/step, peak active " << peak
+                      << ", still active " << fluid.getActive()
+                      << ", mass " << start_mass << " -> " << fluid.getTotalMass() << '\n';
+        }
+        return 0;
+    }
+
+    // a flat floor along the bottom of the level, goes through the same loader as the map files
+    inline json makeFlatLevel()
+    {
+        json tiles = json::array();
+        for (int x{0}; x < LEVEL_TILE_WIDTH; ++x)
+        {
+            tiles.push_back({{"pos", {x, LEVEL_TILE_HEIGHT - 1}}, {"type", 1}, {"variant", 0}});
+        }
+        json data;
+        data["level"]["tiles"] = tiles;
+        data["level"]["off_grid"] = json::array();
+        data["level"]["springs"] = json::array();
+        return data;
+    }
+
+    // the flat level with rows of platforms over it, so walkers have to jump & drop to get around
+    inline json makePlatformLevel()
+    {
+        json data = makeFlatLevel();
+        for (int row{0}; row < 6; ++row)
+        {
+            const int y{LEVEL_TILE_HEIGHT - 4 - row * 3};
+            for (int x{(row % 2) * 6 + 2}; x < LEVEL_TILE_WIDTH - 2; x += 12)
+            {
+                for (int w{0}; w < 6; ++w)
+                {
+                    data["level"]["tiles"].push_back({{"pos", {x + w, y}}, {"type", 1}, {"variant", 0}});
+                }
+            }
+        }
+        return data;
+    }
+
+    // player walking along the floor, one tile at a time. Each tile change means a new search for both layers
+    inline int flow()
+    {
+        World world{};
+        world.loadFromJson(makePlatformLevel());
+        FlowField field{};
+        const Clock::time_point init_start{Clock::now()};
+        field.init(world);
+        std::cout << "flow: init in " << getSeconds(init_start) * 1000.0 << "ms\n";
+
+        const double floor_y{(LEVEL_TILE_HEIGHT - 1.5) * TILE_SIZE};
+        int frames{0};
+        int searches{0};
+        double worst{0.0};
+        const Clock::time_point start{Clock::now()};
+        for (int x{1}; x < LEVEL_TILE_WIDTH - 1; ++x)
+        {
+            const vec2<double> player_pos{(x + 0.5) * TILE_SIZE, floor_y};
+            do
+            {
+                const Clock::time_point frame_start{Clock::now()};
+                field.update(player_pos);
+                worst = std::max(worst, getSeconds(frame_start));
+                ++frames;
+            } while (field.isSearching(FlowLayer::WALKER) || field.isSearching(FlowLayer::FLYER));
+            ++searches;
+        }
+        const double seconds{getSeconds(start)};
+        vec2<int> step{};
+        const bool reachable{field.getStep(FlowLayer::WALKER, {TILE_SIZE * 9.5, (LEVEL_TILE_HEIGHT - 4 - 15 - 0.5) * TILE_SIZE}, step)};
+        std::cout << "flow: " << searches << " searches over " << frames << " frames, "
+                  << seconds / searches * 1000.0 << "ms per search (both layers), "
+                  << worst * 1000000.0 << "us worst frame (budget " << FLOW_BUDGET << " cells), "
+                  << "top platform " << (reachable ? "reachable" : "NOT reachable") << " for walkers\n";
+        return 0;
+    }
+
+    // random rays across the platform level, one at a time and batched
+    inline int raycast()
+    {
+        World world{};
+        world.loadFromJson(makePlatformLevel());
+        constexpr int num{1000000};
+        std::vector<Ray> rays{};
+        rays.reserve(num);
+        const double width{static_cast<double>(LEVEL_TILE_WIDTH * TILE_SIZE)};
+        const double height{static_cast<double>(LEVEL_TILE_HEIGHT * TILE_SIZE)};
+        for (int i{0}; i < num; ++i)
+        {
+            const double angle{Util::random() * 2.0 * M_PI};
+            rays.push_back(Ray{{Util::random() * width, Util::random() * (height - TILE_SIZE * 2)}, {std::cos(angle), std::sin(angle)}, 200.0});
+        }
+
+        Clock::time_point start{Clock::now()};
+        int hits{0};
+        for (const Ray& ray : rays)
+        {
+            hits += world.raycast(ray).hit;
+        }
+        double seconds{getSeconds(start)};
+        std::cout << "raycast (single): " << num / seconds / 1000000.0 << "M rays/s, " << hits << " hits\n";
+
+        std::vector<RayHit> results{};
+        start = Clock::now();
+        world.raycast(rays, results);
+        seconds = getSeconds(start);
+        hits = 0;
+        for (const RayHit& hit : results)
+        {
+            hits += hit.hit;
+        }
+        std::cout << "raycast (batched): " << num / seconds / 1000000.0 << "M rays/s, " << hits << " hits\n";
+        return 0;
+    }
+
+    // lots of slimes wandering around on a flat floor, with the player far away so none of them die.
+    // once with the whole level in view, once with a normal sized view so the activity tiers kick in
+    inline int slimes()
+    {
+        constexpr int frames{600};
+        World world{};
+        world.loadFromJson(makeFlatLevel());
+        TexMan texman{};
+        Player player{{-1000.0, -1000.0}, {4, 8}};
+        const SDL_Rect level{0, 0, LEVEL_TILE_WIDTH * TILE_SIZE, LEVEL_TILE_HEIGHT * TILE_SIZE};
+        const SDL_Rect screen{TILE_SIZE, level.h - SCR_HEIGHT, SCR_WIDTH, SCR_HEIGHT};
+        for (const int num : {1000, 10000, 20000})
+        {
+            for (const SDL_Rect& view : {level, screen})
+            {
+                EventQueue events{};
+                EMManager entities{};
+                entities.setTexMan(&texman);
+                entities.getManager(EntityType::SLIME)->reserve(num);
+                const int width{LEVEL_TILE_WIDTH * TILE_SIZE - TILE_SIZE * 4};
+                for (int i{0}; i < num; ++i)
+                {
+                    entities.addEntity(EntityType::SLIME, {static_cast<double>(TILE_SIZE * 2 + (i * 7919) % width), static_cast<double>((LEVEL_TILE_HEIGHT - 3 - i % 8) * TILE_SIZE)});
+                }
+                double screen_shake{0.0};
+                double slomo{1.0};
+                Broadphase bodies{};
+                const Clock::time_point start{Clock::now()};
+                for (int i{0}; i < frames; ++i)
+                {
+                    bodies.clear();
+                    bodies.add(*player.getRect(), BODY_PLAYER);
+                    entities.update(1.0, world, &screen_shake, &player, &slomo, events, nullptr, nullptr, view, bodies);
+                    events.clear();
+                }
+                const double seconds{getSeconds(start)};
+                std::cout << "slimes (" << num << ", " << (view.w == level.w ? "whole level" : "screen") << " view): "
+                          << seconds / frames * 1000.0 << "ms/frame, "
+                          << seconds / frames / num * 1000000000.0 << "ns/entity, tiers "
+                          << entities.getTierCount(ActivityTier::ACTIVE) << '/'
+                          << entities.getTierCount(ActivityTier::REDUCED) << '/'
+                          << entities.getTierCount(ActivityTier::FROZEN) << ", "
+                          << entities.getTotal() << " still alive\n";
+            }
+        }
+        return 0;
+    }
+
+    // entity sized boxes scattered over the level, every overlapping pair found through the grid and by
+    // checking every box against every other one, the counts should match
+    inline int broadphase()
+    {
+        constexpr int frames{100};
+        const int width{LEVEL_TILE_WIDTH * TILE_SIZE};
+        const int height{LEVEL_TILE_HEIGHT * TILE_SIZE};
+        for (const int num : {1000, 10000})
+        {
+            std::vector<SDL_Rect> rects{};
+            rects.reserve(num);
+            for (int i{0}; i < num; ++i)
+            {
+                rects.push_back(SDL_Rect{std::rand() % width, std::rand() % height, 8, 8});
+            }
+            Broadphase bodies{};
+            bodies.reserve(num);
+            std::vector<std::pair<int, int>> pairs{};
+            Clock::time_point start{Clock::now()};
+            for (int f{0}; f < frames; ++f)
+            {
+                bodies.clear();
+                for (int i{0}; i < num; ++i)
+                {
+                    bodies.add(rects[i], BODY_ENTITY, 0, static_cast<uint32_t>(i));
+                }
+                pairs.clear();
+                bodies.queryPairs(BODY_ENTITY, BODY_ENTITY, pairs);
+            }
+            double seconds{getSeconds(start)};
+            std::cout << "broadphase (" << num << "): " << seconds / frames * 1000.0 << "ms/frame build + pairs, " << pairs.size() << " pairs\n";
+
+            start = Clock::now();
+            std::size_t brute{0};
+            for (int i{0}; i < num; ++i)
+            {
+                for (int j{i + 1}; j < num; ++j)
+                {
+                    brute += Util::checkCollision(&rects[i], &rects[j]);
+                }
+            }
+            seconds = getSeconds(start);
+            std::cout << "broadphase (" << num << "): " << seconds * 1000.0 << "ms/frame checking every pair, " << brute << " pairs\n";
+            if (brute != pairs.size())
+            {
+                std::cerr << "broadphase: pair counts don't match!\n";
+                return 1;
+            }
+        }
+        return 0;
+    }
+
+    // swarms spread over the open air of the flat level with the player in the middle, timing just the
+    // steering (neighbours, chase & the batch update). Positions get moved on so the swarm churns
+    inline int boids()
+    {
+        constexpr int frames{300};
+        World world{};
+        world.loadFromJson(makeFlatLevel());
+        FlowField field{};
+        field.init(world);
+        const double width{static_cast<double>(LEVEL_TILE_WIDTH * TILE_SIZE)};
+        const double height{static_cast<double>((LEVEL_TILE_HEIGHT - 2) * TILE_SIZE)};
+        const vec2<double> player_pos{width / 2.0, height - TILE_SIZE};
+        while (field.isSearching(FlowLayer::FLYER) || field.isSearching(FlowLayer::WALKER))
+        {
+            field.update(player_pos);
+        }
+        const vec2<double> half_size{4.0, 4.0};
+        for (const int num : {100, 1000, 10000})
+        {
+            std::vector<vec2<double>> pos{};
+            std::vector<vec2<double>> vel(num, vec2<double>{0.0, 0.0});
+            const std::vector<double> step(num, 1.0);
+            pos.reserve(num);
+            for (int i{0}; i < num; ++i)
+            {
+                pos.push_back({Util::random() * (width - TILE_SIZE * 2) + TILE_SIZE, Util::random() * (height - TILE_SIZE * 2) + TILE_SIZE});
+            }
+            Flock flock{};
+            double steering{0.0};
+            for (int f{0}; f < frames; ++f)
+            {
+                const Clock::time_point start{Clock::now()};
+                flock.steer(pos, vel, step, half_size, player_pos, &field);
+                steering += getSeconds(start);
+                for (int i{0}; i < num; ++i)
+                {
+                    pos[i].x = std::max(0.0, std::min(width - half_size.x * 2.0, pos[i].x + vel[i].x));
+                    pos[i].y = std::max(0.0, std::min(height - half_size.y * 2.0, pos[i].y + vel[i].y));
+                }
+            }
+            std::cout << "boids (" << num << "): " << steering / frames * 1000.0 << "ms/frame steering, "
+                      << steering / frames / num * 1000000000.0 << "ns/bat, " << flock.size() << " members\n";
+        }
+        return 0;
+    }
+
+    // the size out of a PNG's header, {0, 0} if it can't be read
+    inline SDL_Point readPNGSize(const char* path)
+    {
+        std::ifstream file{path, std::ios::binary};
+        unsigned char header[24]{};
+        if (!file.read(reinterpret_cast<char*>(header), sizeof(header)))
+        {
+            return SDL_Point{0, 0};
+        }
+        const auto read32 = [&](const int at)
+        {
+            return static_cast<int>((header[at] << 24) | (header[at + 1] << 16) | (header[at + 2] << 8) | header[at + 3]);
+        };
+        return SDL_Point{read32(16), read32(20)};
+    }
+
+    // stands in for an SDL texture. Only good under RenderState's counting mode, where it's just a key
+    // to sort & shadow by and never gets handed to SDL
+    inline SDL_Texture* fakeTexture(const std::size_t i)
+    {
+        return reinterpret_cast<SDL_Texture*>(static_cast<uintptr_t>(i + 1) * 64);
+    }
+
+    // every atlas texture as its own SDL texture, like before the atlas. The sizes come from the PNG
+    // headers, so run it from the game folder. False if one can't be read
+    inline bool separateTextures(TexMan& texman)
+    {
+        const std::vector<TexMan::TexFile>& files{TexMan::getAtlasFiles()};
+        for (std::size_t i{0}; i < files.size(); ++i)
+        {
+            const SDL_Point size{readPNGSize(files[i].path)};
+            if (size.x == 0)
+            {
+                std::cerr << "bench: couldn't read " << files[i].path << '\n';
+                return false;
+            }
+            (texman.*files[i].texture).setView(fakeTexture(i), SDL_Rect{0, 0, size.x, size.y}, size.x, size.y);
+        }
+        return true;
+    }
+
+    // a busy frame in view on the platform level: stars, tiles, grass, a crowd of entities, coins & shockwaves
+    struct SpriteScene
+    {
+        World world{};
+        TexMan& texman;
+        const SDL_Rect view{TILE_SIZE * 8, LEVEL_TILE_HEIGHT * TILE_SIZE - SCR_HEIGHT, SCR_WIDTH, SCR_HEIGHT};
+        EMManager entities{};
+        CoinManager coins;
+        Background background{};
+        ShockWaveManager waves;
+        Broadphase bodies{};
+        double last_coin{0.0};
+
+        explicit SpriteScene(TexMan& tex)
+            : texman{tex}, coins{&tex.coin, &tex.lightTex}, waves{&tex.shockwave}
+        {
+            world.loadFromJson(makePlatformLevel());
+            entities.setTexMan(&texman);
+            const std::array<EntityType, 3> types{EntityType::SLIME, EntityType::BAT, EntityType::TURTLE};
+            for (int i{0}; i < 60; ++i)
+            {
+                entities.addEntity(types[i % types.size()], {static_cast<double>(view.x + Util::random() * view.w), static_cast<double>(view.y + Util::random() * (view.h - TILE_SIZE * 4))});
+            }
+            for (int i{0}; i < 40; ++i)
+            {
+                coins.addCoin({static_cast<double>(view.x + Util::random() * view.w), static_cast<double>(view.y + Util::random() * view.h / 2.0)}, {0.0, 0.0});
+            }
+            background.load(texman, nullptr, BACKGROUND_STARS | BACKGROUND_MOON);
+            for (int i{0}; i < 3; ++i)
+            {
+                waves.addShockWave({static_cast<double>(view.x + Util::random() * view.w), static_cast<double>(view.y + Util::random() * view.h)});
+            }
+        }
+
+        // flushed at the same points the game flushes, gives back how many quads went in the first flush
+        std::size_t frame(SpriteBatch& batch)
+        {
+            // stars, moon, tiles, grass & entities, then the portal, then coins, then shockwaves
+            background.render(1.0, view.x, view.y, view.w, view.h, batch);
+            world.render(view.x, view.y, nullptr, batch, &texman, view.w, view.h);
+            world.handleGrass(view.x, view.y, batch, &texman, view.w, view.h, bodies, 1.0);
+            entities.render(view.x, view.y, view.w, view.h, batch);
+            const std::size_t first{batch.size()};
+            batch.flush(nullptr);
+            batch.draw(texman.portalTex, SpriteLayer::PORTAL, view.w / 2, view.h / 2);
+            world.updateLeaves(1.0, view.x, view.y, view.w, view.h, &texman, batch);
+            batch.flush(nullptr);
+            coins.update(1.0, view.x, view.y, batch, &world, &texman, bodies, last_coin, nullptr);
+            batch.flush(nullptr);
+            waves.update(1.0, view.x, view.y, batch);
+            batch.flush(nullptr);
+            return first;
+        }
+    };
+
+    // the sprite scene with every quad its own SDL_RenderCopy vs through the batch, textures unpacked.
+    // Counting only, there's no renderer
+    inline int sprites()
+    {
+        TexMan texman{};
+        if (!separateTextures(texman))
+        {
+            return 1;
+        }
+        RenderState::setCounting(true);
+        SpriteScene scene{texman};
+        SpriteBatch batch{};
+        const std::size_t first{scene.frame(batch)};
+        std::cout << "sprites: " << batch.getQuads() << " quads (" << first << " before the first flush, " << batch.getSolid() << " untextured) over 4 flushes\n"
+                  << "sprites: before batching " << batch.getQuads() << " draw calls & " << batch.getUnsortedSwitches() << " texture switches, after "
+                  << batch.getCalls() << " draw calls & " << batch.getSwitches() << " texture switches\n";
+
+        // and how long batching a frame like that takes, without a real renderer to hand it to
+        constexpr int frames{1000};
+        const Clock::time_point start{Clock::now()};
+        for (int f{0}; f < frames; ++f)
+        {
+            scene.background.render(1.0, scene.view.x, scene.view.y, scene.view.w, scene.view.h, batch);
+            scene.world.render(scene.view.x, scene.view.y, nullptr, batch, &texman, scene.view.w, scene.view.h);
+            scene.entities.render(scene.view.x, scene.view.y, scene.view.w, scene.view.h, batch);
+            batch.flush(nullptr);
+        }
+        const double seconds{getSeconds(start)};
+        std::cout << "sprites: " << seconds / frames * 1000000.0 << "us to batch & flush stars, tiles & entities\n";
+        RenderState::setCounting(false);
+        return 0;
+    }
+
+    // packs the real sprite sizes (read from the PNG headers, so run it from the game folder) the way
+    // TexMan does, then counts the sprite scene's draws with separate textures & with atlas views
+    inline int atlas()
+    {
+        const std::vector<TexMan::TexFile>& files{TexMan::getAtlasFiles()};
+        std::vector<SDL_Point> sizes{};
+        long area{0};
+        for (const TexMan::TexFile& file : files)
+        {
+            sizes.push_back(readPNGSize(file.path));
+            if (sizes.back().x == 0)
+            {
+                std::cerr << "atlas: couldn't read " << file.path << '\n';
+                return 1;
+            }
+            area += static_cast<long>(sizes.back().x) * sizes.back().y;
+        }
+
+        AtlasPacker packer{};
+        std::vector<AtlasPlacement> placements{};
+        constexpr int runs{1000};
+        const Clock::time_point start{Clock::now()};
+        for (int r{0}; r < runs; ++r)
+        {
+            packer.pack(sizes, ATLAS_PAGE_SIZE, placements);
+        }
+        const double seconds{getSeconds(start)};
+        long page_area{0};
+        for (int p{0}; p < packer.getPages(); ++p)
+        {
+            page_area += static_cast<long>(packer.getPageSize(p).x) * packer.getPageSize(p).y;
+            std::cout << "atlas: page " << p << " is " << packer.getPageSize(p).x << "x" << packer.getPageSize(p).y << '\n';
+        }
+        std::cout << "atlas: " << files.size() << " sprites on " << packer.getPages() << " page(s), " << static_cast<int>(100.0 * area / page_area)
+                  << "% full, packed in " << seconds / runs * 1000000.0 << "us\n";
+
+        RenderState::setCounting(true);
+        TexMan texman{};
+        SpriteScene scene{texman};
+        SpriteBatch batch{};
+        for (const bool packed : {false, true})
+        {
+            if (packed)
+            {
+                for (std::size_t i{0}; i < files.size(); ++i)
+                {
+                    const SDL_Point page{packer.getPageSize(placements[i].page)};
+                    (texman.*files[i].texture).setView(fakeTexture(placements[i].page), placements[i].rect, page.x, page.y);
+                }
+            } else if (!separateTextures(texman))
+            {
+                return 1;
+            }
+            batch.resetStats();
+            scene.frame(batch);
+            std::cout << "atlas: " << (packed ? "atlas views:       " : "separate textures: ") << batch.getQuads() << " quads, "
+                      << batch.getCalls() << " draw calls, " << batch.getSwitches() << " texture switches per frame\n";
+        }
+        RenderState::setCounting(false);
+        return 0;
+    }
+
+    // the backdrop, stars & moon as loose sprites through the batch vs one call each. The cloud strip
+    // needs a real renderer to bake, so it's left out
+    inline int background()
+    {
+        TexMan texman{};
+        if (!separateTextures(texman))
+        {
+            return 1;
+        }
+        RenderState::setCounting(true);
+        Background background{};
+        background.load(texman, nullptr, BACKGROUND_STARS | BACKGROUND_MOON | BACKGROUND_BACKDROP);
+        SpriteBatch batch{};
+        constexpr int frames{1000};
+        const Clock::time_point start{Clock::now()};
+        for (int f{0}; f < frames; ++f)
+        {
+            background.render(1.0, f % 400, 100, SCR_WIDTH, SCR_HEIGHT, batch);
+            batch.flush(nullptr);
+        }
+        const double seconds{getSeconds(start)};
+        std::cout << "background: " << batch.getQuads() / frames << " quads a frame, " << batch.getCalls() / frames << " draw calls (was one per quad), "
+                  << seconds / frames * 1000000.0 << "us to batch & flush\n";
+        RenderState::setCounting(false);
+        return 0;
+    }
+
+    // a cloud of particles drawn the immediate way plus the sprite scene, counting the texture & draw
+    // state changes that would reach SDL against the ones RenderState drops. Counting only, the immediate
+    // draws still call SDL_RenderCopy but with no renderer SDL turns them away before the texture
+    inline int renderstate()
+    {
+        TexMan texman{};
+        if (!separateTextures(texman))
+        {
+            return 1;
+        }
+        RenderState::setCounting(true);
+        texman.particle.setView(fakeTexture(TexMan::getAtlasFiles().size()), SDL_Rect{0, 0, 1, 1}, 1, 1);
+        SpriteScene scene{texman};
+        ParticleSpawner particles{300, 300, {scene.view.x + scene.view.w / 2.0, scene.view.y + scene.view.h / 2.0}, {0.98, 0.98}, 0.0, 0.05, false};
+        particles.setSpawning(300, {2.0, 2.0}, SDL_Color{0xf6, 0xe7, 0x9c, 0xFF});
+        SpriteBatch batch{};
+        constexpr int frames{60};
+        long issued{0};
+        long elided{0};
+        int first{0};
+        for (int f{0}; f < frames; ++f)
+        {
+            particles.update(1.0, scene.view.x, scene.view.y, nullptr, &scene.world, &texman);
+            scene.frame(batch);
+            RenderState::endFrame();
+            issued += RenderState::getIssued();
+            elided += RenderState::getElided();
+            if (f == 0)
+            {
+                first = RenderState::getIssued();
+            }
+        }
+        std::cout << "renderstate: " << first << " state changes sent on the first frame, then " << static_cast<double>(issued - first) / (frames - 1)
+                  << " a frame, " << elided / frames << " dropped as no-ops a frame ("
+                  << static_cast<int>(100.0 * elided / std::max(1L, issued + elided)) << "%)\n";
+        RenderState::setCounting(false);
+        return 0;
+    }
+
+    // returns the exit code
+    inline int run(const std::string& name)
+    {
+        if (name == "fluid")
+        {
+            return fluid();
+        } else if (name == "flow")
+        {
+            return flow();
+        } else if (name == "raycast")
+        {
+            return raycast();
+        } else if (name == "slimes")
+        {
+            return slimes();
+        } else if (name == "broadphase")
+        {
+            return broadphase();
+        } else if (name == "boids")
+        {
+            return boids();
+        } else if (name == "sprites")
+        {
+            return sprites();
+        } else if (name == "atlas")
+        {
+            return atlas();
+        } else if (name == "background")
+        {
+            return background();
+        } else if (name == "renderstate")
+        {
+            return renderstate();
+        }
+        std::cerr << "Unknown benchmark: " << name << '\n';
+        return 1;
+    }
+}
+
+#endif
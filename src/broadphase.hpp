@@ -0,0 +1,126 @@
+#ifndef BROADPHASE_H
+#define BROADPHASE_H
+
+#include "SDL2/SDL.h"
+
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <cstdint>
+
+#include "./constants.hpp"
+#include "./util.hpp"
+#include "./spatial.hpp"
+
+// what a body is, so queries can ask for just the kinds they care about
+enum BodyMask : uint8_t
+{
+    BODY_PLAYER = 1 << 0,
+    BODY_ATTACK = 1 << 1, // the player's sword swing, only while attacking
+    BODY_ENTITY = 1 << 2,
+    BODY_COIN = 1 << 3,
+    BODY_ALL = 0xff
+};
+
+inline constexpr int BROADPHASE_CELL{TILE_SIZE * 4}; // px, a few entities wide
+
+struct Body
+{
+    SDL_Rect rect;
+    uint8_t kind; // BodyMask
+    uint8_t owner; // which manager added it (EntityType for entities)
+    uint32_t index; // the owner's own index for it
+};
+
+// per frame uniform grid the moving things register into, so interactions only look at what's nearby.
+// It's cleared every frame and bodies are a snapshot: an index is only good until its owner next
+// adds or removes things
+class Broadphase
+{
+private:
+    std::vector<Body> _Bodies{};
+    SpatialGrid<int> _Grid{};
+
+    // bodies spanning several cells get found in each of them, only the cell holding the top left
+    // corner of the overlap reports them
+    bool firstCell(const SDL_Rect& a, const SDL_Rect& b, const int cell_x, const int cell_y) const
+    {
+        return _Grid.cellX(std::max(a.x, b.x)) == cell_x && _Grid.cellY(std::max(a.y, b.y)) == cell_y;
+    }
+
+public:
+    Broadphase()
+    {
+        init(LEVEL_TILE_WIDTH * TILE_SIZE, LEVEL_TILE_HEIGHT * TILE_SIZE);
+    }
+
+    // width & height in px
+    void init(const int width, const int height, const int cell_size = BROADPHASE_CELL)
+    {
+        _Grid.init(width, height, cell_size);
+        _Bodies.clear();
+    }
+
+    void clear()
+    {
+        _Grid.clear();
+        _Bodies.clear();
+    }
+
+    void reserve(const std::size_t num) {_Bodies.reserve(num);}
+
+    std::size_t size() const {return _Bodies.size();}
+
+    // returns the body's index for getBody()
+    int add(const SDL_Rect& rect, const uint8_t kind, const uint8_t owner = 0, const uint32_t index = 0)
+    {
+        const int body{static_cast<int>(_Bodies.size())};
+        _Bodies.push_back(Body{rect, kind, owner, index});
+        _Grid.insert(rect, body);
+        return body;
+    }
+
+    const Body& getBody(const int body) const {return _Bodies[body];}
+
+    // appends every body of a kind in mask overlapping rect, each one once
+    void queryAABB(const SDL_Rect& rect, const uint8_t mask, std::vector<int>& out) const
+    {
+        _Grid.visit(rect, [&](const int b, const int cell_x, const int cell_y)
+        {
+            const Body& body{_Bodies[b]};
+            if ((body.kind & mask) && Util::checkCollision(&body.rect, &rect) && firstCell(body.rect, rect, cell_x, cell_y))
+            {
+                out.push_back(b);
+            }
+        });
+    }
+
+    // appends every overlapping (a, b) with a's kind in mask_a and b's in mask_b, each pair once
+    void queryPairs(const uint8_t mask_a, const uint8_t mask_b, std::vector<std::pair<int, int>>& out) const
+    {
+        for (int a{0}; a < static_cast<int>(_Bodies.size()); ++a)
+        {
+            const Body& body_a{_Bodies[a]};
+            if (!(body_a.kind & mask_a))
+            {
+                continue;
+            }
+            // when both could be either side, (b, a) is the same pair
+            const bool both_ways{static_cast<bool>(body_a.kind & mask_b)};
+            _Grid.visit(body_a.rect, [&](const int b, const int cell_x, const int cell_y)
+            {
+                const Body& body_b{_Bodies[b]};
+                if (b == a || !(body_b.kind & mask_b) || (both_ways && (body_b.kind & mask_a) && b < a))
+                {
+                    return;
+                }
+                if (Util::checkCollision(&body_a.rect, &body_b.rect) && firstCell(body_a.rect, body_b.rect, cell_x, cell_y))
+                {
+                    out.push_back({a, b});
+                }
+            });
+        }
+    }
+};
+
+#endif
@@ -53,7 +53,7 @@ public:
         _expand += _vel * 0.4 * time_step;
         
         SDL_Rect renderQuad{_pos.x - static_cast<int>(_expand), _pos.y - static_cast<int>(_expand), _tex->getWidth() + static_cast<int>(_expand) * 2, _tex->getHeight() + static_cast<int>(_expand) * 2};
-        SDL_RenderCopyEx(renderer, _tex->getTexture(), NULL, &renderQuad, 0, NULL, SDL_FLIP_NONE);
+        _tex->renderStretched(renderQuad, renderer);
     }
 };
 
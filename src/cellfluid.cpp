@@ -0,0 +1,683 @@
+#include "./cellfluid.hpp"
+#include "./renderstate.hpp"
+
+void CellFluid::init(const int width, const int height, const std::vector<uint8_t>& solid)
+{
+    _width = width;
+    _height = height;
+    _Mass.assign(width * height, 0.0f);
+    _NewMass.assign(width * height, 0.0f);
+    _Solid = solid;
+    _Solid.resize(width * height, 0);
+    _Mark.assign(width * height, 0);
+    _mark = 0;
+    _Active.clear();
+    _Next.clear();
+    _Dirty.clear();
+    _Columns.clear();
+    _ColumnDirty.assign(width, 0);
+    _Bands.assign((height + CELL_BAND_ROWS - 1) / CELL_BAND_ROWS, std::vector<int>{});
+    _Touched.assign(_Bands.size(), std::vector<int>{});
+    _Body.init(vec2<int>{0, 0}, vec2<int>{width, height}, CELL_WAVES);
+    _Top.assign(width, -1);
+    _Bottom.assign(width, 0.0f);
+    for (int x{0}; x < width; ++x)
+    {
+        markColumn(x);
+    }
+    _accumulator = 0.0;
+    resetStats();
+    setThreads(std::min(CELL_MAX_THREADS, static_cast<int>(std::thread::hardware_concurrency())));
+}
+
+void CellFluid::setThreads(const int threads)
+{
+    stopWorkers();
+    _threads = std::max(1, threads);
+    if (!isEmpty())
+    {
+        startWorkers();
+    }
+}
+
+void CellFluid::startWorkers()
+{
+    if (_threads <= 1)
+    {
+        return;
+    }
+    _quit = false;
+    _Barrier = std::make_unique<std::barrier<>>(_threads);
+    for (int t{1}; t < _threads; ++t)
+    {
+        _Workers.emplace_back(&CellFluid::work, this, t, _job);
+    }
+}
+
+void CellFluid::stopWorkers()
+{
+    {
+        std::lock_guard<std::mutex> lock{_mutex};
+        _quit = true;
+    }
+    _wake.notify_all();
+    for (std::thread& worker : _Workers)
+    {
+        worker.join();
+    }
+    _Workers.clear();
+    _Barrier.reset();
+}
+
+// a worker's whole life: wait for a step, do its bands of both phases, wait again
+void CellFluid::work(const int first, uint32_t job)
+{
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock{_mutex};
+            _wake.wait(lock, [&]{return _quit || _job != job;});
+            if (_quit)
+            {
+                return;
+            }
+            job = _job;
+        }
+        stepBands(first, _threads, 0);
+        _Barrier->arrive_and_wait();
+        stepBands(first, _threads, 1);
+        _Barrier->arrive_and_wait();
+    }
+}
+
+void CellFluid::free()
+{
+    stopWorkers();
+    _Mass.clear();
+    _NewMass.clear();
+    _Solid.clear();
+    _Mark.clear();
+    _Active.clear();
+    _Next.clear();
+    _Dirty.clear();
+    _Columns.clear();
+    _ColumnDirty.clear();
+    _Bands.clear();
+    _Touched.clear();
+    _Body.clear();
+    _Top.clear();
+    _Bottom.clear();
+    _Points.clear();
+    _Indices.clear();
+    _Line.clear();
+    _Pools.clear();
+    _PoolIndices.clear();
+    _width = 0;
+    _height = 0;
+}
+
+void CellFluid::loadFromFile(const char* path, World& world)
+{
+    free();
+    std::ifstream f{path};
+    json data = json::parse(f);
+    f.close();
+
+    // optional, most levels don't have any
+    if (!data["level"].contains("fluid") || data["level"]["fluid"].empty())
+    {
+        return;
+    }
+
+    init(LEVEL_TILE_WIDTH, LEVEL_TILE_HEIGHT, world.getSolidGrid());
+    for (const auto& rect : data["level"]["fluid"])
+    {
+        fillRect(SDL_Rect{rect[0], rect[1], rect[2], rect[3]}, CELL_MAX_MASS);
+    }
+    std::cout << "loaded cell fluid!\n";
+}
+
+float CellFluid::getStableMass(const float total)
+{
+    if (total <= CELL_MAX_MASS)
+    {
+        return CELL_MAX_MASS;
+    } else if (total < 2.0f * CELL_MAX_MASS + CELL_MAX_COMPRESS)
+    {
+        return (CELL_MAX_MASS * CELL_MAX_MASS + total * CELL_MAX_COMPRESS) / (CELL_MAX_MASS + CELL_MAX_COMPRESS);
+    }
+    return (total + CELL_MAX_COMPRESS) / 2.0f;
+}
+
+bool CellFluid::mark(const int i)
+{
+    if (_Mark[i] == _mark)
+    {
+        return false;
+    }
+    _Mark[i] = _mark;
+    return true;
+}
+
+void CellFluid::markColumn(const int x)
+{
+    if (!_ColumnDirty[x])
+    {
+        _ColumnDirty[x] = 1;
+        _Columns.push_back(x);
+    }
+}
+
+float CellFluid::getMass(const int x, const int y) const
+{
+    if (solid(x, y))
+    {
+        return 0.0f;
+    }
+    return _Mass[index(x, y)];
+}
+
+void CellFluid::addMass(const int x, const int y, const float mass)
+{
+    if (solid(x, y))
+    {
+        return;
+    }
+    const int i{index(x, y)};
+    _Mass[i] = std::max(0.0f, _Mass[i] + mass);
+    _NewMass[i] = _Mass[i];
+    _Dirty.push_back(i);
+    markColumn(x);
+}
+
+void CellFluid::setSolid(const int x, const int y, const bool val)
+{
+    if (x < 0 || x >= _width || y < 0 || y >= _height)
+    {
+        return;
+    }
+    const int i{index(x, y)};
+    _Solid[i] = val;
+    if (val)
+    {
+        _Mass[i] = 0.0f;
+        _NewMass[i] = 0.0f;
+    }
+    // wake the neighbours, they might be able to flow now
+    _Dirty.push_back(i);
+    markColumn(x);
+}
+
+void CellFluid::fillRect(const SDL_Rect& rect, const float mass)
+{
+    for (int y{rect.y}; y < rect.y + rect.h; ++y)
+    {
+        for (int x{rect.x}; x < rect.x + rect.w; ++x)
+        {
+            addMass(x, y, mass);
+        }
+    }
+}
+
+float CellFluid::getTotalMass() const
+{
+    float total{0.0f};
+    for (const float mass : _Mass)
+    {
+        total += mass;
+    }
+    return total;
+}
+
+void CellFluid::updateCell(const int i, std::vector<int>& touched)
+{
+    float remaining{_Mass[i]};
+    if (remaining <= 0.0f)
+    {
+        return;
+    }
+    const int x{i % _width};
+    const int y{i / _width};
+
+    // move some mass from this cell to another one, keeps track of what got written to
+    auto move{[&](const int other, float flow)
+    {
+        _NewMass[i] -= flow;
+        _NewMass[other] += flow;
+        remaining -= flow;
+        touched.push_back(other);
+    }};
+
+    // down
+    if (!solid(x, y + 1))
+    {
+        const int below{index(x, y + 1)};
+        float flow{getStableMass(remaining + _Mass[below]) - _Mass[below]};
+        if (flow > CELL_MIN_FLOW)
+        {
+            flow *= 0.5f; // smooth it out a bit
+        }
+        flow = std::max(0.0f, std::min({flow, CELL_MAX_SPEED, remaining}));
+        if (flow > 0.0f)
+        {
+            move(below, flow);
+        }
+    }
+    if (remaining <= 0.0f)
+    {
+        touched.push_back(i);
+        return;
+    }
+
+    // left & right, evens out with the neighbours
+    for (const int dx : {-1, 1})
+    {
+        if (!solid(x + dx, y))
+        {
+            const int side{index(x + dx, y)};
+            float flow{(_Mass[i] - _Mass[side]) / 4.0f};
+            if (flow > CELL_MIN_FLOW)
+            {
+                flow *= 0.5f;
+            }
+            flow = std::max(0.0f, std::min(flow, remaining));
+            if (flow > 0.0f)
+            {
+                move(side, flow);
+            }
+        }
+        if (remaining <= 0.0f)
+        {
+            touched.push_back(i);
+            return;
+        }
+    }
+
+    // up, only compressed cells push mass up
+    if (!solid(x, y - 1))
+    {
+        const int above{index(x, y - 1)};
+        float flow{remaining - getStableMass(remaining + _Mass[above])};
+        if (flow > CELL_MIN_FLOW)
+        {
+            flow *= 0.5f;
+        }
+        flow = std::max(0.0f, std::min({flow, CELL_MAX_SPEED, remaining}));
+        if (flow > 0.0f)
+        {
+            move(above, flow);
+        }
+    }
+    touched.push_back(i);
+}
+
+void CellFluid::stepBands(const int first, const int stride, const int phase)
+{
+    const int num{static_cast<int>(_Bands.size())};
+    for (int b{first * 2 + phase}; b < num; b += stride * 2)
+    {
+        for (const int i : _Bands[b])
+        {
+            updateCell(i, _Touched[b]);
+        }
+    }
+}
+
+// two phases, even bands then odd bands
+void CellFluid::updateBands()
+{
+    if (!_Workers.empty() && static_cast<int>(_Active.size()) > CELL_THREAD_THRESHOLD)
+    {
+        {
+            std::lock_guard<std::mutex> lock{_mutex};
+            ++_job;
+        }
+        _wake.notify_all();
+        stepBands(0, _threads, 0);
+        _Barrier->arrive_and_wait();
+        stepBands(0, _threads, 1);
+        _Barrier->arrive_and_wait();
+    } else {
+        stepBands(0, 1, 0);
+        stepBands(0, 1, 1);
+    }
+}
+
+void CellFluid::step()
+{
+    if (isEmpty())
+    {
+        return;
+    }
+
+    // wake up anything poked since the last step, and everything around it
+    ++_mark;
+    _Next.swap(_Active);
+    _Active.clear();
+    _Next.insert(_Next.end(), _Dirty.begin(), _Dirty.end());
+    _Dirty.clear();
+    for (std::vector<int>& band : _Bands)
+    {
+        band.clear();
+    }
+    for (const int i : _Next)
+    {
+        const int x{i % _width};
+        const int y{i / _width};
+        const int around[5][2]{{x, y}, {x - 1, y}, {x + 1, y}, {x, y - 1}, {x, y + 1}};
+        for (const auto& cell : around)
+        {
+            if (!solid(cell[0], cell[1]))
+            {
+                const int j{index(cell[0], cell[1])};
+                if (mark(j) && _Mass[j] > 0.0f)
+                {
+                    _Bands[cell[1] / CELL_BAND_ROWS].push_back(j);
+                    _Active.push_back(j);
+                }
+            }
+        }
+    }
+    _updates += static_cast<long long>(_Active.size());
+    ++_steps;
+
+    updateBands();
+
+    // commit, and keep the cells that actually changed for next step
+    ++_mark;
+    _Active.clear();
+    for (std::vector<int>& touched : _Touched)
+    {
+        for (const int i : touched)
+        {
+            if (mark(i))
+            {
+                float mass{_NewMass[i]};
+                if (mass < CELL_MIN_MASS)
+                {
+                    mass = 0.0f;
+                    _NewMass[i] = 0.0f;
+                }
+                if (std::abs(mass - _Mass[i]) > CELL_MIN_CHANGE)
+                {
+                    _Active.push_back(i);
+                }
+                if (mass != _Mass[i])
+                {
+                    markColumn(i % _width);
+                }
+                _Mass[i] = mass;
+            }
+        }
+        touched.clear();
+    }
+}
+
+int CellFluid::update(const double& time_step, const int scrollX, const int scrollY, const int width, const int height, SDL_Renderer* renderer, TexMan* texman, Player* player)
+{
+    if (isEmpty())
+    {
+        return 0;
+    }
+    _accumulator = std::min(_accumulator + time_step, CELL_STEP * CELL_MAX_STEPS);
+    int steps{0};
+    while (_accumulator >= CELL_STEP)
+    {
+        step();
+        _accumulator -= CELL_STEP;
+        ++steps;
+    }
+    updateSurface();
+
+    // the springs sleep like a water body's, the rest heights above still follow the cells meanwhile
+    const bool visible{isVisible(scrollX, scrollY, width, height)};
+    const bool disturbed{player != nullptr && isWet(*player->getRect())};
+    if (_Body.getSleeping() && (visible || disturbed))
+    {
+        _Body.wake();
+    }
+    if (!_Body.getSleeping())
+    {
+        if (disturbed)
+        {
+            _Body.disturb(time_step, player);
+        }
+        _Body.getSurface().update(time_step);
+        if (_Body.rest(time_step, _Body.getSurface().isSettled(FLUID_REST_HEIGHT, FLUID_REST_VEL), visible))
+        {
+            _Body.sleep();
+        }
+    }
+    if (visible)
+    {
+        render(scrollX, scrollY, width, height, renderer, texman);
+    }
+    return steps;
+}
+
+// any wet column top in the view, with the same margin as the water bodies
+bool CellFluid::isVisible(const int scrollX, const int scrollY, const int width, const int height) const
+{
+    const int x0{std::max(0, (scrollX - FLUID_VIEW_MARGIN) / TILE_SIZE)};
+    const int x1{std::min(_width - 1, (scrollX + width + FLUID_VIEW_MARGIN) / TILE_SIZE)};
+    const float top{static_cast<float>(scrollY - FLUID_VIEW_MARGIN)};
+    const float bottom{static_cast<float>(scrollY + height + FLUID_VIEW_MARGIN)};
+    for (int x{x0}; x <= x1; ++x)
+    {
+        if (_Top[x] >= 0 && static_cast<float>(_Top[x] * TILE_SIZE) <= bottom && _Bottom[x] >= top)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool CellFluid::isWet(const SDL_Rect& rect) const
+{
+    if (isEmpty())
+    {
+        return false;
+    }
+    const int x0{std::max(0, rect.x / TILE_SIZE)};
+    const int y0{std::max(0, rect.y / TILE_SIZE)};
+    const int x1{std::min(_width - 1, (rect.x + rect.w - 1) / TILE_SIZE)};
+    const int y1{std::min(_height - 1, (rect.y + rect.h - 1) / TILE_SIZE)};
+    for (int y{y0}; y <= y1; ++y)
+    {
+        for (int x{x0}; x <= x1; ++x)
+        {
+            if (getMass(x, y) >= CELL_MIN_FLOW)
+            {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+float CellFluid::getTopY(const int x, const int y) const
+{
+    // cells with liquid above are full, so falling streams don't look like dashes
+    if (getMass(x, y - 1) >= CELL_MIN_FLOW)
+    {
+        return static_cast<float>(y * TILE_SIZE);
+    }
+    return static_cast<float>((y + 1) * TILE_SIZE) - std::min(1.0f, getMass(x, y)) * static_cast<float>(TILE_SIZE);
+}
+
+double CellFluid::getSurfaceY(const double x, const double y) const
+{
+    const int column{std::max(0, std::min(_width - 1, static_cast<int>(x) / TILE_SIZE))};
+    int row{static_cast<int>(y) / TILE_SIZE};
+    if (getMass(column, row) < CELL_MIN_FLOW)
+    {
+        return static_cast<double>(_height * TILE_SIZE); // nothing here, it's under everything
+    }
+    while (getMass(column, row - 1) >= CELL_MIN_FLOW)
+    {
+        --row;
+    }
+    // only the top of a column has springs
+    if (row == _Top[column])
+    {
+        return _Body.getSurface().getY(_Body.getSurface().getIndex(x));
+    }
+    return static_cast<double>(getTopY(column, row));
+}
+
+void CellFluid::updateSurface()
+{
+    for (const int x : _Columns)
+    {
+        updateColumn(x);
+        _ColumnDirty[x] = 0;
+    }
+    _Columns.clear();
+}
+
+void CellFluid::updateColumn(const int x)
+{
+    int top{-1};
+    for (int y{0}; y < _height; ++y)
+    {
+        if (getMass(x, y) >= CELL_MIN_FLOW)
+        {
+            top = y;
+            break;
+        }
+    }
+    _Top[x] = top;
+    int bottom{top};
+    while (bottom >= 0 && getMass(x, bottom) >= CELL_MIN_FLOW)
+    {
+        ++bottom;
+    }
+    _Bottom[x] = static_cast<float>(bottom * TILE_SIZE);
+
+    // the column's springs, the last column gets the one on the right edge too
+    WaveSurface& surface{_Body.getSurface()};
+    const double base{(top < 0 ? _Bottom[x] : getTopY(x, top)) - surface.getRestY()};
+    const int first{surface.getIndex(static_cast<double>(x * TILE_SIZE))};
+    const int last{x == _width - 1 ? surface.getSize() - 1 : surface.getIndex(static_cast<double>((x + 1) * TILE_SIZE)) - 1};
+    for (int i{first}; i <= last; ++i)
+    {
+        surface.setBase(i, base);
+    }
+}
+
+void CellFluid::addQuad(const float x, const float y, const float w, const float h, const SDL_Color col)
+{
+    const int first{static_cast<int>(_Pools.size())};
+    _Pools.push_back(SDL_Vertex{{x, y}, col, {0.0f, 0.0f}});
+    _Pools.push_back(SDL_Vertex{{x + w, y}, col, {0.0f, 0.0f}});
+    _Pools.push_back(SDL_Vertex{{x, y + h}, col, {0.0f, 0.0f}});
+    _Pools.push_back(SDL_Vertex{{x + w, y + h}, col, {0.0f, 0.0f}});
+    for (const int i : {0, 1, 2, 2, 3, 1})
+    {
+        _PoolIndices.push_back(first + i);
+    }
+}
+
+void CellFluid::render(const int scrollX, const int scrollY, const int width, const int height, SDL_Renderer* renderer, TexMan* texman)
+{
+    if (isEmpty())
+    {
+        return;
+    }
+
+    // the top of each column, same as a water body: a strip from the springs down to the bottom of the
+    // liquid under them, quads only between springs that both have liquid
+    const WaveSurface& surface{_Body.getSurface()};
+    const int first{surface.getIndex(static_cast<double>(scrollX))};
+    const int num{surface.getIndex(static_cast<double>(scrollX + width)) - first + 1};
+    if (static_cast<int>(_Points.size()) != num * 2)
+    {
+        _Points.resize(num * 2);
+        for (int k{0}; k < num * 2; ++k)
+        {
+            _Points[k] = SDL_Vertex{{0.0f, 0.0f}, WATER_COLOR, {static_cast<float>(k % num) / static_cast<float>(std::max(1, num - 1)), 0.0f}};
+        }
+        _Indices.reserve((num - 1) * 6);
+        _Line.reserve(num);
+    }
+    _Indices.clear();
+    bool last_wet{false};
+    for (int k{0}; k < num; ++k)
+    {
+        const int i{first + k};
+        const int column{std::min(_width - 1, static_cast<int>(surface.getX(i)) / TILE_SIZE)};
+        const bool wet{_Top[column] >= 0};
+        const float x{static_cast<float>(surface.getX(i)) - static_cast<float>(scrollX)};
+        _Points[k].position = SDL_FPoint{x, static_cast<float>(surface.getY(i)) - static_cast<float>(scrollY)};
+        _Points[num + k].position = SDL_FPoint{x, _Bottom[column] - static_cast<float>(scrollY)};
+        if (wet && last_wet)
+        {
+            for (const int j : {k - 1, k, num + k - 1, num + k - 1, num + k, k})
+            {
+                _Indices.push_back(j);
+            }
+        }
+        last_wet = wet;
+    }
+
+    // anything further down a column, under a ledge or below a dry gap, has no springs
+    _Pools.clear();
+    _PoolIndices.clear();
+    const int x0{std::max(0, scrollX / TILE_SIZE)};
+    const int x1{std::min(_width - 1, (scrollX + width) / TILE_SIZE)};
+    const int y1{std::min(_height - 1, (scrollY + height) / TILE_SIZE)};
+    for (int x{x0}; x <= x1; ++x)
+    {
+        if (_Top[x] < 0)
+        {
+            continue;
+        }
+        int y{static_cast<int>(_Bottom[x]) / TILE_SIZE};
+        while (y <= y1)
+        {
+            if (getMass(x, y) < CELL_MIN_FLOW)
+            {
+                ++y;
+                continue;
+            }
+            const float top{getTopY(x, y)};
+            while (y < _height && getMass(x, y) >= CELL_MIN_FLOW)
+            {
+                ++y;
+            }
+            const float px{static_cast<float>(x * TILE_SIZE - scrollX)};
+            const float py{top - static_cast<float>(scrollY)};
+            addQuad(px, py, static_cast<float>(TILE_SIZE), static_cast<float>(y * TILE_SIZE) - top, WATER_COLOR);
+            addQuad(px, py, static_cast<float>(TILE_SIZE), 1.0f, WATER_LINE_COLOR);
+        }
+    }
+
+    RenderState::setDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+    texman->particle.setBlendMode(SDL_BLENDMODE_BLEND);
+    if (!_Indices.empty())
+    {
+        Polygons::renderPolygon(renderer, texman->particle.bindTexture(), _Points, _Indices);
+    }
+    if (!_PoolIndices.empty())
+    {
+        Polygons::renderPolygon(renderer, texman->particle.bindTexture(), _Pools, _PoolIndices);
+    }
+    texman->particle.setBlendMode(SDL_BLENDMODE_NONE);
+
+    // the surface line, broken wherever a column's dry
+    RenderState::setDrawColor(renderer, WATER_LINE_COLOR.r, WATER_LINE_COLOR.g, WATER_LINE_COLOR.b, WATER_LINE_COLOR.a);
+    _Line.clear();
+    for (int k{0}; k <= num; ++k)
+    {
+        const int column{k < num ? std::min(_width - 1, static_cast<int>(surface.getX(first + k)) / TILE_SIZE) : 0};
+        if (k < num && _Top[column] >= 0)
+        {
+            _Line.push_back(SDL_Point{static_cast<int>(_Points[k].position.x), static_cast<int>(_Points[k].position.y)});
+        } else if (!_Line.empty())
+        {
+            SDL_RenderDrawLines(renderer, _Line.data(), static_cast<int>(_Line.size()));
+            _Line.clear();
+        }
+    }
+    RenderState::setDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
+}
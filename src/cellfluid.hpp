@@ -0,0 +1,171 @@
+#ifndef CELL_FLUID_H
+#define CELL_FLUID_H
+
+#include "SDL2/SDL.h"
+#include "JSON/json.hpp"
+
+#include "./constants.hpp"
+#include "./tiles.hpp"
+#include "./polygons.hpp"
+#include "./waves.hpp"
+#include "./water.hpp"
+#include "./texman.hpp"
+#include "./player.hpp"
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <barrier>
+#include <memory>
+#include <fstream>
+#include <cstdint>
+
+using json = nlohmann::json;
+
+// mass based cellular automaton on the tile grid, for liquid that can actually flow around the level
+// only cells that changed last step (plus their neighbours) get updated, and only the columns they're
+// in get their surface redone. The top of each column's liquid sets the rest height of a spring
+// surface across the level, so it ripples, sleeps & is drawn like the water bodies, and it goes in
+// the FluidIndex like them
+
+inline constexpr float CELL_MAX_MASS{1.0f}; // a full cell at rest
+inline constexpr float CELL_MAX_COMPRESS{0.02f}; // how much more a cell can hold per cell above it
+inline constexpr float CELL_MIN_MASS{0.0001f}; // anything less evaporates
+inline constexpr float CELL_MIN_FLOW{0.01f};
+inline constexpr float CELL_MAX_SPEED{1.0f}; // most mass that can move through one side per step
+inline constexpr float CELL_MIN_CHANGE{0.0005f}; // cells that change less than this go back to sleep
+
+inline constexpr double CELL_STEP{2.0}; // step every other frame @ 60fps, it's plenty for tile sized cells
+inline constexpr int CELL_MAX_STEPS{2};
+
+inline constexpr WaveConfig CELL_WAVES{WATER_WAVES}; // it's water, just not in a box
+
+// active cells are split into bands of rows. Cells only touch the rows next to them, so every
+// other band can be stepped at once without two threads writing the same cell. The threads are
+// started once in init() and wait between steps, a barrier keeps the even & odd bands apart
+inline constexpr int CELL_BAND_ROWS{4};
+inline constexpr int CELL_THREAD_THRESHOLD{2048}; // don't bother with threads for small bodies
+inline constexpr int CELL_MAX_THREADS{4};
+
+class CellFluid
+{
+private:
+    int _width{0}; // in tiles
+    int _height{0};
+
+    std::vector<float> _Mass{};
+    std::vector<float> _NewMass{};
+    std::vector<uint8_t> _Solid{};
+
+    std::vector<int> _Active{}; // cells to update next step
+    std::vector<int> _Next{}; // scratch for step(), last step's active cells while it wakes their neighbours
+    std::vector<int> _Dirty{}; // cells poked from outside since the last step
+    std::vector<int> _Columns{}; // columns whose mass changed since the surface was last updated
+    std::vector<uint8_t> _ColumnDirty{}; // 1 if the column's in _Columns
+    std::vector<std::vector<int>> _Bands{}; // active cells per band
+    std::vector<std::vector<int>> _Touched{}; // cells written to, per band
+    std::vector<uint32_t> _Mark{}; // dedupe stamps for the lists above
+    uint32_t _mark{0};
+
+    int _threads{1};
+    double _accumulator{0.0};
+
+    // worker pool, _threads - 1 of them, the calling thread does its share too
+    std::vector<std::thread> _Workers{};
+    std::unique_ptr<std::barrier<>> _Barrier{};
+    std::mutex _mutex{};
+    std::condition_variable _wake{};
+    uint32_t _job{0}; // bumped to start the workers on a step
+    bool _quit{false};
+
+    // stats
+    long long _updates{0}; // cell updates since the last reset
+    int _steps{0};
+
+    // the surface, one spring per px across the level. Its rect is the whole grid, but it's only
+    // visible where the view has wet columns in it
+    FluidSurface _Body{};
+    std::vector<int> _Top{}; // per column, row of the first cell down with liquid in, -1 if it's dry
+    std::vector<float> _Bottom{}; // per column, px the liquid under the top goes down to
+
+    // render buffers, reused every frame
+    std::vector<SDL_Vertex> _Points{}; // surface vertices, then the bottom row
+    std::vector<int> _Indices{}; // for however many springs were on screen last time
+    std::vector<SDL_Point> _Line{};
+    std::vector<SDL_Vertex> _Pools{}; // liquid further down a column than its top, under a ledge say
+    std::vector<int> _PoolIndices{};
+
+    int index(const int x, const int y) const {return y * _width + x;}
+    bool solid(const int x, const int y) const
+    {
+        return x < 0 || x >= _width || y < 0 || y >= _height || _Solid[index(x, y)];
+    }
+
+    // total mass two stacked cells should hold, split so the bottom one is a bit compressed
+    static float getStableMass(const float total);
+
+    bool mark(const int i);
+    void markColumn(const int x);
+    void updateCell(const int i, std::vector<int>& touched);
+    void stepBands(const int first, const int stride, const int phase);
+    void updateBands();
+    void startWorkers();
+    void stopWorkers();
+    void work(const int first, uint32_t job);
+    void step();
+
+    // px the liquid starting at row y in column x comes up to
+    float getTopY(const int x, const int y) const;
+    // redoes the top, bottom & spring rest heights of the columns that changed
+    void updateSurface();
+    void updateColumn(const int x);
+    bool isVisible(const int scrollX, const int scrollY, const int width, const int height) const;
+    void addQuad(const float x, const float y, const float w, const float h, const SDL_Color col);
+
+public:
+    CellFluid()
+    {
+    }
+
+    ~CellFluid()
+    {
+        free();
+    }
+
+    // solid is width * height, 1 for solid tiles
+    void init(const int width, const int height, const std::vector<uint8_t>& solid);
+    void loadFromFile(const char* path, World& world);
+    void free();
+
+    bool isEmpty() const {return _Mass.empty();}
+    SDL_Rect* getRect() {return _Body.getRect();}
+    WaveSurface& getSurface() {return _Body.getSurface();}
+    bool getSleeping() const {return _Body.getSleeping();}
+    // any cell under rect (px) with liquid in
+    bool isWet(const SDL_Rect& rect) const;
+    // px height of the surface over whatever liquid is at x, y (px)
+    double getSurfaceY(const double x, const double y) const;
+
+    float getMass(const int x, const int y) const;
+    void addMass(const int x, const int y, const float mass);
+    void setSolid(const int x, const int y, const bool val);
+    void fillRect(const SDL_Rect& rect, const float mass); // tile coords
+
+    int getActive() const {return static_cast<int>(_Active.size());}
+    long long getUpdates() const {return _updates;}
+    int getSteps() const {return _steps;}
+    void resetStats() {_updates = 0; _steps = 0;}
+    void setThreads(const int threads);
+    float getTotalMass() const;
+
+    // runs as many fixed steps as time_step covers, moves the surface unless it's asleep & draws it if
+    // it's on screen, returns how many steps it took
+    int update(const double& time_step, const int scrollX, const int scrollY, const int width, const int height, SDL_Renderer* renderer, TexMan* texman, Player* player);
+    // step once, no matter the time step (benchmarks)
+    void forceStep() {step();}
+
+    void render(const int scrollX, const int scrollY, const int width, const int height, SDL_Renderer* renderer, TexMan* texman);
+};
+
+#endif
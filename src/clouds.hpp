@@ -6,6 +6,7 @@
 #include "./util.hpp"
 
 #include <vector>
+#include <algorithm>
 
 struct Cloud
 {
@@ -15,6 +16,9 @@ struct Cloud
     int frame;
 };
 
+inline constexpr int CLOUD_WIDTH{64}; // one frame of the cloud sheet
+inline constexpr int CLOUD_HEIGHT{32};
+
 class CloudManager
 {
 private:
@@ -43,7 +47,7 @@ public:
         free();
         for (int i{0}; i < cloudiness; ++i)
         {
-            _Clouds.push_back(new Cloud{{Util::random() * 10000.0, Util::random() * 10000.0}, Util::random() * 0.1 + 0.1, static_cast<double>(i) / static_cast<double>(cloudiness) * 0.6 + 0.2, static_cast<int>(Util::random())});
+            _Clouds.push_back(new Cloud{{Util::random() * 10000.0, Util::random() * 10000.0}, Util::random() * 0.1 + 0.1, static_cast<double>(i) / static_cast<double>(cloudiness) * 0.6 + 0.2, static_cast<int>(Util::random() * 2.0)});
         }
     }
 
@@ -73,9 +77,34 @@ public:
             Cloud* cloud{_Clouds[i]};
             cloud->pos.x += cloud->speed * time_step;
             vec2<double> render_pos{cloud->pos.x - static_cast<double>(scrollX) * cloud->depth, cloud->pos.y - static_cast<double>(scrollY) * cloud->depth};
-            SDL_Rect clipRect{cloud->frame * 64, 0, 64, 32};
-            _tex->render((static_cast<int>(render_pos.x) % (width + 64)) - 64, (static_cast<int>(render_pos.y) % (height + 64)) - 64, renderer, &clipRect);
+            SDL_Rect clipRect{cloud->frame * CLOUD_WIDTH, 0, CLOUD_WIDTH, CLOUD_HEIGHT};
+            _tex->render((static_cast<int>(render_pos.x) % (width + CLOUD_WIDTH)) - CLOUD_WIDTH, (static_cast<int>(render_pos.y) % (height + CLOUD_WIDTH)) - CLOUD_WIDTH, renderer, &clipRect);
+        }
+    }
+
+    // lays the clouds out once along target (a blank target texture), wrapping round the sides so it
+    // tiles. The Background scrolls that instead of drawing every cloud every frame
+    void bake(Texture& target, SDL_Renderer* renderer)
+    {
+        SDL_Texture* old_target{SDL_GetRenderTarget(renderer)};
+        target.setAsRenderTarget(renderer);
+        RenderState::setDrawColor(renderer, 0x00, 0x00, 0x00, 0x00);
+        SDL_RenderClear(renderer);
+        const int width{target.getWidth()};
+        const int spread{std::max(0, target.getHeight() - CLOUD_HEIGHT)};
+        for (std::size_t i{0}; i < _Clouds.size(); ++i)
+        {
+            Cloud* cloud{_Clouds[i]};
+            SDL_Rect clipRect{cloud->frame * CLOUD_WIDTH, 0, CLOUD_WIDTH, CLOUD_HEIGHT};
+            const int x{static_cast<int>(cloud->pos.x) % width};
+            const int y{spread > 0 ? static_cast<int>(cloud->pos.y) % spread : 0};
+            _tex->render(x, y, renderer, &clipRect);
+            if (x + CLOUD_WIDTH > width)
+            {
+                _tex->render(x - width, y, renderer, &clipRect);
+            }
         }
+        SDL_SetRenderTarget(renderer, old_target);
     }
 };
 
@@ -1,14 +1,13 @@
 #include "./coin.hpp"
 #include "./tiles.hpp"
+#include "./fluids.hpp"
 
 CoinManager::CoinManager()
 {
-    timer.start();
 }
 
 CoinManager::CoinManager(Texture* coinTex, Texture* glowTex)
 {
-    timer.start();
     setTex(coinTex, glowTex);
 }
 
@@ -25,178 +24,244 @@ void CoinManager::setTex(Texture* coinTex, Texture* glowTex)
 
 void CoinManager::free()
 {
-    for (std::size_t i{0}; i < _Coins.size(); ++i)
-    {
-        Coin* coin{_Coins[i]};
-        if (coin != nullptr)
-        {
-            delete coin->anim;
-            delete coin;
-            _Coins[i] = nullptr;
-        }
-    }
     _Coins.clear();
 }
 
-void CoinManager::addGlow(vec2<double> pos, vec2<double> vel)
+void CoinManager::addGlow(vec2<double> pos, vec2<double> vel, int value)
 {
-    _Glow.push_back(new Glow{pos, vel, 10.0 - Util::random()});
+    _Glow.push_back(Glow{pos, vel, 10.0 - Util::random(), value});
 }
 
 void CoinManager::addCoin(vec2<double> pos, vec2<double> vel)
 {
-    Anim* anim{new Anim{3, 4, 2, 0.2, true, _coinTex}};
-    anim->setFrame(static_cast<int>(Util::random() * 4.0));
-    Coin* coin{new Coin{pos, vel, anim}};
-    coin->timer.start();
-    _Coins.push_back(coin);
+    _Coins.push_back(Coin{pos, vel, static_cast<double>(static_cast<int>(Util::random() * 4.0))});
 }
 
-void CoinManager::updateCoin(Coin* coin, const double& time_step, void* world)
+void CoinManager::updateCoin(Coin& coin, const double& time_step, void* world, FluidIndex* fluids)
 {
+    coin.frame += COIN_ANIM_SPEED * time_step;
+    coin.age += time_step;
+    if (coin.sleeping)
+    {
+        return;
+    }
 
     // ------------------------ Physics ------------------------ //
 
-    coin->pos.x += coin->vel.x * time_step;
-    SDL_Rect coinRect {static_cast<int>(coin->pos.x), static_cast<int>(coin->pos.y), 3, 4};
+    coin.pos.x += coin.vel.x * time_step;
+    SDL_Rect coinRect {static_cast<int>(coin.pos.x), static_cast<int>(coin.pos.y), 3, 4};
     std::array<SDL_Rect, 9> rects;
-    static_cast<World*>(world)->getTilesAroundPos(coin->pos, rects);
+    static_cast<World*>(world)->getTilesAroundPos(coin.pos, rects);
     for (int i{0}; i < 9; ++i)
     {
         SDL_Rect* tileRect{&(rects[i])};
         if (Util::checkCollision(&coinRect, tileRect))
         {
-            if (coin->vel.x > 0)
+            if (coin.vel.x > 0)
             {
                 coinRect.x = tileRect->x - coinRect.w;
             } else {
                 coinRect.x = tileRect->x + tileRect->w;
             }
-            coin->pos.x = coinRect.x;
-            coin->vel.x *= -0.5; // bounce
-            coin->vel.y *= 0.9; // friction
+            coin.pos.x = coinRect.x;
+            coin.vel.x *= -0.5; // bounce
+            coin.vel.y *= 0.9; // friction
         }
     }
 
     // repeat for vel-y
-    coin->vel.y += 0.07 * time_step;
-    coin->pos.y += coin->vel.y * time_step;
-    coinRect = {static_cast<int>(coin->pos.x), static_cast<int>(coin->pos.y), 3, 4};
-    static_cast<World*>(world)->getTilesAroundPos(coin->pos, rects);
+    coin.vel.y += 0.07 * time_step;
+    coin.pos.y += coin.vel.y * time_step;
+    coinRect = {static_cast<int>(coin.pos.x), static_cast<int>(coin.pos.y), 3, 4};
+    static_cast<World*>(world)->getTilesAroundPos(coin.pos, rects);
+    bool landed{false}; // hit a tile below this frame
     for (int i{0}; i < 9; ++i)
     {
         SDL_Rect* tileRect{&(rects[i])};
         if (Util::checkCollision(&coinRect, tileRect))
         {
-            if (coin->vel.y > 0)
+            if (coin.vel.y > 0)
             {
                 coinRect.y = tileRect->y - coinRect.h;
+                landed = true;
             } else {
                 coinRect.y = tileRect->y + tileRect->h;
             }
-            coin->pos.y = coinRect.y;
-            coin->vel.y *= -0.5; // bounce
-            coin->vel.x *= 0.9; // friction
+            coin.pos.y = coinRect.y;
+            coin.vel.y *= -0.5; // bounce
+            coin.vel.x *= 0.9; // friction
         }
     }
 
-    static_cast<World*>(world)->getDangerAroundPos(coin->pos, rects);
+    static_cast<World*>(world)->getDangerAroundPos(coin.pos, rects);
     for (int i{0}; i < 9; ++i)
     {
         SDL_Rect* tileRect{&(rects[i])};
         if (Util::checkCollision(&coinRect, tileRect))
         {
-            coin->dead = true;
+            coin.dead = true;
+        }
+    }
+
+    FluidType fluid{FluidType::NONE};
+    if (fluids != nullptr)
+    {
+        fluid = fluids->interact(&coinRect, coin.vel, COIN_FLUID, time_step);
+        if (fluid == FluidType::LAVA)
+        {
+            coin.dead = true;
         }
     }
     // ------------------------ Other Stuff ------------------------ //
 
-    coin->anim->tick(time_step);
+    // nothing left to do once it's been sitting still on the ground for a bit. A coin lying on a tile
+    // still makes little hops (up to ~0.35) as gravity pushes it a px in & it gets put back, and one
+    // sinking through water is slower than that, so it only goes to sleep out of any fluid, on a frame
+    // it's landed on something
+    if (fluid == FluidType::NONE && std::abs(coin.vel.x) < 0.1 && std::abs(coin.vel.y) < 0.4)
+    {
+        coin.still += time_step;
+        if (coin.still > COIN_SLEEP_TIME && landed)
+        {
+            coin.sleeping = true;
+            coin.vel = {0.0, 0.0};
+        }
+    } else {
+        coin.still = 0.0;
+    }
 }
 
-void CoinManager::renderCoin(Coin* coin, const int scrollX, const int scrollY, SDL_Renderer* renderer)
+void CoinManager::mergeCoins()
 {
-    coin->anim->render(static_cast<int>(coin->pos.x), static_cast<int>(coin->pos.y), scrollX, scrollY, renderer);
+    _Cells.clear();
+    for (std::size_t i{0}; i < _Coins.size(); ++i)
+    {
+        Coin& coin{_Coins[i]};
+        if (!coin.sleeping || coin.dead)
+        {
+            continue;
+        }
+        const int cell{static_cast<int>(std::floor(coin.pos.y / COIN_MERGE_CELL)) * 4096 + static_cast<int>(std::floor(coin.pos.x / COIN_MERGE_CELL))};
+        auto found{_Cells.find(cell)};
+        if (found == _Cells.end())
+        {
+            _Cells.emplace(cell, i);
+        } else {
+            Coin& other{_Coins[found->second]};
+            other.value += coin.value;
+            other.age = std::min(other.age, coin.age); // keep the newer one's lifetime
+            coin.dead = true;
+            coin.value = 0;
+        }
+    }
 }
 
-void CoinManager::update(const double& time_step, const int scrollX, const int scrollY, SDL_Renderer* renderer, void* world, TexMan* texman, SDL_Rect* player_rect, double& last_coin)
+void CoinManager::renderCoin(const Coin& coin, const int scrollX, const int scrollY, SpriteBatch& batch)
 {
+    if (coin.value > 1)
+    {
+        // merged coins glow, brighter the more they're worth
+        _glowTex->setBlendMode(SDL_BLENDMODE_ADD);
+        _glowTex->setAlpha(static_cast<Uint8>(std::min(255, 60 + coin.value * 8)));
+        const SDL_Rect renderQuad{static_cast<int>(coin.pos.x) - 1 - scrollX, static_cast<int>(coin.pos.y) - scrollY, 5, 5};
+        batch.draw(*_glowTex, SpriteLayer::COIN_GLOW, renderQuad);
+    }
+    SDL_Rect clip{(static_cast<int>(coin.frame) % COIN_FRAMES) * 3, 0, 3, 4};
+    batch.draw(*_coinTex, SpriteLayer::COINS, static_cast<int>(coin.pos.x) - scrollX, static_cast<int>(coin.pos.y) - scrollY, &clip);
+}
+
+void CoinManager::update(const double& time_step, const int scrollX, const int scrollY, SpriteBatch& batch, void* world, TexMan* texman, Broadphase& bodies, double& last_coin, FluidIndex* fluids)
+{
+    if (static_cast<int>(_Coins.size()) > COIN_MERGE_THRESHOLD)
+    {
+        mergeCoins();
+    }
+    // move everything first, then only the coins near the player get checked for pickup
     for (std::size_t i{0}; i < _Coins.size(); ++i)
     {
-        Coin* coin{_Coins[i]};
-        if (coin != nullptr)
+        Coin& coin{_Coins[i]};
+        if (coin.dead && coin.value == 0)
         {
-            updateCoin(coin, time_step, world);
-            renderCoin(coin, scrollX, scrollY, renderer);
-            SDL_Rect coinRect {static_cast<int>(coin->pos.x), static_cast<int>(coin->pos.y), 3, 4};
-            if (Util::checkCollision(&coinRect, player_rect))
+            continue; // merged into another coin
+        }
+        updateCoin(coin, time_step, world, fluids);
+        bodies.add(SDL_Rect{static_cast<int>(coin.pos.x), static_cast<int>(coin.pos.y), 3, 4}, BODY_COIN, 0, static_cast<uint32_t>(i));
+    }
+    _Pickups.clear();
+    bodies.queryPairs(BODY_PLAYER, BODY_COIN, _Pickups);
+    for (const std::pair<int, int>& pickup : _Pickups)
+    {
+        _Coins[bodies.getBody(pickup.second).index].collected = true;
+    }
+    for (Coin& coin : _Coins)
+    {
+        if (coin.dead && coin.value == 0)
+        {
+            continue;
+        }
+        renderCoin(coin, scrollX, scrollY, batch);
+        if (coin.collected)
+        {
+            int num{(std::rand() % 5) + 10};
+            for (int i{0}; i < num; ++i)
             {
-                int num{(std::rand() % 5) + 10};
-                for (int i{0}; i < num; ++i)
-                {
-                    _SparkManager.addSpark(new Spark{coin->pos, Util::random() * M_PI * 2.0, Util::random() * 2.0 + 0.5});
-                }
-                num = static_cast<int>(Util::random() * 5.0) + 10;
-                for (int i{0}; i < num; ++i)
-                {
-                    double angle{Util::random() * M_PI * 2.0};
-                    double speed(Util::random() * 2.0 + 1.0);
-                    addGlow(coin->pos, {std::cos(angle) * speed, std::sin(angle) * speed});
-                }
-                last_coin = 1.0;
-                delete coin->anim;
-                delete coin;
-                _Coins[i] = nullptr;
-                texman->SFX_coin_collect.play();
-            } else if (coin->dead)
+                _SparkManager.addSpark(new Spark{coin.pos, Util::random() * M_PI * 2.0, Util::random() * 2.0 + 0.5});
+            }
+            num = static_cast<int>(Util::random() * 5.0) + 10;
+            for (int i{0}; i < num; ++i)
             {
-                int num{(std::rand() % 5) + 10};
-                for (int i{0}; i < num; ++i)
-                {
-                    _SparkManager.addSpark(new Spark{coin->pos, Util::random() * M_PI * 2.0, Util::random() * 2.0 + 0.5});
-                }
-                delete coin->anim;
-                delete coin;
-                _Coins[i] = nullptr;
-            } else if (coin->timer.getTicks() > 20000)
+                double angle{Util::random() * M_PI * 2.0};
+                double speed(Util::random() * 2.0 + 1.0);
+                addGlow(coin.pos, {std::cos(angle) * speed, std::sin(angle) * speed}, coin.value);
+            }
+            last_coin = 1.0;
+            coin.dead = true;
+            texman->SFX_coin_collect.play();
+        } else if (coin.dead)
+        {
+            int num{(std::rand() % 5) + 10};
+            for (int i{0}; i < num; ++i)
             {
-                delete coin->anim;
-                delete coin;
-                _Coins[i] = nullptr;
+                _SparkManager.addSpark(new Spark{coin.pos, Util::random() * M_PI * 2.0, Util::random() * 2.0 + 0.5});
             }
+        } else if (coin.age > COIN_LIFETIME)
+        {
+            coin.dead = true;
         }
     }
-    _Coins.erase(std::remove_if(_Coins.begin(), _Coins.end(), [](Coin* coin){return (coin == nullptr);}), _Coins.end());
+    _Coins.erase(std::remove_if(_Coins.begin(), _Coins.end(), [](const Coin& coin){return coin.dead;}), _Coins.end());
 
-    for (std::size_t i{0}; i < _Glow.size(); ++i)
+    for (Glow& glow : _Glow)
     {
-        Glow* glow{_Glow[i]};
-        glow->vel.x *= 0.9;
-        glow->vel.y *= 0.9;
-        glow->pos.x += glow->vel.x * time_step;
-        glow->pos.y += glow->vel.y * time_step;
-        glow->size -= 0.4 * time_step; // decay
-        if (glow->size <= 0.0)
+        glow.vel.x *= 0.9;
+        glow.vel.y *= 0.9;
+        glow.pos.x += glow.vel.x * time_step;
+        glow.pos.y += glow.vel.y * time_step;
+        glow.size -= 0.4 * time_step; // decay
+        if (glow.size <= 0.0)
         {
-            if (glow->size < -0.5 * Util::random())
+            if (glow.size < -0.5 * Util::random())
             {
-                ++_score;
+                _score += glow.value;
                 // flash effect
                 _glowTex->setBlendMode(SDL_BLENDMODE_ADD);
                 _glowTex->setAlpha(static_cast<Uint8>(static_cast<int>(255.0)));
-                SDL_Rect renderQuad{static_cast<int>(glow->pos.x) - 1 - scrollX, static_cast<int>(glow->pos.y) - 1 - scrollY, 3, 3};
-                SDL_RenderCopyEx(renderer, _glowTex->getTexture(), NULL, &renderQuad, 0, NULL, SDL_FLIP_NONE);
-                delete glow;
-                _Glow[i] = nullptr;
+                const SDL_Rect renderQuad{static_cast<int>(glow.pos.x) - 1 - scrollX, static_cast<int>(glow.pos.y) - 1 - scrollY, 3, 3};
+                batch.draw(*_glowTex, SpriteLayer::COIN_GLOW, renderQuad);
+                glow.value = 0; // done
             }
         } else {
             _glowTex->setBlendMode(SDL_BLENDMODE_ADD);
-            _glowTex->setAlpha(static_cast<Uint8>(static_cast<int>(glow->size / 10.0 * 255.0)));
-            SDL_Rect renderQuad{static_cast<int>(glow->pos.x) - 2 - scrollX, static_cast<int>(glow->pos.y) - 2 - scrollY, 5, 5};
-            SDL_RenderCopyEx(renderer, _glowTex->getTexture(), NULL, &renderQuad, 0, NULL, SDL_FLIP_NONE);
+            _glowTex->setAlpha(static_cast<Uint8>(static_cast<int>(glow.size / 10.0 * 255.0)));
+            const SDL_Rect renderQuad{static_cast<int>(glow.pos.x) - 2 - scrollX, static_cast<int>(glow.pos.y) - 2 - scrollY, 5, 5};
+            batch.draw(*_glowTex, SpriteLayer::COIN_GLOW, renderQuad);
         }
     }
-    _Glow.erase(std::remove_if(_Glow.begin(), _Glow.end(), [](Glow* glow){return (glow == nullptr);}), _Glow.end());
+    _Glow.erase(std::remove_if(_Glow.begin(), _Glow.end(), [](const Glow& glow){return glow.value == 0;}), _Glow.end());
+}
+
+void CoinManager::updateSparks(const double& time_step, const int scrollX, const int scrollY, SDL_Renderer* renderer, TexMan* texman)
+{
     _SparkManager.setTexture(&(texman->particle));
     _SparkManager.update(time_step, scrollX, scrollY, renderer);
-}
\ No newline at end of file
+}
@@ -5,19 +5,35 @@
 #include "./vec2.hpp"
 #include "./util.hpp"
 #include "./timer.hpp"
-#include "./anim.hpp"
 #include "./sparks.hpp"
+#include "./broadphase.hpp"
+#include "./spritebatch.hpp"
 
 #include <vector>
 #include <array>
+#include <unordered_map>
 
+class FluidIndex;
+
+inline constexpr int COIN_FRAMES{2};
+inline constexpr double COIN_ANIM_SPEED{0.2};
+inline constexpr double COIN_LIFETIME{1200.0}; // frames @ 60fps, ~20 seconds
+inline constexpr double COIN_SLEEP_TIME{30.0}; // frames a coin has to sit still before it sleeps
+inline constexpr int COIN_MERGE_THRESHOLD{64}; // start merging once there are more coins than this
+inline constexpr int COIN_MERGE_CELL{8}; // px, sleeping coins in the same cell get merged
+
+// coins are plain values now, sleeping coins skip physics and only check for pickup
 struct Coin
 {
     vec2<double> pos;
     vec2<double> vel;
-    Anim* anim;
+    double frame{0.0};
+    double age{0.0};
+    int value{1}; // merged coins are worth more
     bool dead{false};
-    Timer timer{};
+    bool sleeping{false};
+    double still{0.0}; // frames spent not moving
+    bool collected{false}; // touched the player this frame
 };
 
 struct Glow
@@ -25,20 +41,22 @@ struct Glow
     vec2<double> pos;
     vec2<double> vel;
     double size;
+    int value{1}; // score added when it fades out
 };
 
 class CoinManager
 {
 private:
-    std::vector<Coin*> _Coins;
+    std::vector<Coin> _Coins;
     Texture* _coinTex{nullptr};
     Texture* _glowTex{nullptr};
 
     SparkManager _SparkManager{0.0, 0.2, 1.0, nullptr};
 
-    Timer timer{};
+    std::vector<Glow> _Glow;
 
-    std::vector<Glow*> _Glow;
+    std::unordered_map<int, std::size_t> _Cells{}; // merge scratch: cell -> coin
+    std::vector<std::pair<int, int>> _Pickups{}; // pickup scratch: (player, coin) bodies
 
     int _score{0};
 
@@ -49,20 +67,27 @@ public:
 
     int getScore() {return _score;}
     void setScore(int val) {_score = val;}
+    int getCount() {return static_cast<int>(_Coins.size());}
 
     void setTex(Texture* coinTex, Texture* glowTex);
     
     void free();
 
-    void addGlow(vec2<double> pos, vec2<double> vel);
+    void addGlow(vec2<double> pos, vec2<double> vel, int value);
 
     void addCoin(vec2<double> pos, vec2<double> vel);
 
-    void updateCoin(Coin* coin, const double& time_step, void* world);
+    void updateCoin(Coin& coin, const double& time_step, void* world, FluidIndex* fluids);
+
+    // folds sleeping coins sharing a cell into one coin worth all of them
+    void mergeCoins();
 
-    void renderCoin(Coin* coin, const int scrollX, const int scrollY, SDL_Renderer* renderer);
+    void renderCoin(const Coin& coin, const int scrollX, const int scrollY, SpriteBatch& batch);
 
-    void update(const double& time_step, const int scrollX, const int scrollY, SDL_Renderer* renderer, void* world, TexMan* texman, SDL_Rect* player_rect, double& last_coin);
+    // coins get added to bodies, and picked up by any player body touching them
+    void update(const double& time_step, const int scrollX, const int scrollY, SpriteBatch& batch, void* world, TexMan* texman, Broadphase& bodies, double& last_coin, FluidIndex* fluids);
+    // pickup sparks are drawn straight to the renderer, so these go after the batch is flushed
+    void updateSparks(const double& time_step, const int scrollX, const int scrollY, SDL_Renderer* renderer, TexMan* texman);
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -6,11 +6,14 @@ inline constexpr int START_COINS{1000};
 inline constexpr int TILE_SIZE {8};
 inline constexpr int CHUNK_SIZE {9};
 
-inline constexpr int MAX_ENTITIES {512}; // max number of entities per entity manager
-
 // level dimensions in chunks
 inline constexpr int LEVEL_WIDTH {14};
 inline constexpr int LEVEL_HEIGHT {7};
+// level dimensions in tiles
+inline constexpr int LEVEL_TILE_WIDTH {LEVEL_WIDTH * CHUNK_SIZE};
+inline constexpr int LEVEL_TILE_HEIGHT {LEVEL_HEIGHT * CHUNK_SIZE};
+
+inline constexpr double CAMERA_LEAD {24.0}; // px the camera looks ahead of the player
 
 inline constexpr int WINDOW_WIDTH {660};
 inline constexpr int WINDOW_HEIGHT {660};
@@ -1,887 +1,890 @@
 #include "./entities.hpp"
 
-Entity::Entity(vec2<double> pos, vec2<double> vel, double gravity, bool peaceful, std::string name)
-    : _pos{pos}, _vel{vel}, _gravity{gravity}, _peaceful{peaceful}, _name{name}
-{
-    _id = sId;
-    ++sId;
-    _rect.x = pos.x;
-    _rect.y = pos.y;
-    _rect.w = _dimensions.x;
-    _rect.h = _dimensions.y;
-}
-
-int Entity::getId()
-{
-    return _id;
+// ------------------------ Storage
+
+void EntityStore::reserve(const std::size_t num)
+{
+    pos.reserve(num);
+    vel.reserve(num);
+    rect.reserve(num);
+    health.reserve(num);
+    hurt_time.reserve(num);
+    falling.reserve(num);
+    speed.reserve(num);
+    clip.reserve(num);
+    frame.reserve(num);
+    flags.reserve(num);
+    id.reserve(num);
+    tier.reserve(num);
+    step.reserve(num);
+    idle.reserve(num);
+    behaviour.reserve(num);
+}
+
+void EntityStore::clear()
+{
+    pos.clear();
+    vel.clear();
+    rect.clear();
+    health.clear();
+    hurt_time.clear();
+    falling.clear();
+    speed.clear();
+    clip.clear();
+    frame.clear();
+    flags.clear();
+    id.clear();
+    tier.clear();
+    step.clear();
+    idle.clear();
+    behaviour.clear();
+}
+
+std::size_t EntityStore::add(const vec2<double> p, const vec2<double> v, const vec2<int> dimensions, const double hp, const uint32_t uid)
+{
+    pos.push_back(p);
+    vel.push_back(v);
+    rect.push_back(SDL_Rect{static_cast<int>(p.x), static_cast<int>(p.y), dimensions.x, dimensions.y});
+    health.push_back(hp);
+    hurt_time.push_back(ENTITY_NEVER_HURT);
+    falling.push_back(99.0);
+    speed.push_back(Util::random() * 1.0 + 0.25);
+    clip.push_back(CLIP_IDLE);
+    frame.push_back(0.0);
+    flags.push_back(0);
+    id.push_back(uid);
+    tier.push_back(static_cast<uint8_t>(ActivityTier::ACTIVE));
+    step.push_back(0.0);
+    idle.push_back(0.0);
+    behaviour.emplace_back();
+    return pos.size() - 1;
+}
+
+template <typename T>
+static void swapAndPop(std::vector<T>& vec, const std::size_t i)
+{
+    vec[i] = std::move(vec.back());
+    vec.pop_back();
+}
+
+void EntityStore::remove(const std::size_t i)
+{
+    swapAndPop(pos, i);
+    swapAndPop(vel, i);
+    swapAndPop(rect, i);
+    swapAndPop(health, i);
+    swapAndPop(hurt_time, i);
+    swapAndPop(falling, i);
+    swapAndPop(speed, i);
+    swapAndPop(clip, i);
+    swapAndPop(frame, i);
+    swapAndPop(flags, i);
+    swapAndPop(id, i);
+    swapAndPop(tier, i);
+    swapAndPop(step, i);
+    swapAndPop(idle, i);
+    swapAndPop(behaviour, i);
+}
+
+// ------------------------ Entity Manager
+
+EntityManager::EntityManager(const EntityType type, TexMan* texman)
+    : _type{type}, _recipe{&getRecipe(type)}, _texman{texman}, _HealthBar{&(texman->enemyHealthBar), {12, 2}, getRecipe(type).max_health}
+{
+    _HealthBar.setDimensions({_recipe->health_bar.x, 2});
+    _HealthBar.setOffset({_recipe->health_bar.y, 0});
+    _Particles.setPalette<8>(_recipe->palette.data());
 }
 
-vec2<double> &Entity::getPos()
-{
-    return _pos;
-}
-
-vec2<double> Entity::getCenter()
-{
-    return {_pos.x + _dimensions.x / 2.0, _pos.y + _dimensions.y / 2.0};
-}
-
-void Entity::updateRect()
+EntityManager::~EntityManager()
 {
-    _rect.x = _pos.x;
-    _rect.y = _pos.y;
+    free();
 }
 
-SDL_Rect *Entity::getRect()
+void EntityManager::free()
 {
-    return &_rect;
+    _Store.clear();
+    _Index.clear();
+    _Wheel.clear();
+    _Woken.clear();
+    _TierCounts.fill(0);
 }
 
-bool Entity::getShouldDie()
+void EntityManager::addEntity(const vec2<double> pos, const vec2<double> vel)
 {
-    return _should_die;
+    const uint32_t id{_next_id++};
+    const std::size_t i{_Store.add(pos, vel, _recipe->dimensions, _recipe->max_health, id)};
+    _Index.resize(id + 1, NO_ENTITY);
+    _Index[id] = static_cast<uint32_t>(i);
+    if (!_recipe->flocks)
+    {
+        _Store.behaviour[i] = roam(id);
+        resume(i);
+    }
 }
 
-bool Entity::getFlipped()
+void EntityManager::remove(const std::size_t i)
 {
-    return _flipped;
+    _Index[_Store.id[i]] = NO_ENTITY;
+    _Store.remove(i);
+    if (i < _Store.size())
+    {
+        _Index[_Store.id[i]] = static_cast<uint32_t>(i);
+    }
 }
 
-bool Entity::getPeaceful()
+vec2<double> EntityManager::getCenter(const std::size_t i) const
 {
-    return _peaceful;
+    return {_Store.pos[i].x + _recipe->dimensions.x / 2.0, _Store.pos[i].y + _recipe->dimensions.y / 2.0};
 }
 
-std::string_view Entity::getName()
+void EntityManager::updateRect(const std::size_t i)
 {
-    return _name;
+    _Store.rect[i].x = _Store.pos[i].x;
+    _Store.rect[i].y = _Store.pos[i].y;
 }
 
-void Entity::damage(const double damage, double* screen_shake)
+void EntityManager::damage(const std::size_t i, const double amount, double* screen_shake)
 {
+    if (_recipe->hides)
+    {
+        _Store.vel[i].x *= 0.1;
+    }
     *screen_shake = std::max(*screen_shake, 6.0);
-    _recover = 0.0;
-    _should_damage = true;
-    setHealth(getHealth() - damage);
-    if (getHealth() <= 0.0)
+    _Store.hurt_time[i] = _Wheel.getTime();
+    _Store.setFlag(i, FLAG_SHOULD_DAMAGE, true);
+    _Store.health[i] -= amount;
+    if (_Store.health[i] <= 0.0)
     {
         *screen_shake = std::max(*screen_shake, 8.0);
-        die(screen_shake);
+        die(i);
+    }
+    if (_recipe->flying)
+    {
+        double angle = Util::random() * 2.0 * M_PI;
+        _Store.vel[i].x += std::cos(angle) * 5.0;
+        _Store.vel[i].y += std::sin(angle) * 5.0;
     }
 }
 
-void Entity::die(double *screen_shake)
+void EntityManager::die(const std::size_t i)
 {
-    // if (!_should_die)
-    //     *screen_shake = std::max(*screen_shake, 8.0);
-    _should_die = true;
-    _vel.x = 0;
+    _Store.setFlag(i, FLAG_SHOULD_DIE, true);
+    _Store.vel[i].x = 0;
 }
 
-void Entity::update(const double &time_step, World &world, double *screen_shake)
+void EntityManager::playBurst(const EffectBurst& burst, const vec2<double> pos)
 {
-    _falling += time_step;
-    _recover += time_step;
-    _wander_timer -= time_step;
-    if (_wander_timer <= 0.0)
+    if (burst.particles > 0)
     {
-        _wandering = !_wandering;
-        _wander_timer = (std::rand() % 180) + 60;
+        _Particles.setPos(pos);
+        _Particles.setSpawning(burst.particles, burst.particle_spread, SDL_Color{0x00, 0x00, 0x00});
+    }
+    if (burst.smoke > 0)
+    {
+        _Smoke.setPos(pos);
+        _Smoke.setSpawning(burst.smoke, {1, 2}, {0x88, 0x88, 0x88});
+    }
+    if (burst.fire > 0)
+    {
+        _Fire.setPos(pos);
+        _Fire.setSpawning(burst.fire);
+    }
+    if (burst.sparks > 0)
+    {
+        int num{(std::rand() % burst.extra_sparks) + burst.sparks};
+        for (int i{0}; i < num; ++i)
+        {
+            _SparkManager.addSpark(new Spark{pos, Util::random() * M_PI * 2.0, Util::random() * burst.extra_speed + burst.spark_speed});
+        }
     }
-
-    updateVel(time_step);
-    handlePhysics(time_step, _vel, world, screen_shake);
-    updateHealthBar();
 }
 
-void Entity::updateVel(const double &time_step)
-{
-    _vel.x = std::min(std::max(_vel.x, -_top_speed), _top_speed);
-    _vel.y += _gravity * time_step;
-}
+// ------------------------ Behaviours
 
-void Entity::handlePhysics(const double &time_step, vec2<double> frame_movement, World &world, double *screen_shake)
+void EntityManager::walk(const std::size_t i, const double& time_step, World& world)
 {
-    _pos.x += frame_movement.x * time_step;
-    _rect.x = _pos.x;
-    _rect.y = _pos.y;
+    vec2<double>& pos{_Store.pos[i]};
+    vec2<double>& vel{_Store.vel[i]};
+    SDL_Rect& rect{_Store.rect[i]};
+    const vec2<double> frame_movement{vel};
+
+    pos.x += frame_movement.x * time_step;
+    updateRect(i);
 
     std::array<SDL_Rect, 9> rects;
-    world.getTilesAroundPos(_pos, rects);
-    for (int i{0}; i < 9; ++i)
+    world.getTilesAroundPos(pos, rects);
+    for (SDL_Rect& tile_rect : rects)
     {
-        SDL_Rect *tile_rect{&(rects[i])};
-        if (Util::checkCollision(&_rect, tile_rect))
+        if (Util::checkCollision(&rect, &tile_rect))
         {
             if (frame_movement.x > 0)
             {
-                _rect.x = tile_rect->x - _rect.w;
+                rect.x = tile_rect.x - rect.w;
             }
             else
             {
-                _rect.x = tile_rect->x + tile_rect->w;
+                rect.x = tile_rect.x + tile_rect.w;
             }
-            _pos.x = _rect.x;
-            _vel.x = 0;
+            pos.x = rect.x;
+            vel.x = 0;
         }
     }
 
-    _pos.y += frame_movement.y * time_step;
-    _rect.x = _pos.x;
-    _rect.y = _pos.y;
+    pos.y += frame_movement.y * time_step;
+    updateRect(i);
 
-    world.getTilesAroundPos(_pos, rects);
-    for (int i{0}; i < 9; ++i)
+    world.getTilesAroundPos(pos, rects);
+    for (SDL_Rect& tile_rect : rects)
     {
-        SDL_Rect *tile_rect{&(rects[i])};
-        if (Util::checkCollision(&_rect, tile_rect))
+        if (Util::checkCollision(&rect, &tile_rect))
         {
             if (frame_movement.y > 0)
             {
-                _rect.y = tile_rect->y - _rect.h;
-                _falling = 0.0;
+                rect.y = tile_rect.y - rect.h;
+                _Store.falling[i] = 0.0;
             }
             else
             {
-                _rect.y = tile_rect->y + tile_rect->h;
+                rect.y = tile_rect.y + tile_rect.h;
             }
-            _vel.y = 0.0;
-            _pos.y = _rect.y;
+            vel.y = 0.0;
+            pos.y = rect.y;
         }
     }
+}
+
+void EntityManager::fly(const std::size_t i, const double& time_step, World& world)
+{
+    vec2<double>& pos{_Store.pos[i]};
+    vec2<double>& vel{_Store.vel[i]};
+    SDL_Rect& rect{_Store.rect[i]};
+    const vec2<double> frame_movement{vel};
+    const double speed{_Store.speed[i]};
+
+    pos.x += frame_movement.x * time_step * speed;
+    updateRect(i);
 
-    world.getDangerAroundPos(_pos, rects);
-    for (int i{0}; i < 9; ++i)
+    std::array<SDL_Rect, 9> rects;
+    world.getTilesAroundPos(pos, rects);
+    for (SDL_Rect& tile_rect : rects)
     {
-        SDL_Rect *tile_rect{&(rects[i])};
-        if (Util::checkCollision(&_rect, tile_rect))
+        if (Util::checkCollision(&rect, &tile_rect))
         {
-            die(screen_shake);
-            break;
+            if (frame_movement.x > 0)
+            {
+                rect.x = tile_rect.x - rect.w;
+            } else {
+                rect.x = tile_rect.x + tile_rect.w;
+            }
+            pos.x = rect.x;
+            vel.x *= -1.2;
+            vel.y *= 1.2;
         }
     }
-}
 
-void Entity::render(const int scrollX, const int scrollY, SDL_Renderer *renderer)
-{
-    SDL_Rect renderRect{static_cast<int>(_pos.x) - scrollX, static_cast<int>(_pos.y) - scrollY, _dimensions.x, _dimensions.y};
-    if (_recover < _recover_time - 1.0)
-    {
-        SDL_SetRenderDrawColor(renderer, 0xFF, 0xFF, 0xFF, 0xFF);
-    }
-    else
+    pos.y += frame_movement.y * time_step * speed;
+    updateRect(i);
+
+    world.getTilesAroundPos(pos, rects);
+    for (SDL_Rect& tile_rect : rects)
     {
-        SDL_SetRenderDrawColor(renderer, 0xFF, 0x00, 0x00, 0xFF);
+        if (Util::checkCollision(&rect, &tile_rect))
+        {
+            if (frame_movement.y > 0)
+            {
+                rect.y = tile_rect.y - rect.h;
+                _Store.falling[i] = 0.0;
+            } else {
+                rect.y = tile_rect.y + tile_rect.h;
+            }
+            vel.y *= -1;
+            pos.y = rect.y;
+        }
     }
-
-    SDL_RenderFillRect(renderer, &renderRect);
+    vel.x = std::min(3.0, std::max(-3.0, vel.x));
+    vel.y = std::min(3.0, std::max(-3.0, vel.y));
 }
 
-void Entity::touchPlayer(Player *player, double *screen_shake, double* slomo, ShockWaveManager& shockwaves)
+void EntityManager::hitSpikes(const std::size_t i, World& world)
 {
-    _rect.x = _pos.x;
-    _rect.y = _pos.y;
-    SDL_Rect *player_rect{player->getRect()};
-    if (player->getAttacking())
+    std::array<SDL_Rect, 9> rects;
+    world.getDangerAroundPos(_Store.pos[i], rects);
+    for (SDL_Rect& tile_rect : rects)
     {
-        SDL_Rect playerAttackRect {player->getAttackRect()};
-        if (Util::checkCollision(&_rect, &playerAttackRect) && _recover > _recover_time && player->getRecover() > 10.0)
+        if (Util::checkCollision(&_Store.rect[i], &tile_rect))
         {
-            damage(player->getSwordDamage(), screen_shake);
+            die(i);
+            break;
         }
-    } else if (Util::checkCollision(player_rect, &_rect) && _recover > _recover_time && player->getRecover() > 10.0)
-    {
-        player->damage(_damage, screen_shake, slomo, shockwaves);
     }
 }
 
-void Entity::followPlayer(Player *player, World *world, const double& time_step)
+void EntityManager::followPlayer(const std::size_t i, Player* player, World& world, const FlowField* flow, const double& time_step)
 {
-    SDL_Rect *player_rect{player->getRect()};
-    vec2<double> player_pos{player->getCenter()};
-    if (Util::distance(player_pos, getCenter()) < 100.0)
+    const vec2<double> player_pos{player->getCenter()};
+    const vec2<double> center{getCenter(i)};
+    if (flow == nullptr || Util::distance(player_pos, center) >= 100.0)
+    {
+        wander(i, world, time_step, 0.08);
+        return;
+    }
+    vec2<double>& vel{_Store.vel[i]};
+    bool flipped{_Store.hasFlag(i, FLAG_FLIPPED)};
+    vec2<int> step;
+    if (flow->getStep(FlowLayer::WALKER, center, step))
     {
-        vec2<double> checkTilePos{getCenter().x + (_flipped ? -10.0 : 10.0), getCenter().y + 8};
-        Tile *tile{world->getTileAt(checkTilePos.x, checkTilePos.y)};
-        if (tile == nullptr)
+        const vec2<int> tile{static_cast<int>(std::floor(center.x / TILE_SIZE)), static_cast<int>(std::floor(center.y / TILE_SIZE))};
+        // same tile as the player, go straight for them
+        const double target_x{step.x == tile.x && step.y == tile.y ? player_pos.x : (step.x + 0.5) * TILE_SIZE};
+        if (std::abs(target_x - center.x) > 0.5)
         {
-            if (!(std::abs(static_cast<int>(player_pos.x - getCenter().x)) < 16 && player_pos.y > getCenter().y + 4.0 && _falling < 3.0))
-            {
-                _vel.x += (_flipped ? 0.2 : -0.2) * time_step;
-                _flipped = !_flipped;
-            }
+            flipped = target_x < center.x;
+            vel.x += (flipped ? -0.1 : 0.1) * time_step;
         }
-        else if (Util::elementIn<TileType, std::size(DANGER_TILES)>(tile->type, DANGER_TILES))
+        if (step.y < tile.y && _Store.falling[i] < 3.0)
         {
-            if (!(std::abs(static_cast<int>(player_pos.x - getCenter().x)) < 16 && player_pos.y > getCenter().y + 4.0 && _falling < 3.0))
-            {
-                _vel.x += (_flipped ? 0.2 : -0.2) * time_step;
-                _flipped = !_flipped;
-            }
+            vel.y = -3.2;
         }
-        else
+    } else if (_Store.falling[i] >= 3.0)
+    {
+        // in the air (mid jump or dropping off a ledge), keep going the way it was
+        vel.x += (flipped ? -0.1 : 0.1) * time_step;
+    } else {
+        // no way to get to the player from here
+        wander(i, world, time_step, 0.08);
+        return;
+    }
+    _Store.setFlag(i, FLAG_FLIPPED, flipped);
+    _Store.setFlag(i, FLAG_ANIM_FLIPPED, flipped);
+}
+
+void EntityManager::flyToPlayer(const std::size_t i, Player* player, World& world, const FlowField* flow, const double& time_step)
+{
+    const vec2<double> player_pos{player->getCenter()};
+    const vec2<double> center{getCenter(i)};
+    vec2<int> step;
+    if (flow == nullptr || Util::distance(player_pos, center) >= 200.0 || !flow->getStep(FlowLayer::FLYER, center, step))
+    {
+        wander(i, world, time_step, 0.08);
+        return;
+    }
+    vec2<double>& vel{_Store.vel[i]};
+    // head for the middle of the next tile, or the player once it's sharing a tile with them
+    const bool there{step.x == static_cast<int>(std::floor(center.x / TILE_SIZE)) && step.y == static_cast<int>(std::floor(center.y / TILE_SIZE))};
+    const vec2<double> target{there ? player_pos : vec2<double>{(step.x + 0.5) * TILE_SIZE, (step.y + 0.5) * TILE_SIZE}};
+    vel.x += std::max(-0.1, std::min(0.1, (target.x - center.x) * 0.02)) * time_step;
+    vel.y += std::max(-0.1, std::min(0.1, (target.y - center.y) * 0.02)) * time_step;
+    vel.x += (vel.x * 0.95 - vel.x) * time_step;
+    vel.y += (vel.y * 0.95 - vel.y) * time_step;
+}
+
+void EntityManager::wander(const std::size_t i, World& world, const double& time_step, const double speed)
+{
+    vec2<double>& vel{_Store.vel[i]};
+    bool flipped{_Store.hasFlag(i, FLAG_FLIPPED)};
+    if (_Store.hasFlag(i, FLAG_WANDERING))
+    {
+        const vec2<double> center{getCenter(i)};
+        const double ahead{flipped ? -10.0 : 10.0};
+        // look down just in front for the ground, then straight ahead for a wall
+        const RayHit ground{world.raycast(Ray{{center.x + ahead, center.y}, {0.0, 1.0}, 10.0}, RAY_SOLID | RAY_DANGER)};
+        if (!ground.hit || world.blocksRay(ground.tile.x, ground.tile.y, RAY_DANGER))
         {
-            if (player_pos.x > getCenter().x) // player is to the right of entity
-            {
-                _flipped = false;
-            }
-            else
-            {
-                _flipped = true;
-            }
-            _vel.x += (_flipped ? -0.1 : 0.1) * time_step;
-            _anim_flipped = _flipped;
+            vel.x += (flipped ? 0.2 : -0.2) * time_step;
+            flipped = !flipped;
         }
-        if (player_pos.y + 4.0 < getCenter().y)
+        else
         {
-            if (_falling < 3.0)
+            if (world.raycast(Ray{center, {ahead, 0.0}, std::abs(ahead)}).hit)
             {
-                _vel.y = -3.2;
+                flipped = !flipped;
             }
+            vel.x += flipped ? -speed : speed;
         }
     }
     else
     {
-        wander(world, time_step);
+        vel.x *= 0.8;
     }
+    _Store.setFlag(i, FLAG_FLIPPED, flipped);
+    _Store.setFlag(i, FLAG_ANIM_FLIPPED, flipped);
 }
 
-void Entity::wander(World *world, const double& time_step)
+void EntityManager::touchPlayer(const std::size_t i, Player* player, double* screen_shake, double* slomo, EventQueue& events)
 {
+    updateRect(i);
+    SDL_Rect* rect{&_Store.rect[i]};
+    const bool recovered{getRecover(i) > ENTITY_RECOVER_TIME};
+    if (player->getAttacking())
+    {
+        SDL_Rect playerAttackRect {player->getAttackRect()};
+        if (Util::checkCollision(rect, &playerAttackRect) && recovered && player->getRecover() > 10.0)
         {
-        if (_wandering)
+            damage(i, player->getSwordDamage(), screen_shake);
+        }
+        if (!_recipe->flying)
         {
-            vec2<double> checkTilePos{getCenter().x + (_flipped ? -10.0 : 10.0), getCenter().y + 10};
-            Tile *tile{world->getTileAt(checkTilePos.x, checkTilePos.y)};
-            if (tile == nullptr)
-            {
-                _vel.x += (_flipped ? 0.2 : -0.2) * time_step;
-                _flipped = !_flipped;
-            }
-            else if (Util::elementIn<TileType, std::size(DANGER_TILES)>(tile->type, DANGER_TILES))
-            {
-                _vel.x += (_flipped ? 0.2 : -0.2) * time_step;
-                _flipped = !_flipped;
-            }
-            else
-            {
-                checkTilePos = {getCenter().x + (_flipped ? -10.0 : 10.0), getCenter().y};
-                tile = {world->getTileAt(checkTilePos.x, checkTilePos.y)};
-                if (tile != nullptr)
-                {
-                    if (Util::elementIn<TileType, std::size(SOLID_TILES)>(tile->type, SOLID_TILES))
-                    {
-                        _flipped = !_flipped;
-                    }
-                }
-                _vel.x += _flipped ? -0.08 : 0.08;
-            }
+            return;
         }
-        else
+    }
+    if (_recipe->flying)
+    {
+        // bats bite even while recovering, and bounce off
+        if (Util::checkCollision(player->getRect(), rect) && player->getRecover() > 10.0)
         {
-            _vel.x *= 0.8;
+            double angle = Util::random() * 2.0 * M_PI;
+            _Store.vel[i].x += std::cos(angle) * 5.0;
+            _Store.vel[i].y += std::sin(angle) * 5.0;
+            player->damage(_recipe->damage, screen_shake, slomo, events);
         }
-        _anim_flipped = _flipped;
+    } else if (Util::checkCollision(player->getRect(), rect) && recovered && player->getRecover() > 10.0)
+    {
+        player->damage(_recipe->damage, screen_shake, slomo, events);
     }
 }
 
-void Entity::updateHealthBar()
+void EntityManager::stomp(const std::size_t i, Player* player, double* screen_shake)
 {
-    if (_health_bar != nullptr)
+    updateRect(i);
+    SDL_Rect* rect{&_Store.rect[i]};
+    if (Util::checkCollision(rect, player->getRect()))
     {
-        _health_bar->update(this);
+        if (player->getFalling() > 3.0 && player->getVelY() > 0.1)
+        {
+            player->setVelY(-3.6);
+            _Store.clip[i] = CLIP_LAND;
+            _Store.frame[i] = 2.0; // at the bottom
+            _Store.setFlag(i, FLAG_LANDING, true);
+            _Store.setFlag(i, FLAG_WANDERING, false);
+            _Store.setFlag(i, FLAG_JUMPED_ON, true);
+            signal(i, SIGNAL_STOMPED);
+        }
     }
-}
-
-void Entity::renderHealthBar(const int scrollX, const int scrollY, SDL_Renderer* renderer)
-{
-    if (_health_bar != nullptr && getHealth() < getMaxHealth())
+    if (player->getAttacking())
     {
-        _health_bar->render(scrollX, scrollY, renderer, this);
+        SDL_Rect playerAttackRect {player->getAttackRect()};
+        if (Util::checkCollision(rect, &playerAttackRect) && getRecover(i) > ENTITY_RECOVER_TIME)
+        {
+            damage(i, player->getSwordDamage() * 0.5, screen_shake);
+        }
     }
 }
 
-Slime::Slime(vec2<double> pos, vec2<double> vel, double gravity, bool peaceful, std::string name, TexMan* texman)
-    : Entity{pos, vel, gravity, peaceful, name}
+void EntityManager::setClip(const std::size_t i, const EntityClip clip)
 {
-    loadAnim(texman);
-    _maxHealth = 40.0;
-    _health = 40.0;
+    if (_Store.clip[i] != clip)
+    {
+        _Store.clip[i] = clip;
+        _Store.frame[i] = 0.0;
+    }
 }
 
-Slime::~Slime()
-{
-    delete _idleAnim;
-    delete _runAnim;
-    delete _jumpAnim;
-    delete _flash;
-}
+// ------------------------ Behaviour coroutines
 
-void Slime::loadAnim(TexMan* texman)
+// standing about and wandering take turns. Stompable ones hide in their shell for a bit when
+// they get jumped on, and being jumped on again while hiding starts the wait over
+Behaviour EntityManager::roam(const uint32_t id)
 {
-    _idleAnim = new Anim{13, 9, 6, 0.16, true, &(texman->slimeIdle)};
-    _runAnim = new Anim{13, 9, 5, 0.2, true, &(texman->slimeRun)};
-    _jumpAnim = new Anim{13, 9, 8, 0.21, true, &(texman->slimeJump)};
-    _flash = new Anim{13, 9, 1, 0.2, true, &(texman->slimeFlash)};
-    Entity::loadAnim(texman);
-    _health_bar->setDimensions({11, 2});
+    const uint8_t signals{_recipe->stompable ? SIGNAL_STOMPED : SIGNAL_NONE};
+    double ticks{static_cast<double>(std::rand() % 180 + 1)};
+    for (;;)
+    {
+        const uint8_t woke{co_await waitUntil(signals, ticks)};
+        const std::size_t i{getIndex(id)};
+        if (woke & SIGNAL_STOMPED)
+        {
+            // stomp() has already stopped it
+            ticks = 100.0;
+            continue;
+        }
+        _Store.setFlag(i, FLAG_WANDERING, !_Store.hasFlag(i, FLAG_WANDERING));
+        ticks = std::rand() % 180 + 60;
+    }
 }
 
-void Slime::handleAnim(const double& time_step)
+void EntityManager::resume(const std::size_t i)
 {
-    _anim = _idleAnim;
-    if (_falling >= 3.0)
+    Behaviour& behaviour{_Store.behaviour[i]};
+    behaviour.resume();
+    if (behaviour.done())
     {
-        _anim = _jumpAnim;
-        _runAnim->reset();
-        _idleAnim->reset();
-    } else if (std::abs(_vel.x) > 0.05)
+        return;
+    }
+    BehaviourPromise& promise{behaviour.getPromise()};
+    if (promise.ticks > 0.0)
     {
-        _anim = _runAnim;
-        _jumpAnim->reset();
-        _idleAnim->reset();
-    } else {
-        _anim = _idleAnim;
-        _jumpAnim->reset();
-        _runAnim->reset();
+        _Wheel.schedule(promise.ticks, _Store.id[i], ++promise.token);
     }
-    _anim->setFlipped(_anim_flipped ? SDL_FLIP_HORIZONTAL : SDL_FLIP_NONE);
-    _anim->tick(time_step);
-}
-
-void Slime::update(const double& time_step, World& world, double* screen_shake)
-{
-    handleAnim(time_step);
-    Entity::update(time_step, world, screen_shake);
 }
 
-void Slime::render(const int scrollX, const int scrollY, SDL_Renderer* renderer)
+void EntityManager::signal(const std::size_t i, const uint8_t signals)
 {
-    if (_recover > _recover_time)
+    Behaviour& behaviour{_Store.behaviour[i]};
+    if (!behaviour.valid() || behaviour.done())
     {
-        _anim->render((int)_pos.x - _anim_offset.x, (int)_pos.y - _anim_offset.y, scrollX, scrollY, renderer);
-    } else {
-        _flash->render((int)_pos.x - _anim_offset.x, (int)_pos.y - _anim_offset.y, scrollX, scrollY, renderer);
+        return;
+    }
+    BehaviourPromise& promise{behaviour.getPromise()};
+    if (promise.waiting & signals)
+    {
+        promise.woke = promise.waiting & signals;
+        promise.waiting = SIGNAL_NONE;
+        ++promise.token; // its timer's stale now
+        _Woken.push_back(_Store.id[i]);
     }
-    Entity::renderHealthBar(scrollX, scrollY, renderer);
-}
-
-
-Bat::Bat(vec2<double> pos, vec2<double> vel, double gravity, bool peaceful, std::string name, TexMan* texman)
-    : Entity{pos, vel, 0.05, peaceful, name}
-{
-    loadAnim(texman);
-    _maxHealth = 20.0;
-    _health = 20.0;
 }
 
-Bat::~Bat()
-{
-    delete _anim;
-    delete _flash;
-}
+// ------------------------ Systems
 
-void Bat::loadAnim(TexMan* texman)
+void EntityManager::updateTiers(const double& time_step, const SDL_Rect& view, Player* player)
 {
-    _anim = new Anim{7, 4, 2, 0.3, true, &(texman->bat)};
-    _flash = new Anim{7, 4, 1, 0.2, true, &(texman->batFlash)};
-    _glowTex = &(texman->lightTex);
-    Entity::loadAnim(texman);
-    _health_bar->setDimensions({7, 2});
-    _health_bar->setOffset({1, 0});
-}
+    ++_tick;
+    _TierCounts.fill(0);
+    const SDL_Rect active{view.x - ACTIVE_MARGIN, view.y - ACTIVE_MARGIN, view.w + ACTIVE_MARGIN * 2, view.h + ACTIVE_MARGIN * 2};
+    const SDL_Rect reduced{view.x - REDUCED_MARGIN, view.y - REDUCED_MARGIN, view.w + REDUCED_MARGIN * 2, view.h + REDUCED_MARGIN * 2};
+    const vec2<double> player_pos{player->getCenter()};
+    for (std::size_t i{0}; i < _Store.size(); ++i)
+    {
+        // only positions & the tick count go in, so the same inputs always give the same tiers
+        const SDL_Rect& rect{_Store.rect[i]};
+        ActivityTier tier{ActivityTier::FROZEN};
+        if (Util::checkCollision(&rect, &active) || Util::distance(player_pos, getCenter(i)) < ACTIVE_PLAYER_RANGE)
+        {
+            tier = ActivityTier::ACTIVE;
+        } else if (Util::checkCollision(&rect, &reduced))
+        {
+            tier = ActivityTier::REDUCED;
+        }
 
-void Bat::handleAnim(const double& time_step)
-{
-    _anim->setAngle(_angle);
-    _anim->tick(time_step);
+        switch (tier)
+        {
+            case ActivityTier::ACTIVE:
+                _Store.step[i] = _Store.idle[i] + time_step;
+                _Store.idle[i] = 0.0;
+                break;
+            case ActivityTier::REDUCED:
+                _Store.idle[i] += time_step;
+                if ((_tick + _Store.id[i]) % REDUCED_INTERVAL == 0)
+                {
+                    _Store.step[i] = _Store.idle[i];
+                    _Store.idle[i] = 0.0;
+                } else {
+                    _Store.step[i] = 0.0;
+                }
+                break;
+            default:
+                // time stands still, so it doesn't have anything to catch up on when it wakes
+                _Store.step[i] = 0.0;
+                _Store.idle[i] = 0.0;
+                break;
+        }
+        _Store.tier[i] = static_cast<uint8_t>(tier);
+        ++_TierCounts[static_cast<std::size_t>(tier)];
+    }
 }
 
-void Bat::handlePhysics(const double& time_step, vec2<double> frame_movement, World& world, double* screen_shake)
+void EntityManager::updateBehaviours(const double& time_step)
 {
-    _pos.x += frame_movement.x * time_step * _speed;
-    _rect.x = _pos.x;
-    _rect.y = _pos.y;
-
-    std::array<SDL_Rect, 9> rects;
-    world.getTilesAroundPos(_pos, rects);
-    for (int i{0}; i < 9; ++i)
+    // only the timers that came round get looked at, everything else is asleep
+    _Due.clear();
+    _Wheel.advance(time_step, _Due);
+    for (const TimerEntry& entry : _Due)
     {
-        SDL_Rect* tile_rect {&(rects[i])};
-        if (Util::checkCollision(&_rect, tile_rect))
+        const std::size_t i{getIndex(entry.id)};
+        if (i == NO_ENTITY || _Store.behaviour[i].getPromise().token != entry.token)
         {
-            if (frame_movement.x > 0)
-            {
-                _rect.x = tile_rect->x - _rect.w;
-            } else {
-                _rect.x = tile_rect->x + tile_rect->w;
-            }
-            _pos.x = _rect.x;
-            _vel.x *= -1.2;
-            _vel.y *= 1.2;
+            continue;
         }
+        resume(i);
     }
+    // signalled since the last update, entities that died in between are gone from the index
+    for (const uint32_t id : _Woken)
+    {
+        const std::size_t i{getIndex(id)};
+        if (i != NO_ENTITY)
+        {
+            resume(i);
+        }
+    }
+    _Woken.clear();
+}
 
-    _pos.y += frame_movement.y * time_step * _speed;
-    _rect.x = _pos.x;
-    _rect.y = _pos.y;
-
-    world.getTilesAroundPos(_pos, rects);
-    for (int i{0}; i < 9; ++i)
+void EntityManager::updateAnims()
+{
+    const EntityClips& clips{_recipe->clips};
+    // types with a run clip switch between their clips, the rest just loop their idle one. Ones with a
+    // landing clip play it through after a fall
+    if (clips[CLIP_RUN].texture != nullptr)
     {
-        SDL_Rect* tile_rect {&(rects[i])};
-        if (Util::checkCollision(&_rect, tile_rect))
+        const bool lands{clips[CLIP_LAND].texture != nullptr};
+        for (std::size_t i{0}; i < _Store.size(); ++i)
         {
-            if (frame_movement.y > 0)
+            if (_Store.step[i] <= 0.0)
             {
-                _rect.y = tile_rect->y - _rect.h;
-                _falling = 0.0;
+                continue;
+            }
+            if (_Store.falling[i] >= 3.0)
+            {
+                setClip(i, CLIP_JUMP);
+                _Store.setFlag(i, FLAG_LANDING, lands);
+            } else if (std::abs(_Store.vel[i].x) > 0.05)
+            {
+                setClip(i, CLIP_RUN);
+            } else if (_Store.hasFlag(i, FLAG_LANDING))
+            {
+                setClip(i, CLIP_LAND);
+                if (clips[CLIP_LAND].anim.isFinished(_Store.frame[i]))
+                {
+                    _Store.setFlag(i, FLAG_LANDING, false);
+                }
             } else {
-                _rect.y = tile_rect->y + tile_rect->h;
+                setClip(i, CLIP_IDLE);
             }
-            _vel.y *= -1;
-            _pos.y = _rect.y;
         }
     }
 
-    world.getDangerAroundPos(_pos, rects);
-    for (int i{0}; i < 9; ++i)
+    if (clips[CLIP_IDLE].texture == nullptr)
     {
-        SDL_Rect* tile_rect{&(rects[i])};
-        if (Util::checkCollision(&_rect, tile_rect))
-        {
-            die(screen_shake);
-            break;
-        }
+        return;
+    }
+    for (std::size_t i{0}; i < _Store.size(); ++i)
+    {
+        _Store.frame[i] += clips[_Store.clip[i]].anim.speed * _Store.step[i];
     }
-    _vel.x = std::min(3.0, std::max(-3.0, _vel.x));
-    _vel.y = std::min(3.0, std::max(-3.0, _vel.y));
-}
-
-void Bat::damage(const double damage, double* screen_shake)
-{
-    Entity::damage(damage, screen_shake);
-    double angle = Util::random() * 2.0 * M_PI;
-    _vel.x += std::cos(angle) * 5.0;
-    _vel.y += std::sin(angle) * 5.0;
 }
 
-void Bat::touchPlayer(Player* player, double* screen_shake, double* slomo, ShockWaveManager& shockwaves)
+void EntityManager::updateTimers()
 {
-    _rect.x = _pos.x;
-    _rect.y = _pos.y;
-    SDL_Rect* player_rect{player->getRect()};
-    if (player->getAttacking())
+    for (std::size_t i{0}; i < _Store.size(); ++i)
     {
-        SDL_Rect playerAttackRect {player->getAttackRect()};
-        if (Util::checkCollision(&_rect, &playerAttackRect) && _recover > _recover_time && player->getRecover() > 10.0)
+        const double time_step{_Store.step[i]};
+        if (time_step <= 0.0)
         {
-            damage(player->getSwordDamage(), screen_shake);
+            continue;
         }
-    } if (Util::checkCollision(player_rect, &_rect) && player->getRecover() > 10.0)
-    {
-        double angle = Util::random() * 2.0 * M_PI;
-        _vel.x += std::cos(angle) * 5.0;
-        _vel.y += std::sin(angle) * 5.0;
-        player->damage(_damage, screen_shake, slomo, shockwaves);
+        _Store.falling[i] += time_step;
     }
 }
 
-void Bat::followPlayer(Player* player, World* world, const double& time_step)
+void EntityManager::updateMotion(World& world)
 {
-    SDL_Rect* player_rect{player->getRect()};
-    vec2<double> player_pos{player->getCenter()};
-    if (Util::distance(player_pos, getCenter()) < 200.0)
+    const double gravity{_recipe->gravity};
+    const double friction{_recipe->friction};
+    const bool flying{_recipe->flying};
+    for (std::size_t i{0}; i < _Store.size(); ++i)
     {
-        _vel.x += std::max(-0.1, std::min(0.1, (player_pos.x - getCenter().x) * 0.005)) * time_step;
-        _vel.y += std::max(-0.1, std::min(0.1, (player_pos.y - getCenter().y) * 0.005)) * time_step;
-        vec2<double> check_pos {getCenter().x + _vel.x * 2.0, getCenter().y + _vel.y * 2.0};
-        Tile* tile {world->getTileAt(check_pos.x, check_pos.y)};
-        if (tile != nullptr)
-        {    
-            if (Util::elementIn<TileType, std::size(DANGER_TILES)>(tile->type, DANGER_TILES))
+        const double time_step{_Store.step[i]};
+        if (time_step <= 0.0)
+        {
+            continue;
+        }
+        vec2<double>& vel{_Store.vel[i]};
+        vel.x *= friction;
+        vel.x = std::min(std::max(vel.x, -ENTITY_TOP_SPEED), ENTITY_TOP_SPEED);
+        vel.y += gravity * time_step;
+
+        // catching up after a reduced tick (or just falling fast) can move further than the tile check covers
+        const double move{std::max(std::abs(vel.x), std::abs(vel.y)) * time_step * (flying ? _Store.speed[i] : 1.0)};
+        const int steps{std::max(1, static_cast<int>(std::ceil(move / MAX_STEP_MOVE)))};
+        for (int s{0}; s < steps; ++s)
+        {
+            if (flying)
             {
-                _vel.x *= -1;
-                _vel.y *= -1;
+                fly(i, time_step / steps, world);
+            } else {
+                walk(i, time_step / steps, world);
             }
         }
-        _vel.x += (_vel.x * 0.95 - _vel.x) * time_step;
-        _vel.y += (_vel.y * 0.95 - _vel.y) * time_step;
-    } else {
-        wander(world, time_step);
+        hitSpikes(i, world);
     }
 }
 
-void Bat::update(const double& time_step, World& world, double* screen_shake)
-{
-    handleAnim(time_step);
-    Entity::update(time_step, world, screen_shake);
-}
-
-void Bat::render(const int scrollX, const int scrollY, SDL_Renderer* renderer)
+void EntityManager::updateFluids(FluidIndex* fluids)
 {
-    _glowTex->setBlendMode(SDL_BLENDMODE_ADD);
-    _glowTex->setAlpha(10);
-    _glowTex->setColor(246, 231, 156);
-    SDL_Rect renderQuad{static_cast<int>(getCenter().x - 6 - _anim_offset.x) - scrollX, static_cast<int>(getCenter().y - 6 - _anim_offset.y - 2) - scrollY, 10, 10};
-    SDL_RenderCopyEx(renderer, _glowTex->getTexture(), NULL, &renderQuad, 0, NULL, SDL_FLIP_NONE);
-    //_glowTex->render(static_cast<int>(getCenter().x - 2.5 - _anim_offset.x) - scrollX, static_cast<int>(getCenter().y - 2.5 - _anim_offset.y - 2) - scrollY, renderer, &clip);
-    if (_recover > _recover_time)
+    if (fluids == nullptr)
     {
-        _anim->render((int)_pos.x - _anim_offset.x, (int)_pos.y - _anim_offset.y, scrollX, scrollY, renderer);
-    } else {
-        _flash->render((int)_pos.x - _anim_offset.x, (int)_pos.y - _anim_offset.y, scrollX, scrollY, renderer);
+        return;
     }
-    Entity::renderHealthBar(scrollX, scrollY, renderer);
-}
-
-
-Turtle::Turtle(vec2<double> pos, vec2<double> vel, double gravity, bool peaceful, std::string name, TexMan* texman)
-    : Entity{pos, vel, 0.4, peaceful, name}
-{
-    loadAnim(texman);
-    _maxHealth = 60.0;
-    _health = 60.0;
-}
-
-Turtle::~Turtle()
-{
-    delete _idleAnim;
-    delete _runAnim;
-    delete _jumpAnim;
-    delete _landAnim;
-    delete _flash;
-}
-
-void Turtle::loadAnim(TexMan* texman)
-{
-    _idleAnim = new Anim{8, 8, 6, 0.2, true, &(texman->turtleIdle)};
-    _runAnim = new Anim{8, 8, 5, 0.2, true, &(texman->turtleRun)};
-    _jumpAnim = new Anim{8, 8, 6, 0.2, false, &(texman->turtleJump)};
-    _landAnim = new Anim{8, 8, 6, 0.3, false, &(texman->turtleLand)};
-    _flash = new Anim{7, 4, 1, 0.2, true, &(texman->turtleFlash)};
-    Entity::loadAnim(texman); // for the health_bar
-    _health_bar->setDimensions({8, 2});
-}
-
-void Turtle::handleAnim(const double& time_step)
-{
-    _anim = _idleAnim;
-    if (_falling >= 3.0)
-    {
-        _anim = _jumpAnim;
-        _runAnim->reset();
-        _idleAnim->reset();
-        _landAnim->reset();
-        _grounded = 99.9;
-    } else if (std::abs(_vel.x) > 0.05)
+    for (std::size_t i{0}; i < _Store.size(); ++i)
     {
-        _anim = _runAnim;
-        _jumpAnim->reset();
-        _idleAnim->reset();
-        _landAnim->reset();
-    } else if (_grounded > 3.0)
-    {
-        _anim = _landAnim;
-        _jumpAnim->reset();
-        _idleAnim->reset();
-        _runAnim->reset();
-        if (_landAnim->getFinished())
+        if (_Store.step[i] > 0.0 && !_Store.hasFlag(i, FLAG_SHOULD_DIE) && fluids->interact(&_Store.rect[i], _Store.vel[i], ENTITY_FLUID, _Store.step[i]) == FluidType::LAVA)
         {
-            _grounded = 0.0;
+            die(i);
         }
-    } else {
-        _anim = _idleAnim;
-        _jumpAnim->reset();
-        _runAnim->reset();
-        _landAnim->reset();
-        _grounded = 0.0;
     }
-    _anim->tick(time_step);
-    _anim->setFlipped(_anim_flipped ? SDL_FLIP_HORIZONTAL : SDL_FLIP_NONE);
-}
-
-void Turtle::damage(const double damage, double* screen_shake)
-{
-    _vel.x *= 0.1;
-    Entity::damage(damage, screen_shake);
 }
 
-void Turtle::touchPlayer(Player* player, double* screen_shake, double* slomo, ShockWaveManager& shockwaves)
+void EntityManager::updateAI(World& world, Player* player, const FlowField* flow)
 {
-    _rect.x = _pos.x;
-    _rect.y = _pos.y;
-    SDL_Rect *player_rect{player->getRect()};
-    if (Util::checkCollision(&_rect, player_rect))
+    if (_recipe->flocks)
     {
-        if (player->getFalling() > 3.0 && player->getVelY() > 0.1)
-        {
-            _grounded = 99.9;
-            player->setVelY(-3.6);
-            _landAnim->setFrame(2); // at the bottom
-            _wandering = false;
-            _wander_timer = 100.0;
-            _jumped_on = true;
-        }
+        const vec2<double> half_size{_recipe->dimensions.x / 2.0, _recipe->dimensions.y / 2.0};
+        _Flock.steer(_Store.pos, _Store.vel, _Store.step, half_size, player->getCenter(), flow);
+        return;
     }
-    if (player->getAttacking())
+    const double wander_speed{_recipe->wander_speed};
+    for (std::size_t i{0}; i < _Store.size(); ++i)
     {
-        SDL_Rect playerAttackRect {player->getAttackRect()};
-        if (Util::checkCollision(&_rect, &playerAttackRect) && _recover > _recover_time)
+        const double time_step{_Store.step[i]};
+        if (time_step <= 0.0)
         {
-            damage(player->getSwordDamage() * 0.5, screen_shake);
+            continue;
+        }
+        if (_recipe->peaceful)
+        {
+            wander(i, world, time_step, wander_speed);
+        } else if (_recipe->flying)
+        {
+            flyToPlayer(i, player, world, flow, time_step);
+        } else {
+            followPlayer(i, player, world, flow, time_step);
         }
     }
 }
 
-void Turtle::wander(World* world, const double& time_step)
+void EntityManager::addBodies(Broadphase& bodies)
 {
+    const uint8_t owner{static_cast<uint8_t>(_type)};
+    for (std::size_t i{0}; i < _Store.size(); ++i)
     {
-        if (_wandering)
-        {
-            vec2<double> checkTilePos{getCenter().x + (_flipped ? -10.0 : 10.0), getCenter().y + 10};
-            Tile *tile{world->getTileAt(checkTilePos.x, checkTilePos.y)};
-            if (tile == nullptr)
-            {
-                _vel.x += (_flipped ? 0.2 : -0.2) * time_step;
-                _flipped = !_flipped;
-            }
-            else if (Util::elementIn<TileType, std::size(DANGER_TILES)>(tile->type, DANGER_TILES))
-            {
-                _vel.x += (_flipped ? 0.2 : -0.2) * time_step;
-                _flipped = !_flipped;
-            }
-            else
-            {
-                checkTilePos = {getCenter().x + (_flipped ? -10.0 : 10.0), getCenter().y};
-                tile = {world->getTileAt(checkTilePos.x, checkTilePos.y)};
-                if (tile != nullptr)
-                {
-                    if (Util::elementIn<TileType, std::size(SOLID_TILES)>(tile->type, SOLID_TILES))
-                    {
-                        _flipped = !_flipped;
-                        
-                    }
-                }
-                _vel.x += _flipped ? -0.04 : 0.04;
-            }
-        }
-        else
+        // sleeping entities can't touch anything this frame
+        if (_Store.step[i] <= 0.0)
         {
-            _vel.x *= 0.8;
+            continue;
         }
-        _anim_flipped = _flipped;
+        updateRect(i);
+        bodies.add(_Store.rect[i], BODY_ENTITY, owner, static_cast<uint32_t>(i));
     }
 }
 
-void Turtle::update(const double& time_step, World& world, double* screen_shake)
+void EntityManager::updateContacts(const Broadphase& bodies, Player* player, double* screen_shake, double* slomo, EventQueue& events)
 {
-    handleAnim(time_step);
-    _vel.x *= 0.9;
-    Entity::update(time_step, world, screen_shake);
-}
-
-void Turtle::render(const int scrollX, const int scrollY, SDL_Renderer* renderer)
-{
-    if (_recover > _recover_time - 1.0)
+    if (_recipe->peaceful && !_recipe->stompable)
     {
-        _anim->render((int)_pos.x - _anim_offset.x, (int)_pos.y - _anim_offset.y, scrollX, scrollY, renderer);
-    } else {
-        _flash->render((int)_pos.x - _anim_offset.x, (int)_pos.y - _anim_offset.y, scrollX, scrollY, renderer);
+        return;
     }
-    Entity::renderHealthBar(scrollX, scrollY, renderer);
-}
-
-EntityManager::EntityManager(vec2<double> pos, const int total, Entity** entities)
-    : _total{total}, _pos{pos}
-{
-    _Entities = new Entity*[MAX_ENTITIES];
-    for (std::size_t i{0}; i < total; ++i)
+    // only entities touching the player or their sword can react, the rest never get looked at
+    const uint8_t owner{static_cast<uint8_t>(_type)};
+    _Pairs.clear();
+    _Contacts.clear();
+    bodies.queryPairs(BODY_PLAYER | BODY_ATTACK, BODY_ENTITY, _Pairs);
+    for (const std::pair<int, int>& pair : _Pairs)
     {
-        _Entities[i] = nullptr;
-        _Entities[i] = entities[i];
-        _name = _Entities[i]->getName();
-        _Entities[i]->setPalette(&_Particles);
+        const Body& body{bodies.getBody(pair.second)};
+        if (body.owner == owner)
+        {
+            _Contacts.push_back(body.index);
+        }
     }
-}
-
-EntityManager::EntityManager(vec2<double> pos, const int total, std::vector<Entity*> entities)
-    : _total{total}, _pos{pos}
-{
-    _Entities = new Entity*[MAX_ENTITIES];
-    for (std::size_t i{0}; i < total; ++i)
+    // touching both gives two pairs, and keep the old index order so hits land the same way
+    std::sort(_Contacts.begin(), _Contacts.end());
+    _Contacts.erase(std::unique(_Contacts.begin(), _Contacts.end()), _Contacts.end());
+    for (const std::size_t i : _Contacts)
     {
-        _Entities[i] = nullptr;
-        _Entities[i] = entities[i];
-        _name = _Entities[i]->getName();
-        _Entities[i]->setPalette(&_Particles);
+        if (_recipe->peaceful)
+        {
+            stomp(i, player, screen_shake);
+        } else {
+            touchPlayer(i, player, screen_shake, slomo, events);
+        }
     }
 }
 
-EntityManager::~EntityManager()
-{
-    free();
-}
-
-void EntityManager::free()
+void EntityManager::updateLife(EventQueue& events)
 {
-    for (std::size_t i{0}; i < _total; ++i)
+    std::size_t i{0};
+    while (i < _Store.size())
     {
-        if (_Entities[i] != nullptr)
+        if (_Store.hasFlag(i, FLAG_JUMPED_ON))
         {
-            delete _Entities[i];
-            _Entities[i] = nullptr;
+            events.post(GameEventType::ENTITY_STOMPED, getCenter(i), _type);
+            _Store.setFlag(i, FLAG_JUMPED_ON, false);
         }
+        // some black magic
+        if (_Store.hasFlag(i, FLAG_SHOULD_DIE))
+        {
+            events.post(GameEventType::ENTITY_DIED, getCenter(i), _type);
+            remove(i); // last entity takes its place, so don't move on
+            continue;
+        } else if (_Store.hasFlag(i, FLAG_SHOULD_DAMAGE))
+        {
+            events.post(GameEventType::ENTITY_HURT, getCenter(i), _type);
+            _Store.setFlag(i, FLAG_SHOULD_DAMAGE, false);
+        }
+        ++i;
     }
-    _total = 0;
-    delete[] _Entities;
-    _Entities = nullptr;
 }
 
-std::string_view EntityManager::getName()
+void EntityManager::update(const double& time_step, World& world, double* screen_shake, Player* player, double* slomo, EventQueue& events, FluidIndex* fluids, const FlowField* flow, const SDL_Rect& view, Broadphase& bodies)
 {
-    return _name;
+    if (_Store.empty())
+    {
+        _TierCounts.fill(0);
+        return;
+    }
+    updateTiers(time_step, view, player);
+    updateBehaviours(time_step);
+    updateAnims();
+    updateTimers();
+    updateMotion(world);
+    updateFluids(fluids);
+    updateAI(world, player, flow);
+    addBodies(bodies);
+    updateContacts(bodies, player, screen_shake, slomo, events);
+    updateLife(events);
 }
 
-Entity* EntityManager::getEntity(std::size_t idx) {return _Entities[idx];}
-
-int EntityManager::getTotal() {return _total;}
-
-void EntityManager::addEntity(Entity* entity)
+void EntityManager::render(const int scrollX, const int scrollY, const int width, const int height, SpriteBatch& batch)
 {
-    _Entities[_total] = entity;
-    ++_total;
-}
+    const EntityClips& clips{_recipe->clips};
+    const vec2<int> offset{_recipe->anim_offset};
+    const SDL_Rect view{scrollX - ENTITY_CULL_MARGIN, scrollY - ENTITY_CULL_MARGIN, width + ENTITY_CULL_MARGIN * 2, height + ENTITY_CULL_MARGIN * 2};
 
-void EntityManager::update(const double& time_step, World& world, double* screen_shake, Player* player, double* slomo, TexMan* texman, CoinManager* coinmanager, ShockWaveManager& shockwaves)
-{
-    const int num{_total};
-    for (std::size_t i{0}; i < num; ++i)
+    if (_recipe->flying)
     {
-        if (i < _total)
+        Texture* glowTex{&(_texman->lightTex)};
+        glowTex->setBlendMode(SDL_BLENDMODE_ADD);
+        glowTex->setAlpha(10);
+        glowTex->setColor(246, 231, 156);
+        for (std::size_t i{0}; i < _Store.size(); ++i)
         {
-            Entity* entity {_Entities[i]};
-            entity->update(time_step, world, screen_shake);
-            if (!(entity->getPeaceful()))
+            if (!Util::checkCollision(&_Store.rect[i], &view))
             {
-                entity->followPlayer(player, &world, time_step);
-                entity->touchPlayer(player, screen_shake, slomo, shockwaves);
-            } else {
-                entity->wander(&world, time_step);
-                if (entity->getName() == "turtle")
-                {
-                    entity->touchPlayer(player, screen_shake, slomo, shockwaves);
-                    if (static_cast<Turtle*>(entity)->getJumpedOn())
-                    {
-                        texman->SFX_turtle.play();
-                        static_cast<Turtle*>(entity)->setJumpedOn(false);
-                    }
-                }
-            }
-            // some black magic
-            if (entity->getShouldDie())
-            {
-                texman->SFX_death_0.play();
-                if (entity->getName() == "turtle")
-                {
-                    _Particles.setPos(entity->getCenter());
-                    _Smoke.setPos(entity->getCenter());
-                    _Fire.setPos(entity->getCenter());
-                    _Particles.setSpawning(32, {8.0, 8.0}, SDL_Color{0x00, 0x00, 0x00});
-                    _Smoke.setSpawning(20, {1, 2}, {0x88, 0x88, 0x88});
-                    _Fire.setSpawning(20);
-                    int num{(std::rand() % 10) + 15};
-                    for (int i{0}; i < num; ++i)
-                    {
-                        _SparkManager.addSpark(new Spark{entity->getCenter(), Util::random() * M_PI * 2.0, Util::random() * 3.0 + 2.0});
-                    }
-                } else if (entity->getName() == "slime")
-                {
-                    _Particles.setPos(entity->getCenter());
-                    _Smoke.setPos(entity->getCenter());
-                    _Fire.setPos(entity->getCenter());
-                    _Particles.setSpawning(32, {8.0, 8.0}, SDL_Color{0x00, 0x00, 0x00});
-                    _Smoke.setSpawning(20, {1, 2}, {0x88, 0x88, 0x88});
-                    _Fire.setSpawning(20);
-                    int num{(std::rand() % 10) + 15};
-                    for (int i{0}; i < num; ++i)
-                    {
-                        _SparkManager.addSpark(new Spark{entity->getCenter(), Util::random() * M_PI * 2.0, Util::random() * 3.0 + 2.0});
-                    }
-                } else if (entity->getName() == "bat")
-                {
-                    _Particles.setPos(entity->getCenter());
-                    _Smoke.setPos(entity->getCenter());
-                    _Fire.setPos(entity->getCenter());
-                    _Particles.setSpawning(16, {8.0, 4.0}, SDL_Color{0x00, 0x00, 0x00});
-                    _Smoke.setSpawning(5, {1, 2}, {0x88, 0x88, 0x88});
-                    _Fire.setSpawning(10);
-                    int num{(std::rand() % 10) + 15};
-                    for (int i{0}; i < num; ++i)
-                    {
-                        _SparkManager.addSpark(new Spark{entity->getCenter(), Util::random() * M_PI * 2.0, Util::random() * 2.0 + 1.0});
-                    }
-                }
-                int num{(std::rand() % 10) + 5};
-                for (int i{0}; i < num; ++i)
-                {
-                    coinmanager->addCoin(entity->getCenter(), {Util::random() * 2.0 - 1.0, Util::random() * -2.0});
-                }
-                shockwaves.addShockWave(entity->getCenter());
-                Util::swap(&_Entities[i], &_Entities[_total - 1]); // swap dead entity with last entity in the array
-                delete _Entities[_total - 1]; // deallocate dead entity
-                _Entities[_total - 1] = nullptr;
-                --_total; // deincrement total to avoid undefined behaviour when we reference nullptr
-            } else if (entity->getShouldDamage())
-            {
-                texman->playDamageSound();
-                entity->setShouldDamage(false);
-                if (entity->getName() == "turtle")
-                {
-                    int num{(std::rand() % 5) + 10};
-                    for (int i{0}; i < num; ++i)
-                    {
-                        _SparkManager.addSpark(new Spark{entity->getCenter(), Util::random() * M_PI * 2.0, Util::random() * 2.0 + 0.5});
-                    }
-                    texman->SFX_turtle.play();
-                    _Particles.setPos(entity->getCenter());
-                    _Particles.setSpawning(16, {8.0, 8.0}, SDL_Color{0x00, 0x00, 0x00});
-                }
-                if (entity->getName() == "slime")
-                {
-                    int num{(std::rand() % 5) + 10};
-                    for (int i{0}; i < num; ++i)
-                    {
-                        _SparkManager.addSpark(new Spark{entity->getCenter(), Util::random() * M_PI * 2.0, Util::random() * 3.0 + 1.0});
-                    }
-                    _Particles.setPos(entity->getCenter());
-                    _Particles.setSpawning(16, {3.0, 10.0}, SDL_Color{0x00, 0x00, 0x00});
-                }
-                if (entity->getName() == "bat")
-                {
-                    int num{(std::rand() % 5) + 6};
-                    for (int i{0}; i < num; ++i)
-                    {
-                        _SparkManager.addSpark(new Spark{entity->getCenter(), Util::random() * M_PI * 2.0, Util::random() * 2.0 + 0.5});
-                    }
-                    _Particles.setPos(entity->getCenter());
-                    _Particles.setSpawning(8, {4.0, 4.0}, SDL_Color{0x00, 0x00, 0x00});
-                }
+                continue;
             }
+            const vec2<double> center{getCenter(i)};
+            const SDL_Rect renderQuad{static_cast<int>(center.x - 6 - offset.x) - scrollX, static_cast<int>(center.y - 6 - offset.y - 2) - scrollY, 10, 10};
+            batch.draw(*glowTex, SpriteLayer::ENTITY_GLOW, renderQuad);
         }
     }
-    //std::cout << _total << '\n';
-}
 
-void EntityManager::render(const int scrollX, const int scrollY, SDL_Renderer* renderer)
-{
-    const int num{_total};
-    for (std::size_t i{0}; i < num; ++i)
+    for (std::size_t i{0}; i < _Store.size(); ++i)
     {
-        if (i < _total)
+        if (!Util::checkCollision(&_Store.rect[i], &view))
+        {
+            continue;
+        }
+        const vec2<double>& pos{_Store.pos[i]};
+        const bool flashing{getRecover(i) < _recipe->flash_time};
+        if (clips[CLIP_IDLE].texture == nullptr)
+        {
+            // no sprites, just a box
+            const SDL_Rect renderRect{static_cast<int>(pos.x) - scrollX, static_cast<int>(pos.y) - scrollY, _recipe->dimensions.x, _recipe->dimensions.y};
+            batch.fillRect(SpriteLayer::ENTITIES, renderRect, flashing ? SDL_Color{0xFF, 0xFF, 0xFF, 0xFF} : SDL_Color{0xFF, 0x00, 0x00, 0xFF});
+        } else {
+            // the flash clip is a single frame, and never flipped. Neither is the bat
+            const ClipDef& clip{clips[flashing ? static_cast<uint8_t>(CLIP_FLASH) : _Store.clip[i]]};
+            const AnimDef& anim{clip.anim};
+            const int step{anim.getStep(flashing ? 0.0 : _Store.frame[i])};
+            const bool flip{!flashing && !_recipe->flying && _Store.hasFlag(i, FLAG_ANIM_FLIPPED)};
+            SDL_Rect clip_rect{step * anim.width, 0, anim.width, anim.height};
+            SDL_Point center{anim.width / 2, anim.height / 2};
+            batch.draw(_texman->*clip.texture, SpriteLayer::ENTITIES, (int)pos.x - offset.x - scrollX, (int)pos.y - offset.y - scrollY, &clip_rect, 0.0, &center, flip ? SDL_FLIP_HORIZONTAL : SDL_FLIP_NONE);
+        }
+        if (_Store.health[i] < _recipe->max_health)
         {
-            Entity* entity {_Entities[i]};
-            entity->render(scrollX, scrollY, renderer);
+            _HealthBar.render(scrollX, scrollY, batch, pos, _Store.health[i]);
         }
     }
 }
@@ -915,101 +918,80 @@ void EMManager::free()
     _Managers.clear();
 }
 
+EntityManager* EMManager::getManager(const EntityType type)
+{
+    for (EntityManager* manager : _Managers)
+    {
+        if (manager->getType() == type)
+        {
+            return manager;
+        }
+    }
+    // we didn't find anything
+    _Managers.push_back(new EntityManager{type, _texman});
+    return _Managers.back();
+}
+
 void EMManager::loadFromPath(std::string path, TexMan* texman)
 {
     std::ifstream f{path};
     json data = json::parse(f);
+    f.close();
+
+    free();
+    _texman = texman;
 
-    std::vector<std::vector<Entity*>> entities;
+    // one manager per type, in the order they first show up in the map
     for (const auto& e : data["level"]["entities"])
     {
-        std::string entity_name {e["type"]};
-        bool found_entity{false};
-        for (auto& entity_vec : entities)
-        {
-            if (!found_entity)
-            {
-                for (Entity* entity : entity_vec)
-                {
-                    if (entity->getName() == entity_name)
-                    {
-                        found_entity = true;
-                        if (entity_name == "slime")
-                        {
-                            entity_vec.push_back(new Slime{vec2<double>{(double)e["pos"][0], (double)e["pos"][1]}, vec2<double> {0, 0}, 0.2, false, entity_name, texman});
-                        } else if (entity_name == "bat")
-                        {
-                            entity_vec.push_back(new Bat{vec2<double>{(double)e["pos"][0], (double)e["pos"][1]}, vec2<double> {0, 0}, 0.2, false, entity_name, texman});
-                        } else if (entity_name == "turtle")
-                        {
-                            entity_vec.push_back(new Turtle{vec2<double>{(double)e["pos"][0], (double)e["pos"][1]}, vec2<double> {0, 0}, 0.2, true, entity_name, texman});
-                        } else {
-                            entity_vec.push_back(new Entity{vec2<double>{(double)e["pos"][0], (double)e["pos"][1]}, vec2<double> {0, 0}, 0.2, false, "default"});
-                        }
-                        break;
-                    }
-                }
-            }
-        }
-        if (!found_entity)
-        {
-            if (entity_name == "slime")
-            {
-                entities.push_back(std::vector<Entity*>{new Slime{vec2<double>{(double)e["pos"][0], (double)e["pos"][1]}, vec2<double> {0, 0}, 0.2, false, entity_name, texman}});
-            } else if (entity_name == "bat")
-            {
-                entities.push_back(std::vector<Entity*>{new Bat{vec2<double>{(double)e["pos"][0], (double)e["pos"][1]}, vec2<double> {0, 0}, 0.2, false, entity_name, texman}});
-            } else if (entity_name == "turtle")
-            {
-                entities.push_back(std::vector<Entity*>{new Turtle{vec2<double>{(double)e["pos"][0], (double)e["pos"][1]}, vec2<double> {0, 0}, 0.2, true, entity_name, texman}});
-            } else {
-                entities.push_back(std::vector<Entity*>{new Entity{vec2<double>{(double)e["pos"][0], (double)e["pos"][1]}, vec2<double> {0, 0}, 0.2, false, "default"}});
-            }
-        }
+        addEntity(getEntityType(e["type"].get<std::string_view>()), vec2<double>{(double)e["pos"][0], (double)e["pos"][1]});
     }
-    
-    for (EntityManager* manager : _Managers)
+}
+
+void EMManager::addEntity(const EntityType type, vec2<double> pos)
+{
+    getManager(type)->addEntity(pos, vec2<double>{0, 0});
+}
+
+int EMManager::getTotal() const
+{
+    int total{0};
+    for (const EntityManager* manager : _Managers)
     {
-        manager->free();
-        delete manager;
+        total += manager->getTotal();
     }
-    _Managers.clear();
+    return total;
+}
 
-    for (auto& entity_vec : entities)
+int EMManager::getTierCount(const ActivityTier tier) const
+{
+    int total{0};
+    for (const EntityManager* manager : _Managers)
     {
-        _Managers.push_back(new EntityManager{vec2<double>{0, 0}, static_cast<int>(entity_vec.size()), entity_vec});
+        total += manager->getTierCount(tier);
     }
-
-    f.close();
+    return total;
 }
 
-void EMManager::addEntity(Entity* entity)
+void EMManager::update(const double& time_step, World& world, double* screen_shake, Player* player, double* slomo, EventQueue& events, FluidIndex* fluids, const FlowField* flow, const SDL_Rect& view, Broadphase& bodies)
 {
     for (std::size_t i{0}; i < _Managers.size(); ++i)
     {
-        if (_Managers[i]->getName() == entity->getName())
-        {
-            _Managers[i]->addEntity(entity);
-            return; // break;
-        }
+        _Managers[i]->update(time_step, world, screen_shake, player, slomo, events, fluids, flow, view, bodies);
     }
-    // we didn't find anything
-    _Managers.push_back(new EntityManager{vec2<double>{0, 0}, 1, std::vector<Entity*>{entity}});
 }
-
-void EMManager::update(const double& time_step, World& world, double* screen_shake, Player* player, double* slomo, TexMan* texman, CoinManager* coinmanager, ShockWaveManager& shockwaves)
+void EMManager::render(const int scrollX, const int scrollY, const int width, const int height, SpriteBatch& batch)
 {
     for (std::size_t i{0}; i < _Managers.size(); ++i)
     {
-        _Managers[i]->update(time_step, world, screen_shake, player, slomo, texman, coinmanager, shockwaves);
+        _Managers[i]->render(scrollX, scrollY, width, height, batch);
     }
 }
-// updateParticles(const double& time_step, const int scrollX, const int scrollY, SDL_Renderer* renderer, World* world, TexMan* texman)
-void EMManager::render(const int scrollX, const int scrollY, SDL_Renderer* renderer, const double& time_step, World* world, TexMan* texman)
+
+void EMManager::updateParticles(const double& time_step, const int scrollX, const int scrollY, SDL_Renderer* renderer, World* world, TexMan* texman)
 {
     for (std::size_t i{0}; i < _Managers.size(); ++i)
     {
-        _Managers[i]->render(scrollX, scrollY, renderer);
         _Managers[i]->updateParticles(time_step, scrollX, scrollY, renderer, world, texman);
     }
 }
@@ -6,253 +6,107 @@
 
 #include <string>
 #include <fstream>
+#include <vector>
+#include <array>
+#include <cstdint>
 
 #include "./util.hpp"
 #include "./vec2.hpp"
 #include "./tiles.hpp"
 #include "./player.hpp"
-#include "./anim.hpp"
 #include "./health_bars.hpp"
+#include "./spritebatch.hpp"
 #include "./sparks.hpp"
-#include "./coin.hpp"
-
-class Entity
-{
-protected:
-    static inline int sId{0};
-    vec2<double> _pos;
-    vec2<double> _vel;
-    vec2<int> _dimensions {8, 8};
-    double _gravity;
-    bool _peaceful;
-    std::string _name;
-
-    vec2<int> _anim_offset{0, 0};
-
-    EntityHealthBar* _health_bar {nullptr};
-
-    double _falling{99.0};
-    double _top_speed{1.0};
-
-    SDL_Rect _rect{0, 0, 0, 0};
-    bool _should_die {false};
-    bool _should_damage{false};
-
-    double _maxHealth{10.0};
-    double _health{10.0};
-    double _damage{5.0};
-    double _recover{100.0};
-    double _recover_time{10.0};
-
-    bool _flipped{false}; // flipping for moving direction
-    bool _wandering{false}; // if it is moving while it is wandering
-    double _wander_timer{static_cast<double>(std::rand() % 180)};
-    bool _anim_flipped{false}; // flipped for animation
-
-    int _id{0};
-    // palette length must be 8 (don't ask)
-    const SDL_Color _Palette[8] {{0xa8, 0x60, 0x5d}, {0xd1, 0xa6, 0x7e}, {0xf6, 0xe7, 0x9c}, {0xb6, 0xcf, 0x8e}, {0x60, 0xae, 0x7b}, {0x3c, 0x6b, 0x64}, {0x1f, 0x24, 0x4b}, {0x65, 0x40, 0x53}};
-
-public:
-    Entity(vec2<double> pos, vec2<double> vel, double gravity, bool peaceful, std::string name);
-    virtual ~Entity()
-    {
-        if (_health_bar != nullptr)
-        {
-            delete _health_bar;
-        }
-    }
-
-    virtual void loadAnim(TexMan* texman)
-    {
-        _health_bar = new EntityHealthBar{&(texman->enemyHealthBar), {12, 2}, getMaxHealth()};
-        _health_bar->setDimensions({_dimensions.x, 2});
-    }
-
-    int getId();
-    virtual double getHealth() {return _health;}
-    virtual double getMaxHealth() {return _maxHealth;}
-    virtual void setHealth(double val) {_health = val;} 
-    const vec2<int> getAnimOffset() const {return _anim_offset;}
-
-    vec2<double>& getPos();
-    vec2<double> getCenter();
-    void updateRect();
-    SDL_Rect* getRect();
-    bool getShouldDie();
-    bool getShouldDamage() {return _should_damage;}
-    void setShouldDamage(bool val) {_should_damage = val;}
-    bool getFlipped();
-    bool getPeaceful();
-    std::string_view getName();
-
-    virtual void setPalette(ParticleSpawner* particles)
-    {
-        particles->setPalette<8>(_Palette);
-    }
-
-    virtual void damage(const double damage, double* screen_shake);
-    virtual void die(double* screen_shake);
-
-    virtual void update(const double& time_step, World& world, double* screen_shake);
-
-    virtual void updateVel(const double& time_step);
-
-    virtual void handlePhysics(const double& time_step, vec2<double> frame_movement, World& world, double* screen_shake);
-
-    virtual void render(const int scrollX, const int scrollY, SDL_Renderer* renderer);
-
-    virtual void touchPlayer(Player* player, double* screen_shake, double* slomo, ShockWaveManager& shockwaves);
-
-    virtual void followPlayer(Player* player, World* world, const double& time_step);
-
-    virtual void wander(World* world, const double& time_step);
-
-    void updateHealthBar();
-    void renderHealthBar(const int scrollX, const int scrollY, SDL_Renderer* renderer);
-};
-
-class Slime : public Entity
+#include "./fluids.hpp"
+#include "./flowfield.hpp"
+#include "./flock.hpp"
+#include "./broadphase.hpp"
+#include "./events.hpp"
+#include "./behaviour.hpp"
+#include "./entity_types.hpp"
+
+// per entity state bits, packed into one byte
+enum EntityFlag : uint8_t
 {
-protected:
-    Anim* _idleAnim;
-    Anim* _runAnim;
-    Anim* _jumpAnim;
-    Anim* _flash;
-
-    Anim* _anim {nullptr};
-
-    vec2<int> _dimensions{11, 7};
-    vec2<int> _anim_offset{1, 1};
-
-    double _maxHealth{40.0};
-    double _health{40.0};
-    double _damage{10.0};
-
-    const SDL_Color _Palette[8] {{0x3c, 0x6b, 0x64}, {0xf6, 0xe7, 0x9c}, {0x60, 0xae, 0x7b}, {0x1f, 0x24, 0x4b}, {0x3c, 0x6b, 0x64}, {0xf6, 0xe7, 0x9c}, {0x60, 0xae, 0x7b}, {0x1f, 0x24, 0x4b}};
-
-public:
-    Slime(vec2<double> pos, vec2<double> vel, double gravity, bool peaceful, std::string name, TexMan* texman);
-
-    virtual ~Slime();
-
-    virtual double getHealth() {return _health;}
-    virtual double getMaxHealth() {return _maxHealth;}
-    virtual void setHealth(double val) {_health = val;}
-
-    void loadAnim(TexMan* texman);
-
-    void handleAnim(const double& time_step);
-
-    virtual void update(const double& time_step, World& world, double* screen_shake);
-
-    virtual void render(const int scrollX, const int scrollY, SDL_Renderer* renderer);
+    FLAG_FLIPPED = 1 << 0, // for moving direction
+    FLAG_WANDERING = 1 << 1, // if it is moving while it is wandering
+    FLAG_ANIM_FLIPPED = 1 << 2, // flipped for animation
+    FLAG_SHOULD_DIE = 1 << 3,
+    FLAG_SHOULD_DAMAGE = 1 << 4,
+    FLAG_JUMPED_ON = 1 << 5,
+    FLAG_LANDING = 1 << 6 // turtles, playing the landing anim
 };
 
-class Bat : public Entity
+// how much simulation an entity gets, from how far it is from the view and the player
+enum class ActivityTier : uint8_t
 {
-private:
-    Anim* _anim;
-    Anim* _flash;
-    Texture* _glowTex;
-    vec2<int> _dimensions{3, 4};
-    vec2<int> _anim_offset{2, 0};
-
-    double _maxHealth{20.0};
-    double _health{20.0};
-    double _damage{3.0};
-
-    double _angle{0.0};
-    double _speed{Util::random() * 1.0 + 0.25};
-
-    const SDL_Color _Palette[8] {{0xa8, 0x60, 0x5d}, {0x65, 0x40, 0x53}, {0x1f, 0x24, 0x4b}, {0xa8, 0x60, 0x5d}, {0x65, 0x40, 0x53}, {0x1f, 0x24, 0x4b}, {0xa8, 0x60, 0x5d}, {0x65, 0x40, 0x53}};
-
-public:
-    Bat(vec2<double> pos, vec2<double> vel, double gravity, bool peaceful, std::string name, TexMan* texman);
-
-    virtual ~Bat();
-
-    virtual double getHealth() {return _health;}
-    virtual double getMaxHealth() {return _maxHealth;}
-    virtual void setHealth(double val) {_health = val;}
-
-    void loadAnim(TexMan* texman);
-
-    void handleAnim(const double& time_step);
-
-    virtual void damage(const double damage, double* screen_shake);
-
-    virtual void handlePhysics(const double& time_step, vec2<double> frame_movement, World& world, double* screen_shake);
-
-    virtual void touchPlayer(Player* player, double* screen_shake, double* slomo, ShockWaveManager& shockwaves);
-
-    virtual void followPlayer(Player* player, World* world, const double& time_step);
-
-    virtual void update(const double& time_step, World& world, double* screen_shake);
-
-    virtual void render(const int scrollX, const int scrollY, SDL_Renderer* renderer);
+    ACTIVE, // every frame
+    REDUCED, // every few frames, catching up on the time it missed
+    FROZEN, // not at all
+    TOTAL
 };
 
-class Turtle : public Entity
+inline constexpr std::size_t ACTIVITY_TIERS{static_cast<std::size_t>(ActivityTier::TOTAL)};
+inline constexpr int ACTIVE_MARGIN{TILE_SIZE * 4}; // px around the view
+inline constexpr double ACTIVE_PLAYER_RANGE{200.0}; // furthest anything chases the player from (bats)
+inline constexpr int REDUCED_MARGIN{CHUNK_SIZE * TILE_SIZE * 2}; // px around the view
+inline constexpr uint32_t REDUCED_INTERVAL{4}; // frames between ticks
+inline constexpr double MAX_STEP_MOVE{TILE_SIZE / 2.0}; // px, longer moves get split up so nothing goes through the floor
+inline constexpr int ENTITY_CULL_MARGIN{16}; // px, covers sprites, glow & health bars
+inline constexpr double ENTITY_NEVER_HURT{-1000.0}; // hurt_time for new entities, long enough ago to have recovered
+inline constexpr uint32_t NO_ENTITY{UINT32_MAX};
+
+// every entity of one type, as parallel arrays. Entity i is element i of each one,
+// so a system only pulls in the components it actually touches
+struct EntityStore
 {
-private:
-    Anim* _idleAnim;
-    Anim* _runAnim;
-    Anim* _jumpAnim;
-    Anim* _landAnim;
-    Anim* _flash;
-    Anim* _anim;
-
-    vec2<int> _dimensions{8, 8};
-    vec2<int> _anim_offset{0, 0};
-
-    double _maxHealth{60.0};
-    double _health{60.0};
-    double _damage{4.0};
-
-    double _grounded{0.0};
-    bool _jumped_on{false};
-
-public:
-    Turtle(vec2<double> pos, vec2<double> vel, double gravity, bool peaceful, std::string name, TexMan* texman);
-
-    virtual ~Turtle();
-
-    virtual double getHealth() {return _health;}
-    virtual double getMaxHealth() {return _maxHealth;}
-    virtual void setHealth(double val) {_health = val;}
-
-    virtual bool getJumpedOn() {return _jumped_on;}
-    virtual void setJumpedOn(bool val) {_jumped_on = val;}
-
-    void loadAnim(TexMan* texman);
-
-    void handleAnim(const double& time_step);
-
-    void setGrounded(const double grounded)
+    std::vector<vec2<double>> pos{};
+    std::vector<vec2<double>> vel{};
+    std::vector<SDL_Rect> rect{};
+    std::vector<double> health{};
+    std::vector<double> hurt_time{}; // game time it was last hit
+    std::vector<double> falling{};
+    std::vector<double> speed{}; // bats, movement multiplier
+    std::vector<uint8_t> clip{}; // EntityClip
+    std::vector<double> frame{};
+    std::vector<uint8_t> flags{};
+    std::vector<uint32_t> id{}; // stable, staggers the reduced ticks
+    std::vector<uint8_t> tier{}; // ActivityTier
+    std::vector<double> step{}; // time to simulate this frame, 0 if it's sleeping
+    std::vector<double> idle{}; // time missed since its last reduced tick
+    std::vector<Behaviour> behaviour{}; // can be empty, flocks don't have one
+
+    std::size_t size() const {return pos.size();}
+    bool empty() const {return pos.empty();}
+
+    void reserve(const std::size_t num);
+    void clear();
+    // returns the index of the new entity
+    std::size_t add(const vec2<double> pos, const vec2<double> vel, const vec2<int> dimensions, const double health, const uint32_t id);
+    // swaps the last entity into i, so indices past i aren't stable
+    void remove(const std::size_t i);
+
+    bool hasFlag(const std::size_t i, const uint8_t flag) const {return flags[i] & flag;}
+    void setFlag(const std::size_t i, const uint8_t flag, const bool val)
     {
-        _grounded = grounded;
+        flags[i] = val ? (flags[i] | flag) : (flags[i] & ~flag);
     }
-
-    virtual void damage(const double damage, double* screen_shake);
-
-    virtual void touchPlayer(Player* player, double* screen_shake, double* slomo, ShockWaveManager& shockwaves);
-
-    virtual void wander(World* world, const double& time_step);
-
-    virtual void update(const double& time_step, World& world, double* screen_shake);
-
-    virtual void render(const int scrollX, const int scrollY, SDL_Renderer* renderer);
 };
 
+// all the entities of one type, and the systems that update them
 class EntityManager
 {
 private:
-    int _total;
-    Entity** _Entities;
+    EntityType _type{EntityType::DEFAULT};
+    const EntityRecipe* _recipe;
+    EntityStore _Store{};
+    uint32_t _next_id{0};
+    uint32_t _tick{0}; // frames updated, only advances in update() so replays line up
+    std::vector<uint32_t> _Index{}; // id -> index in the store, NO_ENTITY once it's gone
+    std::array<int, ACTIVITY_TIERS> _TierCounts{};
 
-    vec2<double> _pos;
-    std::string _name;
+    TexMan* _texman;
+    EntityHealthBar _HealthBar;
 
     ParticleSpawner _Particles{10000, 0, {50.0, 50.0}, {1.0, 1.0}, 0.125, 0.01, true};
     SmokeSpawner _Smoke{10000, 0, {100.0, 100.0}, 0.15, true};
@@ -260,28 +114,91 @@ private:
 
     SparkManager _SparkManager{0.0, 0.2, 1.0, nullptr};
 
-public:
-    EntityManager(vec2<double> pos, const int total, Entity** entities);
+    Flock _Flock{}; // only used if the recipe flocks
+
+    // behaviours sleep on the wheel, or until a signal puts them in _Woken
+    TimerWheel _Wheel{};
+    std::vector<TimerEntry> _Due{};
+    std::vector<uint32_t> _Woken{};
+
+    // contact scratch, kept around so it doesn't allocate every frame
+    std::vector<std::pair<int, int>> _Pairs{};
+    std::vector<std::size_t> _Contacts{};
+
+    vec2<double> getCenter(const std::size_t i) const;
+    std::size_t getIndex(const uint32_t id) const {return id < _Index.size() ? _Index[id] : NO_ENTITY;}
+    // time since it was last hit
+    double getRecover(const std::size_t i) const {return _Wheel.getTime() - _Store.hurt_time[i];}
+    void updateRect(const std::size_t i);
+
+    void damage(const std::size_t i, const double amount, double* screen_shake);
+    void die(const std::size_t i);
+
+    // behaviours, called from the systems below for a single entity
+    void walk(const std::size_t i, const double& time_step, World& world);
+    void fly(const std::size_t i, const double& time_step, World& world);
+    void hitSpikes(const std::size_t i, World& world);
+    void followPlayer(const std::size_t i, Player* player, World& world, const FlowField* flow, const double& time_step);
+    void flyToPlayer(const std::size_t i, Player* player, World& world, const FlowField* flow, const double& time_step);
+    void wander(const std::size_t i, World& world, const double& time_step, const double speed);
+    void touchPlayer(const std::size_t i, Player* player, double* screen_shake, double* slomo, EventQueue& events);
+    void stomp(const std::size_t i, Player* player, double* screen_shake);
+    void setClip(const std::size_t i, const EntityClip clip);
+
+    // coroutines, one per entity
+    Behaviour roam(const uint32_t id);
+    void resume(const std::size_t i);
+    // wakes the entity's behaviour if it's waiting for any of signals
+    void signal(const std::size_t i, const uint8_t signals);
+    void remove(const std::size_t i);
+
+    // systems, each one runs over every entity in the store before the next one starts
+    // everything after updateTiers skips entities with no step this frame
+    void updateTiers(const double& time_step, const SDL_Rect& view, Player* player);
+    void updateBehaviours(const double& time_step);
+    void updateAnims();
+    void updateTimers();
+    void updateMotion(World& world);
+    void updateFluids(FluidIndex* fluids);
+    void updateAI(World& world, Player* player, const FlowField* flow);
+    void addBodies(Broadphase& bodies);
+    void updateContacts(const Broadphase& bodies, Player* player, double* screen_shake, double* slomo, EventQueue& events);
+    void updateLife(EventQueue& events);
 
-    EntityManager(vec2<double> pos, const int total, std::vector<Entity*> entities);
+public:
+    EntityManager(const EntityType type, TexMan* texman);
 
     ~EntityManager();
 
     void free();
 
-    std::string_view getName();
+    EntityType getType() const {return _type;}
+
+    int getTotal() const {return static_cast<int>(_Store.size());}
+
+    const EntityStore& getStore() const {return _Store;}
 
-    Entity* getEntity(std::size_t idx);
+    // entities in each tier as of the last update
+    int getTierCount(const ActivityTier tier) const {return _TierCounts[static_cast<std::size_t>(tier)];}
 
-    int getTotal();
+    // timers on the wheel, one for each behaviour that's asleep (plus any stale ones from early wakes)
+    std::size_t getSleeping() const {return _Wheel.size();}
 
-    virtual void addEntity(Entity* entity);
+    void reserve(const std::size_t num) {_Store.reserve(num);}
 
-    virtual void update(const double& time_step, World& world, double* screen_shake, Player* player, double* slomo, TexMan* texman, CoinManager* coinmanager, ShockWaveManager& shockwaves);
+    void addEntity(const vec2<double> pos, const vec2<double> vel);
 
-    virtual void updateParticles(const double& time_step, const int scrollX, const int scrollY, SDL_Renderer* renderer, World* world, TexMan* texman);
+    // particles, smoke, fire & sparks from a recipe, at pos
+    void playBurst(const EffectBurst& burst, const vec2<double> pos);
 
-    virtual void render(const int scrollX, const int scrollY, SDL_Renderer* renderer);
+    // view is the camera rect in world px, it decides the activity tiers.
+    // entities that moved get added to bodies, which should already hold the player.
+    // hurt & dead entities post to events, the effects are played from there
+    void update(const double& time_step, World& world, double* screen_shake, Player* player, double* slomo, EventQueue& events, FluidIndex* fluids, const FlowField* flow, const SDL_Rect& view, Broadphase& bodies);
+
+    void updateParticles(const double& time_step, const int scrollX, const int scrollY, SDL_Renderer* renderer, World* world, TexMan* texman);
+
+    void render(const int scrollX, const int scrollY, const int width, const int height, SpriteBatch& batch);
 };
 
 // "Manager of the Managers" Entity-Manager-Manager
@@ -289,7 +206,7 @@ class EMManager
 {
 private:
     std::vector<EntityManager*> _Managers;
-    // entities will be std::vector<std::vector<Entity*>> entities; in void loadEntities();
+    TexMan* _texman{nullptr};
 
 public:
     EMManager();
@@ -300,11 +217,22 @@ public:
 
     void loadFromPath(std::string path, TexMan* texman);
 
-    void addEntity(Entity* entity);
+    void setTexMan(TexMan* texman) {_texman = texman;}
+
+    // finds the manager for the type, or makes a new one
+    EntityManager* getManager(const EntityType type);
+
+    void addEntity(const EntityType type, vec2<double> pos);
+
+    int getTotal() const;
+    int getTierCount(const ActivityTier tier) const;
 
-    void update(const double& time_step, World& world, double* screen_shake, Player* player, double* slomo, TexMan* texman, CoinManager* coinmanager, ShockWaveManager& shockwaves);
+    void update(const double& time_step, World& world, double* screen_shake, Player* player, double* slomo, EventQueue& events, FluidIndex* fluids, const FlowField* flow, const SDL_Rect& view, Broadphase& bodies);
 
-    void render(const int scrollX, const int scrollY, SDL_Renderer* renderer, const double& time_step, World* world, TexMan* texman);
+    // sprites, glow & health bars go in the batch
+    void render(const int scrollX, const int scrollY, const int width, const int height, SpriteBatch& batch);
+    // particles, smoke, fire & sparks are drawn straight away, flush the batch first
+    void updateParticles(const double& time_step, const int scrollX, const int scrollY, SDL_Renderer* renderer, World* world, TexMan* texman);
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,154 @@
+#ifndef ENTITY_TYPES_H
+#define ENTITY_TYPES_H
+
+#include "./vec2.hpp"
+#include "./texman.hpp"
+#include "./anim.hpp"
+
+#include <array>
+#include <string_view>
+#include <cstdint>
+
+// every kind of entity, used as an index into ENTITY_RECIPES
+enum class EntityType : uint8_t
+{
+    DEFAULT,
+    SLIME,
+    BAT,
+    TURTLE,
+    SWARM, // bats that flock together
+    TOTAL
+};
+
+inline constexpr std::size_t ENTITY_TYPES{static_cast<std::size_t>(EntityType::TOTAL)};
+
+// particles, smoke, fire & sparks thrown out when something happens to an entity
+struct EffectBurst
+{
+    int particles;
+    vec2<double> particle_spread;
+    int smoke;
+    int fire;
+    int sparks; // min sparks
+    int extra_sparks; // + rand() % extra_sparks
+    double spark_speed; // min speed
+    double extra_speed; // + random() * extra_speed
+};
+
+// animation slots, not every type uses all of them (NO_CLIP)
+enum EntityClip : uint8_t
+{
+    CLIP_IDLE,
+    CLIP_RUN,
+    CLIP_JUMP,
+    CLIP_LAND,
+    CLIP_FLASH, // shown while recovering from a hit
+    CLIP_TOTAL
+};
+
+using EntityClips = std::array<ClipDef, CLIP_TOTAL>;
+using EntityPalette = std::array<SDL_Color, 8>; // palette length must be 8 (don't ask)
+
+struct EntityRecipe
+{
+    std::string_view name; // key in the map files
+    bool peaceful;
+    bool stompable; // peaceful, but still touches the player (turtle shells)
+    bool hides; // stops dead when it's hit (into its shell)
+    bool flying; // ignores gravity & bounces off walls, glows, bites
+    bool flocks; // steered as a swarm by Flock instead of one at a time
+    EffectBurst death;
+    EffectBurst hurt;
+    Sound TexMan::* hurt_sound; // on top of the usual damage sound, can be nullptr
+
+    // archetype data, shared by every entity of the type
+    vec2<int> dimensions; // collision box
+    vec2<int> anim_offset;
+    double gravity;
+    double friction; // vel.x kept each frame, 1.0 for none
+    double wander_speed; // peaceful ones
+    double max_health;
+    double damage; // to the player on contact
+    double flash_time; // flash while recover is below this
+    vec2<int> health_bar; // width, x offset
+    EntityPalette palette;
+    EntityClips clips;
+};
+
+inline constexpr EffectBurst NO_BURST{0, {0.0, 0.0}, 0, 0, 0, 1, 0.0, 0.0};
+
+inline constexpr double ENTITY_RECOVER_TIME{10.0};
+inline constexpr double ENTITY_TOP_SPEED{1.0};
+
+inline constexpr EntityPalette DEFAULT_PALETTE{{{0xa8, 0x60, 0x5d}, {0xd1, 0xa6, 0x7e}, {0xf6, 0xe7, 0x9c}, {0xb6, 0xcf, 0x8e}, {0x60, 0xae, 0x7b}, {0x3c, 0x6b, 0x64}, {0x1f, 0x24, 0x4b}, {0x65, 0x40, 0x53}}};
+
+inline const std::array<EntityRecipe, ENTITY_TYPES> ENTITY_RECIPES{{
+    {"default", false, false, false, false, false, NO_BURST, NO_BURST, nullptr,
+        {8, 8}, {0, 0}, 0.2, 1.0, 0.08, 10.0, 5.0, ENTITY_RECOVER_TIME - 1.0, {8, 0},
+        DEFAULT_PALETTE,
+        {NO_CLIP, NO_CLIP, NO_CLIP, NO_CLIP, NO_CLIP}},
+    {"slime", false, false, false, false, false,
+        {32, {8.0, 8.0}, 20, 20, 15, 10, 2.0, 3.0},
+        {16, {3.0, 10.0}, 0, 0, 10, 5, 1.0, 3.0},
+        nullptr,
+        {8, 8}, {1, 1}, 0.2, 1.0, 0.08, 40.0, 5.0, ENTITY_RECOVER_TIME, {11, 0},
+        {{{0x3c, 0x6b, 0x64}, {0xf6, 0xe7, 0x9c}, {0x60, 0xae, 0x7b}, {0x1f, 0x24, 0x4b}, {0x3c, 0x6b, 0x64}, {0xf6, 0xe7, 0x9c}, {0x60, 0xae, 0x7b}, {0x1f, 0x24, 0x4b}}},
+        {{{&TexMan::slimeIdle, {13, 9, 6, 0.16, true}},
+          {&TexMan::slimeRun, {13, 9, 5, 0.2, true}},
+          {&TexMan::slimeJump, {13, 9, 8, 0.21, true}},
+          NO_CLIP,
+          {&TexMan::slimeFlash, {13, 9, 1, 0.2, true}}}}},
+    {"bat", false, false, false, true, false,
+        {16, {8.0, 4.0}, 5, 10, 15, 10, 1.0, 2.0},
+        {8, {4.0, 4.0}, 0, 0, 6, 5, 0.5, 2.0},
+        nullptr,
+        {8, 8}, {2, 0}, 0.05, 1.0, 0.08, 20.0, 3.0, ENTITY_RECOVER_TIME, {7, 1},
+        {{{0xa8, 0x60, 0x5d}, {0x65, 0x40, 0x53}, {0x1f, 0x24, 0x4b}, {0xa8, 0x60, 0x5d}, {0x65, 0x40, 0x53}, {0x1f, 0x24, 0x4b}, {0xa8, 0x60, 0x5d}, {0x65, 0x40, 0x53}}},
+        {{{&TexMan::bat, {7, 4, 2, 0.3, true}},
+          NO_CLIP,
+          NO_CLIP,
+          NO_CLIP,
+          {&TexMan::batFlash, {7, 4, 1, 0.2, true}}}}},
+    {"turtle", true, true, true, false, false,
+        {32, {8.0, 8.0}, 20, 20, 15, 10, 2.0, 3.0},
+        {16, {8.0, 8.0}, 0, 0, 10, 5, 0.5, 2.0},
+        &TexMan::SFX_turtle,
+        {8, 8}, {0, 0}, 0.4, 0.9, 0.04, 60.0, 0.0, ENTITY_RECOVER_TIME - 1.0, {8, 0},
+        DEFAULT_PALETTE,
+        {{{&TexMan::turtleIdle, {8, 8, 6, 0.2, true}},
+          {&TexMan::turtleRun, {8, 8, 5, 0.2, true}},
+          {&TexMan::turtleJump, {8, 8, 6, 0.2, false}},
+          {&TexMan::turtleLand, {8, 8, 6, 0.3, false}},
+          {&TexMan::turtleFlash, {7, 4, 1, 0.2, true}}}}},
+    {"swarm", false, false, false, true, true,
+        {16, {8.0, 4.0}, 5, 10, 15, 10, 1.0, 2.0},
+        {8, {4.0, 4.0}, 0, 0, 6, 5, 0.5, 2.0},
+        nullptr,
+        {8, 8}, {2, 0}, 0.05, 1.0, 0.08, 10.0, 3.0, ENTITY_RECOVER_TIME, {7, 1},
+        {{{0xa8, 0x60, 0x5d}, {0x65, 0x40, 0x53}, {0x1f, 0x24, 0x4b}, {0xa8, 0x60, 0x5d}, {0x65, 0x40, 0x53}, {0x1f, 0x24, 0x4b}, {0xa8, 0x60, 0x5d}, {0x65, 0x40, 0x53}}},
+        {{{&TexMan::bat, {7, 4, 2, 0.3, true}},
+          NO_CLIP,
+          NO_CLIP,
+          NO_CLIP,
+          {&TexMan::batFlash, {7, 4, 1, 0.2, true}}}}}
+}};
+
+inline const EntityRecipe& getRecipe(const EntityType type)
+{
+    return ENTITY_RECIPES[static_cast<std::size_t>(type)];
+}
+
+// only for loading maps, never call this per frame
+inline EntityType getEntityType(std::string_view name)
+{
+    for (std::size_t i{0}; i < ENTITY_TYPES; ++i)
+    {
+        if (ENTITY_RECIPES[i].name == name)
+        {
+            return static_cast<EntityType>(i);
+        }
+    }
+    return EntityType::DEFAULT;
+}
+
+#endif
@@ -0,0 +1,88 @@
+#ifndef EVENTS_H
+#define EVENTS_H
+
+#include "./vec2.hpp"
+#include "./entity_types.hpp"
+
+#include <vector>
+#include <array>
+#include <cstdint>
+
+// things that happened during the simulation that something else needs to react to (effects, sounds,
+// coins). The simulation only posts them, the game plays them all at once after everything's moved
+enum class GameEventType : uint8_t
+{
+    ENTITY_HURT,
+    ENTITY_DIED,
+    ENTITY_STOMPED, // turtle shells getting jumped on
+    PLAYER_HURT,
+    PLAYER_DIED,
+    TOTAL
+};
+
+inline constexpr std::size_t GAME_EVENT_TYPES{static_cast<std::size_t>(GameEventType::TOTAL)};
+
+// effects past these in one frame get dropped, nobody can tell the 30th explosion from the 20th.
+// coins always drop, they're worth money
+inline constexpr int EVENT_BURST_BUDGET{24}; // particle & spark bursts
+inline constexpr int EVENT_SHOCKWAVE_BUDGET{6};
+
+struct GameEvent
+{
+    GameEventType type;
+    EntityType entity; // for the ENTITY_* ones
+    vec2<double> pos; // center of whatever it happened to
+};
+
+struct RecordedEvent
+{
+    uint32_t frame;
+    GameEvent event;
+};
+
+// per frame queue of GameEvents. Can keep a log of everything posted for replays & telemetry
+class EventQueue
+{
+private:
+    std::vector<GameEvent> _Events{};
+    std::vector<RecordedEvent> _Log{};
+    std::array<uint32_t, GAME_EVENT_TYPES> _Totals{};
+    uint32_t _frame{0};
+    bool _recording{false};
+
+public:
+    EventQueue()
+    {
+    }
+
+    void post(const GameEventType type, const vec2<double> pos, const EntityType entity = EntityType::DEFAULT)
+    {
+        const GameEvent event{type, entity, pos};
+        _Events.push_back(event);
+        ++_Totals[static_cast<std::size_t>(type)];
+        if (_recording)
+        {
+            _Log.push_back(RecordedEvent{_frame, event});
+        }
+    }
+
+    const std::vector<GameEvent>& getEvents() const {return _Events;}
+    bool empty() const {return _Events.empty();}
+
+    // call once the frame's events have been played
+    void clear()
+    {
+        _Events.clear();
+        ++_frame;
+    }
+
+    void setRecording(const bool val) {_recording = val;}
+    bool getRecording() const {return _recording;}
+    const std::vector<RecordedEvent>& getLog() const {return _Log;}
+    void clearLog() {_Log.clear();}
+
+    // everything of a type posted since the queue was made
+    uint32_t getTotal(const GameEventType type) const {return _Totals[static_cast<std::size_t>(type)];}
+};
+
+#endif
@@ -0,0 +1,151 @@
+#include "./flock.hpp"
+#include "./util.hpp"
+
+#include <cmath>
+#include <algorithm>
+
+void Flock::gather(const std::vector<vec2<double>>& pos, const std::vector<vec2<double>>& vel, const std::vector<double>& step, const vec2<double> half_size)
+{
+    _Members.clear();
+    _X.clear();
+    _Y.clear();
+    _VX.clear();
+    _VY.clear();
+    _Step.clear();
+    for (std::size_t i{0}; i < pos.size(); ++i)
+    {
+        if (step[i] <= 0.0)
+        {
+            continue;
+        }
+        _Members.push_back(static_cast<int>(i));
+        _X.push_back(pos[i].x + half_size.x);
+        _Y.push_back(pos[i].y + half_size.y);
+        _VX.push_back(vel[i].x);
+        _VY.push_back(vel[i].y);
+        _Step.push_back(step[i]);
+    }
+    _AX.assign(_Members.size(), 0.0);
+    _AY.assign(_Members.size(), 0.0);
+
+    // every member is a point, so it only ever lands in one cell
+    _Grid.clear();
+    for (std::size_t m{0}; m < _Members.size(); ++m)
+    {
+        _Grid.insert(SDL_Rect{static_cast<int>(_X[m]), static_cast<int>(_Y[m]), 1, 1}, static_cast<int>(m));
+    }
+}
+
+void Flock::neighbours()
+{
+    const double radius_sq{FLOCK_RADIUS * FLOCK_RADIUS};
+    const double separation_sq{FLOCK_SEPARATION * FLOCK_SEPARATION};
+    const int reach{static_cast<int>(FLOCK_RADIUS)};
+    for (std::size_t m{0}; m < _Members.size(); ++m)
+    {
+        const double x{_X[m]};
+        const double y{_Y[m]};
+        double push_x{0.0};
+        double push_y{0.0};
+        double sum_vx{0.0};
+        double sum_vy{0.0};
+        double sum_x{0.0};
+        double sum_y{0.0};
+        int count{0};
+        const SDL_Rect area{static_cast<int>(x) - reach, static_cast<int>(y) - reach, reach * 2 + 1, reach * 2 + 1};
+        _Grid.visit(area, [&](const int n, const int, const int)
+        {
+            if (n == static_cast<int>(m) || count >= FLOCK_MAX_NEIGHBOURS)
+            {
+                return;
+            }
+            const double dx{x - _X[n]};
+            const double dy{y - _Y[n]};
+            const double dist_sq{dx * dx + dy * dy};
+            if (dist_sq > radius_sq)
+            {
+                return;
+            }
+            ++count;
+            sum_vx += _VX[n];
+            sum_vy += _VY[n];
+            sum_x += _X[n];
+            sum_y += _Y[n];
+            // pushes harder the closer they are
+            if (dist_sq < separation_sq && dist_sq > 0.0)
+            {
+                push_x += dx / dist_sq;
+                push_y += dy / dist_sq;
+            }
+        });
+        if (count == 0)
+        {
+            continue;
+        }
+        const double inv{1.0 / count};
+        _AX[m] += push_x * FLOCK_SEPARATE_WEIGHT + (sum_vx * inv - _VX[m]) * FLOCK_ALIGN_WEIGHT + (sum_x * inv - x) * FLOCK_COHERE_WEIGHT;
+        _AY[m] += push_y * FLOCK_SEPARATE_WEIGHT + (sum_vy * inv - _VY[m]) * FLOCK_ALIGN_WEIGHT + (sum_y * inv - y) * FLOCK_COHERE_WEIGHT;
+    }
+}
+
+void Flock::chase(const vec2<double>& player_pos, const FlowField* flow)
+{
+    const double range_sq{FLOCK_PLAYER_RANGE * FLOCK_PLAYER_RANGE};
+    for (std::size_t m{0}; m < _Members.size(); ++m)
+    {
+        const vec2<double> center{_X[m], _Y[m]};
+        const double dx{player_pos.x - center.x};
+        const double dy{player_pos.y - center.y};
+        vec2<double> target{player_pos};
+        bool chasing{dx * dx + dy * dy < range_sq};
+        if (chasing && flow != nullptr)
+        {
+            // same as a lone bat: the middle of the next tile, or the player once they share one
+            vec2<int> step;
+            chasing = flow->getStep(FlowLayer::FLYER, center, step);
+            if (chasing && (step.x != static_cast<int>(std::floor(center.x / TILE_SIZE)) || step.y != static_cast<int>(std::floor(center.y / TILE_SIZE))))
+            {
+                target = {(step.x + 0.5) * TILE_SIZE, (step.y + 0.5) * TILE_SIZE};
+            }
+        }
+        if (chasing)
+        {
+            _AX[m] += std::max(-0.1, std::min(0.1, (target.x - center.x) * FLOCK_CHASE_WEIGHT));
+            _AY[m] += std::max(-0.1, std::min(0.1, (target.y - center.y) * FLOCK_CHASE_WEIGHT));
+        } else {
+            _AX[m] += (Util::random() * 2.0 - 1.0) * FLOCK_JITTER;
+            _AY[m] += (Util::random() * 2.0 - 1.0) * FLOCK_JITTER;
+        }
+    }
+}
+
+void Flock::apply(std::vector<vec2<double>>& vel)
+{
+    // no branches or lookups in here, so it vectorises
+    const std::size_t num{_Members.size()};
+    for (std::size_t m{0}; m < num; ++m)
+    {
+        const double ax{std::max(-FLOCK_MAX_ACCEL, std::min(FLOCK_MAX_ACCEL, _AX[m]))};
+        const double ay{std::max(-FLOCK_MAX_ACCEL, std::min(FLOCK_MAX_ACCEL, _AY[m]))};
+        _VX[m] += ax * _Step[m];
+        _VY[m] += ay * _Step[m];
+        _VX[m] += (_VX[m] * FLOCK_DRAG - _VX[m]) * _Step[m];
+        _VY[m] += (_VY[m] * FLOCK_DRAG - _VY[m]) * _Step[m];
+    }
+    for (std::size_t m{0}; m < num; ++m)
+    {
+        vel[_Members[m]] = {_VX[m], _VY[m]};
+    }
+}
+
+void Flock::steer(const std::vector<vec2<double>>& pos, std::vector<vec2<double>>& vel, const std::vector<double>& step, const vec2<double> half_size, const vec2<double>& player_pos, const FlowField* flow)
+{
+    gather(pos, vel, step, half_size);
+    if (_Members.empty())
+    {
+        return;
+    }
+    neighbours();
+    chase(player_pos, flow);
+    apply(vel);
+}
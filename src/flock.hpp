@@ -0,0 +1,60 @@
+#ifndef FLOCK_H
+#define FLOCK_H
+
+#include "./constants.hpp"
+#include "./vec2.hpp"
+#include "./spatial.hpp"
+#include "./flowfield.hpp"
+
+#include <vector>
+
+// boids steering for swarms of flyers: keep apart, line up, stick together & go for the player.
+// Neighbours come from a grid of FLOCK_RADIUS cells, so it's about the same cost per member however
+// big the swarm gets. Members are gathered into flat arrays first so the maths runs in tight loops
+
+inline constexpr double FLOCK_RADIUS{24.0}; // px, how far a member can see the rest
+inline constexpr double FLOCK_SEPARATION{8.0}; // px, closer than this and they push apart
+inline constexpr int FLOCK_MAX_NEIGHBOURS{12}; // stops dense knots from costing more
+inline constexpr double FLOCK_SEPARATE_WEIGHT{0.6};
+inline constexpr double FLOCK_ALIGN_WEIGHT{0.05};
+inline constexpr double FLOCK_COHERE_WEIGHT{0.004};
+inline constexpr double FLOCK_CHASE_WEIGHT{0.02};
+inline constexpr double FLOCK_PLAYER_RANGE{200.0}; // same as a lone bat
+inline constexpr double FLOCK_JITTER{0.04}; // random accel so idle swarms churn about
+inline constexpr double FLOCK_MAX_ACCEL{0.15};
+inline constexpr double FLOCK_DRAG{0.95}; // vel kept per frame
+
+class Flock
+{
+private:
+    SpatialGrid<int> _Grid{};
+
+    // members this update, as parallel arrays
+    std::vector<int> _Members{}; // index into the caller's arrays
+    std::vector<double> _X{};
+    std::vector<double> _Y{};
+    std::vector<double> _VX{};
+    std::vector<double> _VY{};
+    std::vector<double> _AX{}; // steering accel
+    std::vector<double> _AY{};
+    std::vector<double> _Step{};
+
+    void gather(const std::vector<vec2<double>>& pos, const std::vector<vec2<double>>& vel, const std::vector<double>& step, const vec2<double> half_size);
+    void neighbours();
+    void chase(const vec2<double>& player_pos, const FlowField* flow);
+    void apply(std::vector<vec2<double>>& vel);
+
+public:
+    Flock()
+    {
+        _Grid.init(LEVEL_TILE_WIDTH * TILE_SIZE, LEVEL_TILE_HEIGHT * TILE_SIZE, static_cast<int>(FLOCK_RADIUS));
+    }
+
+    std::size_t size() const {return _Members.size();}
+
+    // steers everything with a step this frame (pos is the top left, half_size gets to the middle).
+    // flow can be nullptr, then they head straight for the player when they're in range
+    void steer(const std::vector<vec2<double>>& pos, std::vector<vec2<double>>& vel, const std::vector<double>& step, const vec2<double> half_size, const vec2<double>& player_pos, const FlowField* flow);
+};
+
+#endif
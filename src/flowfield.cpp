@@ -0,0 +1,241 @@
+#include "./flowfield.hpp"
+
+void FlowField::init(World& world)
+{
+    free();
+    _width = LEVEL_TILE_WIDTH;
+    _height = LEVEL_TILE_HEIGHT;
+    _Blocked.assign(_width * _height, 0);
+    _Ground.assign(_width * _height, 0);
+    for (int y{0}; y < _height; ++y)
+    {
+        for (int x{0}; x < _width; ++x)
+        {
+            _Blocked[index(x, y)] = world.isSolid(x, y) || world.isDanger(x, y);
+        }
+    }
+    for (int y{0}; y < _height - 1; ++y)
+    {
+        for (int x{0}; x < _width; ++x)
+        {
+            _Ground[index(x, y)] = !_Blocked[index(x, y)] && world.isSolid(x, y + 1);
+        }
+    }
+
+    std::vector<std::pair<int, int>> edges{};
+    addWalkerEdges(edges);
+    link(_Layers[static_cast<std::size_t>(FlowLayer::WALKER)], edges);
+    edges.clear();
+    addFlyerEdges(edges);
+    link(_Layers[static_cast<std::size_t>(FlowLayer::FLYER)], edges);
+}
+
+void FlowField::free()
+{
+    _width = 0;
+    _height = 0;
+    _Blocked.clear();
+    _Ground.clear();
+    for (Layer& layer : _Layers)
+    {
+        layer = Layer{};
+    }
+}
+
+void FlowField::addWalkerEdges(std::vector<std::pair<int, int>>& edges) const
+{
+    for (int y{0}; y < _height; ++y)
+    {
+        for (int x{0}; x < _width; ++x)
+        {
+            if (!isGround(x, y))
+            {
+                continue;
+            }
+            const int from{index(x, y)};
+            for (const int dx : {-1, 1})
+            {
+                const int nx{x + dx};
+                if (isGround(nx, y))
+                {
+                    edges.push_back({from, index(nx, y)});
+                } else if (isOpen(nx, y))
+                {
+                    // walk off the ledge and fall until there's ground
+                    int ny{y + 1};
+                    while (isOpen(nx, ny) && !isGround(nx, ny))
+                    {
+                        ++ny;
+                    }
+                    if (isGround(nx, ny))
+                    {
+                        edges.push_back({from, index(nx, ny)});
+                    }
+                }
+                // jump up onto a ledge, as long as nothing is in the way overhead
+                for (int k{1}; k <= FLOW_JUMP_TILES && isOpen(x, y - k); ++k)
+                {
+                    if (isGround(nx, y - k))
+                    {
+                        edges.push_back({from, index(nx, y - k)});
+                    }
+                }
+            }
+        }
+    }
+}
+
+void FlowField::addFlyerEdges(std::vector<std::pair<int, int>>& edges) const
+{
+    for (int y{0}; y < _height; ++y)
+    {
+        for (int x{0}; x < _width; ++x)
+        {
+            if (!isOpen(x, y))
+            {
+                continue;
+            }
+            const int from{index(x, y)};
+            for (int dy{-1}; dy <= 1; ++dy)
+            {
+                for (int dx{-1}; dx <= 1; ++dx)
+                {
+                    if ((dx == 0 && dy == 0) || !isOpen(x + dx, y + dy))
+                    {
+                        continue;
+                    }
+                    // no cutting corners
+                    if (dx != 0 && dy != 0 && (!isOpen(x + dx, y) || !isOpen(x, y + dy)))
+                    {
+                        continue;
+                    }
+                    edges.push_back({from, index(x + dx, y + dy)});
+                }
+            }
+        }
+    }
+}
+
+void FlowField::link(Layer& layer, const std::vector<std::pair<int, int>>& edges)
+{
+    const int cells{_width * _height};
+    layer.start.assign(cells + 1, 0);
+    for (const auto& edge : edges)
+    {
+        ++layer.start[edge.second + 1];
+    }
+    for (int i{0}; i < cells; ++i)
+    {
+        layer.start[i + 1] += layer.start[i];
+    }
+    layer.edges.assign(edges.size(), 0);
+    std::vector<int> fill{layer.start.begin(), layer.start.end() - 1};
+    for (const auto& edge : edges)
+    {
+        layer.edges[fill[edge.second]++] = edge.first;
+    }
+    layer.next.assign(cells, FLOW_NONE);
+    layer.building.assign(cells, FLOW_NONE);
+    layer.queue.clear();
+    layer.queue.reserve(cells);
+}
+
+int FlowField::findTarget(const FlowLayer layer, const vec2<double>& player_pos) const
+{
+    const int x{static_cast<int>(std::floor(player_pos.x / TILE_SIZE))};
+    const int y{static_cast<int>(std::floor(player_pos.y / TILE_SIZE))};
+    if (layer == FlowLayer::FLYER)
+    {
+        return isOpen(x, y) ? index(x, y) : FLOW_NONE;
+    }
+    // mid jump, aim for where they'll land
+    for (int ny{y}; ny <= y + FLOW_PLAYER_DROP && isOpen(x, ny); ++ny)
+    {
+        if (isGround(x, ny))
+        {
+            return index(x, ny);
+        }
+    }
+    return FLOW_NONE;
+}
+
+void FlowField::search(Layer& layer, int budget)
+{
+    while (layer.head < layer.queue.size() && budget > 0)
+    {
+        const int cell{layer.queue[layer.head++]};
+        for (int e{layer.start[cell]}; e < layer.start[cell + 1]; ++e)
+        {
+            const int from{layer.edges[e]};
+            if (layer.building[from] == FLOW_NONE)
+            {
+                layer.building[from] = cell;
+                layer.queue.push_back(from);
+            }
+        }
+        --budget;
+    }
+    if (layer.head >= layer.queue.size())
+    {
+        layer.next.swap(layer.building);
+        layer.target = layer.pending;
+        layer.searching = false;
+    }
+}
+
+void FlowField::update(const vec2<double>& player_pos)
+{
+    if (isEmpty())
+    {
+        return;
+    }
+    for (std::size_t l{0}; l < FLOW_LAYERS; ++l)
+    {
+        Layer& layer{_Layers[l]};
+        if (!layer.searching)
+        {
+            // don't restart a search that's under way, or a falling player would stop it ever finishing
+            const int target{findTarget(static_cast<FlowLayer>(l), player_pos)};
+            if (target == FLOW_NONE || target == layer.target)
+            {
+                continue;
+            }
+            std::fill(layer.building.begin(), layer.building.end(), FLOW_NONE);
+            layer.building[target] = target;
+            layer.queue.clear();
+            layer.queue.push_back(target);
+            layer.head = 0;
+            layer.pending = target;
+            layer.searching = true;
+        }
+        search(layer, FLOW_BUDGET);
+    }
+}
+
+void FlowField::finish()
+{
+    for (Layer& layer : _Layers)
+    {
+        if (layer.searching)
+        {
+            search(layer, _width * _height);
+        }
+    }
+}
+
+bool FlowField::getStep(const FlowLayer layer, const vec2<double>& pos, vec2<int>& step) const
+{
+    const int x{static_cast<int>(std::floor(pos.x / TILE_SIZE))};
+    const int y{static_cast<int>(std::floor(pos.y / TILE_SIZE))};
+    if (!inBounds(x, y))
+    {
+        return false;
+    }
+    const int next{_Layers[static_cast<std::size_t>(layer)].next[index(x, y)]};
+    if (next == FLOW_NONE)
+    {
+        return false;
+    }
+    step = {next % _width, next / _width};
+    return true;
+}
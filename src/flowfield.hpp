@@ -0,0 +1,91 @@
+#ifndef FLOW_FIELD_H
+#define FLOW_FIELD_H
+
+#include "./constants.hpp"
+#include "./vec2.hpp"
+#include "./tiles.hpp"
+
+#include <vector>
+#include <array>
+#include <cstdint>
+
+// breadth first search over the tile grid out from the player's tile. Every reachable cell ends up
+// knowing which cell to move to next, so any number of chasers can look their way up in O(1)
+
+inline constexpr int FLOW_BUDGET{2048}; // cells searched per frame, a whole level takes a few frames
+inline constexpr int FLOW_JUMP_TILES{3}; // slimes jump @ -3.2 with 0.2 gravity, ~25px
+inline constexpr int FLOW_PLAYER_DROP{8}; // tiles to look below the player for ground while they're in the air
+inline constexpr int FLOW_NONE{-1};
+
+enum class FlowLayer : uint8_t
+{
+    WALKER, // stands on tiles, walks, jumps & drops off ledges
+    FLYER, // anywhere that isn't solid
+    TOTAL
+};
+
+inline constexpr std::size_t FLOW_LAYERS{static_cast<std::size_t>(FlowLayer::TOTAL)};
+
+class FlowField
+{
+private:
+    // one search per layer. The graph is reversed (edges point from a cell to the cells that can move
+    // into it), since the search starts at the player and works outwards
+    struct Layer
+    {
+        std::vector<int> start{}; // cell i's predecessors are edges[start[i]] to edges[start[i + 1]]
+        std::vector<int> edges{};
+
+        std::vector<int> next{}; // finished field, cell to head for, FLOW_NONE if there's no way
+        std::vector<int> building{}; // field being searched
+        std::vector<int> queue{};
+        std::size_t head{0};
+
+        int target{FLOW_NONE}; // cell the finished field leads to
+        int pending{FLOW_NONE}; // cell the search in progress leads to
+        bool searching{false};
+    };
+
+    int _width{0};
+    int _height{0};
+    std::vector<uint8_t> _Blocked{}; // solid or dangerous
+    std::vector<uint8_t> _Ground{}; // somewhere a walker can stand
+    std::array<Layer, FLOW_LAYERS> _Layers{};
+
+    int index(const int x, const int y) const {return y * _width + x;}
+    bool inBounds(const int x, const int y) const {return 0 <= x && x < _width && 0 <= y && y < _height;}
+    bool isOpen(const int x, const int y) const {return inBounds(x, y) && !_Blocked[index(x, y)];}
+    bool isGround(const int x, const int y) const {return inBounds(x, y) && _Ground[index(x, y)];}
+
+    // edges as (from, to) pairs, turned into the reversed lists by link()
+    void addWalkerEdges(std::vector<std::pair<int, int>>& edges) const;
+    void addFlyerEdges(std::vector<std::pair<int, int>>& edges) const;
+    void link(Layer& layer, const std::vector<std::pair<int, int>>& edges);
+
+    int findTarget(const FlowLayer layer, const vec2<double>& player_pos) const;
+    void search(Layer& layer, int budget);
+
+public:
+    FlowField()
+    {
+    }
+
+    // the graph only depends on the tiles, so this only runs when a level loads
+    void init(World& world);
+    void free();
+
+    bool isEmpty() const {return _Blocked.empty();}
+
+    // restarts the searches when the player has changed tiles, and does at most FLOW_BUDGET cells of work
+    void update(const vec2<double>& player_pos);
+    // finish every search under way right now (benchmarks)
+    void finish();
+
+    // tile to move towards from pos (px) to get to the player, false if there's no known way there.
+    // the player's own tile steps to itself
+    bool getStep(const FlowLayer layer, const vec2<double>& pos, vec2<int>& step) const;
+
+    bool isSearching(const FlowLayer layer) const {return _Layers[static_cast<std::size_t>(layer)].searching;}
+};
+
+#endif
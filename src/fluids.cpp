@@ -0,0 +1,125 @@
+#include "./fluids.hpp"
+
+void FluidIndex::clear()
+{
+    _Bodies.clear();
+    _Grid.clear();
+}
+
+void FluidIndex::build(WaterManager* water, LavaManager* lava, CellFluid* cells)
+{
+    clear();
+    _Grid.init(LEVEL_WIDTH * CHUNK_SIZE * TILE_SIZE, LEVEL_HEIGHT * CHUNK_SIZE * TILE_SIZE, CHUNK_SIZE * TILE_SIZE);
+    if (water != nullptr)
+    {
+        for (Water* body : water->getWater())
+        {
+            _Bodies.push_back(FluidBody{FluidType::WATER, body->getRect(), &body->getSurface(), body, nullptr, nullptr});
+        }
+    }
+    if (lava != nullptr)
+    {
+        for (Lava* body : lava->getLava())
+        {
+            _Bodies.push_back(FluidBody{FluidType::LAVA, body->getRect(), &body->getSurface(), nullptr, body, nullptr});
+        }
+    }
+    // one body over the whole level, query() checks there's liquid under whatever's asking
+    if (cells != nullptr && !cells->isEmpty())
+    {
+        _Bodies.push_back(FluidBody{FluidType::WATER, cells->getRect(), &cells->getSurface(), nullptr, nullptr, cells});
+    }
+    for (std::size_t i{0}; i < _Bodies.size(); ++i)
+    {
+        // surfaces can ride a bit above the rect
+        SDL_Rect area{*_Bodies[i].rect};
+        area.y -= TILE_SIZE;
+        area.h += TILE_SIZE;
+        _Grid.insert(area, static_cast<int>(i));
+    }
+}
+
+void FluidIndex::wake(FluidBody& body)
+{
+    if (body.water != nullptr && body.water->getSleeping())
+    {
+        body.water->wake();
+    }
+    if (body.lava != nullptr && body.lava->getSleeping())
+    {
+        body.lava->wake();
+    }
+}
+
+FluidBody* FluidIndex::query(const SDL_Rect* rect)
+{
+    _Found.clear();
+    _Grid.query(*rect, _Found);
+    for (const int i : _Found)
+    {
+        FluidBody& body{_Bodies[i]};
+        SDL_Rect area{body.rect->x, body.rect->y - TILE_SIZE, body.rect->w, body.rect->h + TILE_SIZE};
+        if (Util::checkCollision(rect, &area) && (body.cells == nullptr || body.cells->isWet(*rect)))
+        {
+            return &body;
+        }
+    }
+    return nullptr;
+}
+
+void FluidIndex::splash(FluidBody& body, const SDL_Rect* rect, const vec2<double>& vel, const double& time_step)
+{
+    wake(body);
+    WaveSurface& surface{*body.surface};
+    const double force{std::max(-3.0, std::min(8.0, vel.y * 3.0)) * 0.5 * time_step};
+    const int last{surface.getIndex(static_cast<double>(rect->x + rect->w))};
+    for (int i{surface.getIndex(static_cast<double>(rect->x))}; i <= last; ++i)
+    {
+        if (std::abs(surface.getOffset(i)) < 3.0)
+        {
+            surface.disturb(i, force);
+        }
+    }
+    // only hard landings throw up droplets
+    if (vel.y > 1.5)
+    {
+        const SDL_Color col{body.type == FluidType::LAVA ? SDL_Color{0xff, 0x76, 0x00, 0xff} : SDL_Color{0x28, 0xca, 0xb1, 0xff}};
+        const vec2<double> pos{static_cast<double>(rect->x) + static_cast<double>(rect->w) / 2.0, surface.getY(surface.getIndex(static_cast<double>(rect->x) + static_cast<double>(rect->w) / 2.0)) - 1.0};
+        _Splash.addParticles(pos, std::min(12, static_cast<int>(vel.y * 4.0)), {0.0, -vel.y * 0.6}, {2.5, 1.0}, col);
+    }
+}
+
+FluidType FluidIndex::interact(const SDL_Rect* rect, vec2<double>& vel, const FluidProps& props, const double& time_step)
+{
+    FluidBody* body{query(rect)};
+    if (body == nullptr)
+    {
+        return FluidType::NONE;
+    }
+
+    WaveSurface& surface{*body->surface};
+    const double center_x{static_cast<double>(rect->x) + static_cast<double>(rect->w) / 2.0};
+    const double bottom{static_cast<double>(rect->y + rect->h)};
+    const double surface_y{body->cells != nullptr ? body->cells->getSurfaceY(center_x, bottom - 1.0) : surface.getY(surface.getIndex(center_x))};
+    if (bottom < surface_y)
+    {
+        return FluidType::NONE;
+    }
+
+    // crossing the surface
+    if (static_cast<double>(rect->y) < surface_y && std::abs(vel.y) > 0.5)
+    {
+        splash(*body, rect, vel, time_step);
+    }
+
+    const double submerged{std::max(0.0, std::min(1.0, (bottom - surface_y) / static_cast<double>(std::max(1, rect->h))))};
+    vel.x += (vel.x * props.drag - vel.x) * submerged * time_step;
+    vel.y += (vel.y * props.drag - vel.y) * submerged * time_step;
+    vel.y -= props.buoyancy * submerged * time_step;
+    return body->type;
+}
+
+void FluidIndex::updateParticles(const double& time_step, const int scrollX, const int scrollY, SDL_Renderer* renderer, World* world, TexMan* texman)
+{
+    _Splash.update(time_step, scrollX, scrollY, renderer, world, texman);
+}
@@ -0,0 +1,79 @@
+#ifndef FLUIDS_H
+#define FLUIDS_H
+
+#include "SDL2/SDL.h"
+
+#include "./constants.hpp"
+#include "./vec2.hpp"
+#include "./util.hpp"
+#include "./water.hpp"
+#include "./cellfluid.hpp"
+#include "./waves.hpp"
+#include "./spatial.hpp"
+#include "./particles.hpp"
+#include "./texman.hpp"
+#include "./tiles.hpp"
+
+#include <vector>
+
+enum class FluidType
+{
+    NONE,
+    WATER,
+    LAVA
+};
+
+// how an object reacts to being submerged, per frame @ 60fps
+struct FluidProps
+{
+    double buoyancy; // upwards accel when fully under
+    double drag; // fraction of vel kept
+};
+
+inline constexpr FluidProps ENTITY_FLUID{0.25, 0.9}; // entities fall @ 0.2, so they bob back up
+inline constexpr FluidProps COIN_FLUID{0.05, 0.85}; // coins fall @ 0.07, so they sink slowly
+
+// a water or lava body in the index
+struct FluidBody
+{
+    FluidType type;
+    SDL_Rect* rect;
+    WaveSurface* surface;
+    Water* water;
+    Lava* lava;
+    CellFluid* cells; // the rect is the whole level, only cells with liquid in count
+};
+
+// spatial index over every water & lava body in the level, and the cell fluid, so any dynamic object
+// can check fluids without looping through every body. Rebuild it whenever the water or lava managers
+// or the cell fluid get reloaded
+class FluidIndex
+{
+private:
+    std::vector<FluidBody> _Bodies{};
+    SpatialGrid<int> _Grid{};
+    std::vector<int> _Found{}; // query scratch buffer
+
+    ParticleSpawner _Splash{512, 0, {0.0, 0.0}, {0.98, 0.98}, 0.1, 0.2, true};
+
+    void wake(FluidBody& body);
+    void splash(FluidBody& body, const SDL_Rect* rect, const vec2<double>& vel, const double& time_step);
+
+public:
+    FluidIndex()
+    {
+    }
+
+    void build(WaterManager* water, LavaManager* lava, CellFluid* cells);
+    void clear();
+
+    // the first body overlapping rect, nullptr if there isn't one
+    FluidBody* query(const SDL_Rect* rect);
+
+    // splashes, drag & buoyancy for anything with a rect & vel, returns what it's touching
+    FluidType interact(const SDL_Rect* rect, vec2<double>& vel, const FluidProps& props, const double& time_step);
+
+    void updateParticles(const double& time_step, const int scrollX, const int scrollY, SDL_Renderer* renderer, World* world, TexMan* texman);
+};
+
+#endif
@@ -20,16 +20,25 @@
 #include "./entities.hpp"
 #include "./sparks.hpp"
 #include "./water.hpp"
+#include "./fluids.hpp"
+#include "./cellfluid.hpp"
+#include "./flowfield.hpp"
+#include "./triggers.hpp"
+#include "./events.hpp"
 #include "./coin.hpp"
 #include "./buttons.hpp"
 #include "./shockwaves.hpp"
 #include "./stars.hpp"
 #include "./audio.hpp"
 #include "./popups.hpp"
-// #include "./clouds.hpp"
+#include "./hud.hpp"
+#include "./background.hpp"
+#include "./headless.hpp"
 
 using json = nlohmann::json;
 
+inline constexpr double PORTAL_BOB{4.0}; // px the portal floats up & down
+
 constexpr SDL_Color PALETTE[8] {{0xa8, 0x60, 0x5d}, {0xd1, 0xa6, 0x7e}, {0xf6, 0xe7, 0x9c}, {0xb6, 0xcf, 0x8e}, {0x60, 0xae, 0x7b}, {0x3c, 0x6b, 0x64}, {0x1f, 0x24, 0x4b}, {0x65, 0x40, 0x53}};
 
 class Game
@@ -45,10 +54,19 @@ private:
     EMManager _EMManager{}; // this is the entity manager :) "The Manager of the Managers"
     WaterManager* _WaterManager{nullptr};
     LavaManager* _LavaManager{nullptr};
+    FluidIndex _FluidIndex{};
+    CellFluid _CellFluid{};
+    FlowField _FlowField{}; // shared pathing towards the player
+    Broadphase _Broadphase{}; // this frame's moving bodies, for contacts, pickups & grass
+    SpriteBatch _Batch{}; // tiles, entities, coins & the rest, flushed around whatever's drawn straight to the renderer
+    TriggerIndex _Triggers{}; // springs, water, lava & the portal
+    TriggerState _PlayerTriggers{};
+    EventQueue _Events{}; // hits & deaths from this frame's simulation, played by playEvents()
     CoinManager _CoinManager{};
     ShockWaveManager _ShockWaveManager{};
-    StarManager _StarManager{100};
+    Background _Background{}; // stars & the moon
     PopUpManager _PopUpManager{};
+    HUD _HUD{}; // only redrawn when what it shows changes
 
     std::vector<std::string> _levels {"data/maps/0.json", "data/maps/1.json", "data/maps/2.json", "data/maps/3.json", "data/maps/other_1.json", "data/maps/other_2.json", "data/maps/other_4.json", "data/maps/4.json", "data/maps/5.json", "data/maps/6.json", "data/maps/other_3.json", "data/maps/7.json", "data/maps/8.json", "data/maps/9.json", "data/maps/10.json", "data/maps/11.json", "data/maps/12.json", "data/maps/13.json", "data/maps/14.json", "data/maps/15.json"};
     int _level{0};
@@ -67,6 +85,10 @@ private:
     double _playerHealth{100.0};
     vec2<double> _portal_pos{0.0, 0.0};
 
+    bool _headless{false}; // software rendering, scripted input & a fixed time step, see startHeadless()
+    int _headless_frames{HEADLESS_DEFAULT_FRAMES};
+    FrameStats _FrameStats{};
+
 public:
     Game()
     {
@@ -108,11 +130,37 @@ public:
         }
     }
 
+    // the scripted session on one level for a set number of frames, then prints the frame times. SDL
+    // has to have been started on the dummy video & audio drivers. Gives back the exit code
+    int startHeadless(const int frames, const int level)
+    {
+        _headless = true;
+        _headless_frames = std::max(1, frames);
+        _level = std::clamp(level, 0, static_cast<int>(_levels.size()) - 1);
+        if (!Init())
+        {
+            std::cerr << "GAME::ERROR Failed to initialize!" << std::endl;
+            return 1;
+        }
+        if (!loadMedia())
+        {
+            std::cerr << "GAME::ERROR Failed to load media!\n";
+            return 1;
+        }
+        std::cout << "Running " << _headless_frames << " headless frames from level " << _level + 1 << "...\n";
+        _FrameStats.reserve(_headless_frames);
+        run();
+        _FrameStats.report();
+        return 0;
+    }
+
     void Close()
     {
         delete _WaterManager;
         delete _LavaManager;
         _TexMan.free();
+        _HUD.free();
+        _Background.free();
         std::cout << "Closing\n";
         SDL_DestroyRenderer(_Renderer);
         std::cout << "Destroyed renderer!\n";
@@ -128,7 +176,7 @@ public:
     {
         std::cout << "Initializing...\n";
         bool success {true};
-        _Window = SDL_CreateWindow("Defblade", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, WINDOW_WIDTH, WINDOW_HEIGHT, SDL_WINDOW_SHOWN | SDL_WINDOW_RESIZABLE);
+        _Window = SDL_CreateWindow("Defblade", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, WINDOW_WIDTH, WINDOW_HEIGHT, _headless ? SDL_WINDOW_HIDDEN : SDL_WINDOW_SHOWN | SDL_WINDOW_RESIZABLE);
         if (_Window == NULL)
         {
             std::cout << "INIT::ERROR Failed to create SDL_Window! SDL_Error: " << SDL_GetError() << '\n';
@@ -148,13 +196,15 @@ public:
                 success = false;
             }
         }
-        _Renderer = SDL_CreateRenderer(_Window, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
+        // headless draws on the CPU into the dummy window's surface, and shouldn't wait on a vsync there isn't
+        const Uint32 rendererFlags{static_cast<Uint32>(_headless ? SDL_RENDERER_SOFTWARE | SDL_RENDERER_TARGETTEXTURE : SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC)};
+        _Renderer = SDL_CreateRenderer(_Window, -1, rendererFlags);
         if (_Renderer == NULL)
         {
             std::cout << "INIT::ERROR Failed to create SDL_Renderer! SDL_Error: " << SDL_GetError() << '\n';
             success = false;
         } else {
-            SDL_SetRenderDrawColor(_Renderer, 0x00, 0x00, 0x00, SDL_ALPHA_OPAQUE);
+            RenderState::setDrawColor(_Renderer, 0x00, 0x00, 0x00, SDL_ALPHA_OPAQUE);
         }
         if( Mix_OpenAudio( 22050, MIX_DEFAULT_FORMAT, 2, 4096 ) == -1 )
         {
@@ -186,8 +236,163 @@ public:
         std::cout << "loaded water!\n";
         _LavaManager->loadFromFile(path.c_str());
         std::cout << "loaded lava\n";
+        _CellFluid.loadFromFile(path.c_str(), _World);
+        _FluidIndex.build(_WaterManager, _LavaManager, &_CellFluid);
+        _FlowField.init(_World);
         _CoinManager.free();
         setPlayerSpawnPos(path.c_str());
+        buildTriggers();
+    }
+
+    void buildTriggers()
+    {
+        _Triggers.clear();
+        _PlayerTriggers.clear();
+        std::vector<Spring*>& springs{_World.getSprings()};
+        for (std::size_t i{0}; i < springs.size(); ++i)
+        {
+            SDL_Rect volume{*springs[i]->getRect()};
+            volume.y -= SPRING_TRAVEL;
+            volume.h += SPRING_TRAVEL * 2;
+            _Triggers.add(TriggerType::SPRING, volume, static_cast<uint32_t>(i));
+        }
+        for (std::size_t i{0}; i < _WaterManager->getWater().size(); ++i)
+        {
+            _Triggers.add(TriggerType::WATER, *_WaterManager->getWater()[i]->getRect(), static_cast<uint32_t>(i));
+        }
+        for (std::size_t i{0}; i < _LavaManager->getLava().size(); ++i)
+        {
+            _Triggers.add(TriggerType::LAVA, *_LavaManager->getLava()[i]->getRect(), static_cast<uint32_t>(i));
+        }
+        const int bob{static_cast<int>(PORTAL_BOB)};
+        _Triggers.add(TriggerType::PORTAL, SDL_Rect{static_cast<int>(_portal_pos.x), static_cast<int>(_portal_pos.y) - bob, 13, 21 + bob * 2}, 0);
+    }
+
+    // sounds, particles, coins & shockwaves for everything posted this frame. Each sound only plays once
+    // however many times it happened, and bursts & shockwaves stop once the frame's budget is spent.
+    // the player's own effects always play
+    void playEvents()
+    {
+        int bursts{EVENT_BURST_BUDGET};
+        int waves{EVENT_SHOCKWAVE_BUDGET};
+        std::array<bool, GAME_EVENT_TYPES> played{};
+        std::array<bool, ENTITY_TYPES> hurt_played{}; // the recipes' own hurt sounds
+        for (const GameEvent& event : _Events.getEvents())
+        {
+            const bool first{!played[static_cast<std::size_t>(event.type)]};
+            played[static_cast<std::size_t>(event.type)] = true;
+            switch (event.type)
+            {
+                case GameEventType::ENTITY_HURT:
+                {
+                    const EntityRecipe& recipe{getRecipe(event.entity)};
+                    if (first)
+                    {
+                        _TexMan.playDamageSound();
+                    }
+                    if (recipe.hurt_sound != nullptr && !hurt_played[static_cast<std::size_t>(event.entity)])
+                    {
+                        (_TexMan.*recipe.hurt_sound).play();
+                        hurt_played[static_cast<std::size_t>(event.entity)] = true;
+                    }
+                    if (bursts > 0)
+                    {
+                        _EMManager.getManager(event.entity)->playBurst(recipe.hurt, event.pos);
+                        --bursts;
+                    }
+                    break;
+                }
+                case GameEventType::ENTITY_DIED:
+                {
+                    if (first)
+                    {
+                        _TexMan.SFX_death_0.play();
+                    }
+                    if (bursts > 0)
+                    {
+                        _EMManager.getManager(event.entity)->playBurst(getRecipe(event.entity).death, event.pos);
+                        --bursts;
+                    }
+                    int num{(std::rand() % 10) + 5};
+                    for (int j{0}; j < num; ++j)
+                    {
+                        _CoinManager.addCoin(event.pos, {Util::random() * 2.0 - 1.0, Util::random() * -2.0});
+                    }
+                    if (waves > 0)
+                    {
+                        _ShockWaveManager.addShockWave(event.pos);
+                        --waves;
+                    }
+                    break;
+                }
+                case GameEventType::ENTITY_STOMPED:
+                    if (first)
+                    {
+                        _TexMan.SFX_turtle.play();
+                    }
+                    break;
+                case GameEventType::PLAYER_HURT:
+                    _Player.playEffect(event);
+                    break;
+                case GameEventType::PLAYER_DIED:
+                    _Player.playEffect(event);
+                    _ShockWaveManager.addShockWave(event.pos);
+                    break;
+                default:
+                    break;
+            }
+        }
+        _Events.clear();
+    }
+
+    // springs, water, lava & the portal, from the triggers the player is in this frame.
+    // portal_y is where the portal has floated to, returns true if the player is touching it
+    bool handleTriggers(const double portal_y)
+    {
+        _Triggers.update(*_Player.getRect(), _PlayerTriggers);
+        bool in_water{false};
+        bool bounced{false};
+        bool portal{false};
+        for (const TriggerHit& hit : _PlayerTriggers.hits)
+        {
+            if (hit.event == TriggerEvent::EXIT)
+            {
+                continue;
+            }
+            const Trigger& trigger{_Triggers.get(hit.trigger)};
+            switch (trigger.type)
+            {
+                case TriggerType::SPRING:
+                {
+                    // springs move, so check where it actually is. Only one launches you
+                    Spring* spring{_World.getSprings()[trigger.index]};
+                    if (_Player.getAd() > 120 && !bounced && Util::checkCollision(_Player.getRect(), spring->getRect()))
+                    {
+                        _Player.bounce(spring, &_TexMan);
+                        bounced = true;
+                    }
+                    break;
+                }
+                case TriggerType::WATER:
+                    in_water = true;
+                    break;
+                case TriggerType::LAVA:
+                    _LavaManager->getLava()[trigger.index]->handlePlayer(&_TexMan, &_Player);
+                    break;
+                case TriggerType::PORTAL:
+                {
+                    SDL_Rect portalRect{static_cast<int>(_portal_pos.x), static_cast<int>(portal_y), 13, 21};
+                    portal = portal || Util::checkCollision(_Player.getRect(), &portalRect);
+                    break;
+                }
+                default:
+                    break;
+            }
+        }
+        // the cell fluid moves about, so it can't be a trigger
+        in_water = in_water || _CellFluid.isWet(*_Player.getRect());
+        _Player.updateWater(in_water, &_TexMan);
+        return portal;
     }
 
     void setPlayerSpawnPos(const char* path)
@@ -233,7 +438,11 @@ public:
         
         _Music = &(_TexMan.MUS_Menu);
         //loadLevel(0);
-        _StarManager.setTex(&(_TexMan.lightTex));
+        if (!_Background.load(_TexMan, _Renderer, BACKGROUND_STARS | BACKGROUND_MOON))
+        {
+            std::cout << "Failed to load the background!\n";
+            success = false;
+        }
 
         _CoinManager.setTex(&(_TexMan.coin), &(_TexMan.lightTex));
 
@@ -275,11 +484,16 @@ public:
         float last_damaged{100.0f};
 
         double last_coin{0.0};
+        double portal_time{0.0}; // frames @ 60fps, for the bob
 
         double fade{static_cast<double>(_Height * 3)};
         bool fading{false};
         bool changing{false};
         do {
+            if (_headless)
+            {
+                _FrameStats.startFrame();
+            }
             while (SDL_PollEvent(&e) != 0)
             {
                 if (e.type == SDL_QUIT)
@@ -328,8 +542,7 @@ public:
                             controller->setControl(Control::RIGHT, true);
                             break;
                         case SDLK_p:
-                            //Entity* _Entity = new Entity{{static_cast<double>(std::rand() % 100 + 50), 20.0}, {0.0, 0.0}, {8, 8}, 0.2, false, "default"};
-                            //_EMManager.addEntity(_Entity);
+                            //_EMManager.addEntity(EntityType::DEFAULT, {static_cast<double>(std::rand() % 100 + 50), 20.0});
                             //fading = !fading;
                             _ShockWaveManager.addShockWave(_Player.getCenter());
                             break;
@@ -399,13 +612,19 @@ public:
                 }
             }
 
+            if (_headless)
+            {
+                applyHeadlessInput(_FrameStats.getFrames());
+            }
+
             SDL_GetWindowPosition(_Window, &windowX, &windowY);
             // calculate dt
             // timer.getTicks() and last_time are both Uint32 so must cast to float
             // divide by 1000.0f to convert from millis to sec
             // times by 60 for 60fps
             // reset last_time
-            time_step = timer.getTicks() / 1000.0 * 60.0 * slomo;
+            // headless always steps one 60fps frame, however long the last one took
+            time_step = _headless ? slomo : timer.getTicks() / 1000.0 * 60.0 * slomo;
             time_step = std::min(time_step, 3.0);
             timer.start();
 
@@ -413,10 +632,10 @@ public:
             // set screen as render target
             _Screen.setAsRenderTarget(_Renderer);
             // clear screen (0x1f, 0x24, 0x4b)
-            SDL_SetRenderDrawColor(_Renderer, 0x00, 0x00, 0x00, 0xFF);
+            RenderState::setDrawColor(_Renderer, 0x00, 0x00, 0x00, 0xFF);
             SDL_RenderClear(_Renderer);
 
-            SDL_SetRenderDrawBlendMode(_Renderer, SDL_BLENDMODE_NONE);
+            RenderState::setDrawBlendMode(_Renderer, SDL_BLENDMODE_NONE);
 
             // SDL_Rect stretchRect{0, 0, _Width, _Height};
             // SDL_RenderCopyEx(_Renderer, _TexMan.black.getTexture(), NULL, &stretchRect, 0, NULL, SDL_FLIP_NONE);
@@ -425,12 +644,15 @@ public:
             vec2<double> player_pos{_Player.getCenter()};
             if (_Player.getAd() > 120)
             {
-                scroll.x += (player_pos.x - static_cast<double>(_Width) / 2.0 - scroll.x) / 40.0 * time_step;
+                // lead a bit the way the player is facing, but not past a wall
+                const double lead_dir{_Player.getFlipped() ? -1.0 : 1.0};
+                const RayHit lead{_World.raycast(Ray{player_pos, {lead_dir, 0.0}, CAMERA_LEAD})};
+                scroll.x += (player_pos.x + lead_dir * lead.distance - static_cast<double>(_Width) / 2.0 - scroll.x) / 40.0 * time_step;
                 scroll.y += (player_pos.y - static_cast<double>(_Height) / 2.0 - scroll.y) / 50.0 * time_step;
             }
             scroll.x = std::max(static_cast<double>(TILE_SIZE), std::min(scroll.x, static_cast<double>(LEVEL_WIDTH * CHUNK_SIZE * TILE_SIZE - TILE_SIZE - _Width)));
             scroll.y = std::max(0.0, std::min(scroll.y, static_cast<double>(LEVEL_HEIGHT * CHUNK_SIZE * TILE_SIZE - _Height)));
-            _Player.update(time_step, _World, &screen_shake, &_TexMan, _ShockWaveManager);
+            _Player.update(time_step, _World, &screen_shake, &_TexMan, _Events);
             if (_Player.getAd() == 0 && !changing)
             {
                 _TexMan.SFX_death_0.play();
@@ -445,15 +667,33 @@ public:
                 _TexMan.SFX_money_gain.play();
             }
             _Player.tickAd(time_step);
+            // off the time steps, not the wall clock, so a headless run touches it on the same frames anywhere
+            portal_time += time_step;
+            const double portal_y{_portal_pos.y + std::sin(portal_time / 60.0) * PORTAL_BOB};
+            const bool touching_portal{handleTriggers(portal_y)};
+
+            // the player goes in first, entities & coins add themselves as they update
+            _Broadphase.clear();
+            _Broadphase.add(*_Player.getRect(), BODY_PLAYER);
+            if (_Player.getAttacking())
+            {
+                _Broadphase.add(_Player.getAttackRect(), BODY_ATTACK);
+            }
 
-            _EMManager.update(time_step, _World, &screen_shake, &_Player, &slomo, &_TexMan, &_CoinManager, _ShockWaveManager);
+            const SDL_Rect view{static_cast<int>(scroll.x), static_cast<int>(scroll.y), _Width, _Height};
+            _FlowField.update(_Player.getCenter());
+            _EMManager.update(time_step, _World, &screen_shake, &_Player, &slomo, _Events, &_FluidIndex, &_FlowField, view, _Broadphase);
+            playEvents();
+            if (_headless)
+            {
+                _FrameStats.split();
+            }
             // do rendering here
 
             screen_shake = std::max(0.0, screen_shake - time_step);
             vec2<int> render_scroll{static_cast<int>(scroll.x + Util::random() * screen_shake - screen_shake / 2.0), static_cast<int>(scroll.y + Util::random() * screen_shake - screen_shake / 2.0)};
 
-            _StarManager.update(time_step, render_scroll.x, render_scroll.y, _Width, _Height, _Renderer);
-            _TexMan.moon.render(_Width - 32, 32, _Renderer);
+            _Background.render(time_step, render_scroll.x, render_scroll.y, _Width, _Height, _Batch);
 
             // _TexMan.black.setAlpha(150);
             // _TexMan.black.setBlendMode(SDL_BLENDMODE_BLEND);
@@ -461,9 +701,12 @@ public:
 
             // fairly obvious what this does
             _World.handleSprings(time_step);
-            _World.render(render_scroll.x, render_scroll.y, _Window, _Renderer, &_TexMan, _Width, _Height);
-            _World.handleGrass(render_scroll.x, render_scroll.y, _Renderer, &_TexMan, _Width, _Height, _Player.getRect(), time_step);
-            _EMManager.render(render_scroll.x, render_scroll.y, _Renderer, time_step, &_World, &_TexMan);
+            _World.render(render_scroll.x, render_scroll.y, _Window, _Batch, &_TexMan, _Width, _Height);
+            _World.handleGrass(render_scroll.x, render_scroll.y, _Batch, &_TexMan, _Width, _Height, _Broadphase, time_step);
+            _EMManager.render(render_scroll.x, render_scroll.y, _Width, _Height, _Batch);
+            // particles & the player go over everything so far
+            _Batch.flush(_Renderer);
+            _EMManager.updateParticles(time_step, render_scroll.x, render_scroll.y, _Renderer, &_World, &_TexMan);
             // check if the player is not dead. ad stands for 'after death'
             if (_Player.getAd() > 120)
                 _Player.render(render_scroll.x, render_scroll.y, _Renderer);
@@ -475,9 +718,8 @@ public:
             last_damaged += 0.03f;
 
             // handle portal
-            _TexMan.portalTex.render(static_cast<int>(_portal_pos.x) - render_scroll.x, static_cast<int>(_portal_pos.y + std::sin(fpsTimer.getTicks() * 0.001) * 4.0) - render_scroll.y, _Renderer);
-            SDL_Rect portalRect{static_cast<int>(_portal_pos.x), static_cast<int>(_portal_pos.y + std::sin(fpsTimer.getTicks() * 0.001) * 4.0), 13, 21};
-            if (Util::checkCollision(_Player.getRect(), &portalRect))
+            _Batch.draw(_TexMan.portalTex, SpriteLayer::PORTAL, static_cast<int>(_portal_pos.x) - render_scroll.x, static_cast<int>(portal_y) - render_scroll.y);
+            if (touching_portal)
             {
                 if (!changing)
                 {
@@ -489,38 +731,25 @@ public:
                 }
             }
 
-            _World.updateLeaves(time_step, render_scroll.x, render_scroll.y, _Width, _Height, &_TexMan, _Renderer);
+            _World.updateLeaves(time_step, render_scroll.x, render_scroll.y, _Width, _Height, &_TexMan, _Batch);
+            _Batch.flush(_Renderer);
             _Player.updateParticles(time_step, render_scroll.x, render_scroll.y, _Renderer, &_World, &_TexMan);
             // for testing
-            _CoinManager.update(time_step, render_scroll.x, render_scroll.y, _Renderer, &_World, &_TexMan, _Player.getRect(), last_coin);
-            _WaterManager->update(time_step, render_scroll.x, render_scroll.y, _Renderer, &_TexMan, &_Player);
-            _LavaManager->update(time_step, render_scroll.x, render_scroll.y, _Renderer, &_TexMan, &_Player);
-            _ShockWaveManager.update(time_step, render_scroll.x, render_scroll.y, _Renderer);
+            _CoinManager.update(time_step, render_scroll.x, render_scroll.y, _Batch, &_World, &_TexMan, _Broadphase, last_coin, &_FluidIndex);
+            _Batch.flush(_Renderer);
+            _CoinManager.updateSparks(time_step, render_scroll.x, render_scroll.y, _Renderer, &_TexMan);
+            _WaterManager->update(time_step, render_scroll.x, render_scroll.y, _Width, _Height, _Renderer, &_TexMan, &_Player);
+            _LavaManager->update(time_step, render_scroll.x, render_scroll.y, _Width, _Height, _Renderer, &_TexMan, &_Player);
+            _CellFluid.update(time_step, render_scroll.x, render_scroll.y, _Width, _Height, _Renderer, &_TexMan, &_Player);
+            _FluidIndex.updateParticles(time_step, render_scroll.x, render_scroll.y, _Renderer, &_World, &_TexMan);
+            _ShockWaveManager.update(time_step, render_scroll.x, render_scroll.y, _Batch);
+            _Batch.flush(_Renderer);
 
             _playerHealth += (_Player.getHealth() - _playerHealth) * 0.12 * time_step;
             if (_Player.getHealth() == _Player.getMaxHealth())
             {
                 _playerHealth = _Player.getHealth();
             }
-            SDL_Rect uiRect{0, 0, _Width, 14};
-            SDL_SetRenderDrawColor(_Renderer, 0x1f, 0x24, 0x4b, 0xFF);
-            SDL_RenderFillRect(_Renderer, &uiRect);
-            SDL_SetRenderDrawColor(_Renderer, 0xF6, 0xe7, 0x9c, 0xFF);
-            SDL_RenderDrawLine(_Renderer, 0, 14, _Width, 14);
-            renderPlayerHealthBar();
-            if (last_damaged < 10.0f)
-            {
-                float offset {last_damaged * last_damaged};
-                SDL_Rect alert{2 - static_cast<int>(offset), 2 - static_cast<int>(offset), _Width - 4 + static_cast<int>(offset) * 2, _Height - 4 + static_cast<int>(offset) * 2};
-                SDL_SetRenderDrawBlendMode(_Renderer, SDL_BLENDMODE_BLEND);
-                SDL_SetRenderDrawColor(_Renderer, 0xFF, 0x00, 0x00, static_cast<int>(255.0 - _Player.getHealth() / _Player.getMaxHealth() * 200.0));
-                SDL_RenderDrawRect(_Renderer, &alert);
-                SDL_SetRenderDrawColor(_Renderer, 0xFF, 0xFF, 0xFF, static_cast<int>(255.0 - _Player.getHealth() / _Player.getMaxHealth() * 200.0));
-                alert = SDL_Rect{1 - static_cast<int>(offset), 1 - static_cast<int>(offset), _Width - 2 + static_cast<int>(offset) * 2, _Height - 2 + static_cast<int>(offset) * 1};
-                SDL_RenderDrawRect(_Renderer, &alert);
-                SDL_SetRenderDrawBlendMode(_Renderer, SDL_BLENDMODE_NONE);
-            }
-
             // Just testing lol
             // SDL_Color col{0x00, 0xaa, 0xFF, 0xaa};
             // std::vector<SDL_Vertex> vertices
@@ -537,15 +766,6 @@ public:
             // render screen
             SDL_SetRenderTarget(_Renderer, NULL);
             _Screen.renderClean(0, 0, _Renderer, 3);
-            Texture fontTex{};
-            std::stringstream text{};
-            text << static_cast<int>(_playerHealth);
-            text << "/";
-            text << static_cast<int>(_Player.getMaxHealth());
-            fontTex.loadFromRenderedText(text.str().c_str(), {0xF6, 0xe7, 0x9c, 0xFF}, _TexMan.baseFontBold, _Renderer);
-            fontTex.render(110, 10, _Renderer);
-            std::stringstream score{};
-            score << "$" << _CoinManager.getScore();
 
             last_coin += (0.0 - last_coin) * 0.01 * time_step;
 
@@ -555,8 +775,23 @@ public:
             SDL_Color moneyBlend{Util::lerpColor(moneyBaseColor, moneyRedColor, std::abs(std::min(0.0, last_coin)))};
             SDL_Color moneyColor{Util::lerpColor(moneyBlend, moneyGreenColor, std::max(0.0, last_coin))};
 
-            fontTex.loadFromRenderedText(score.str().c_str(), moneyColor, _TexMan.baseFontBold, _Renderer);
-            fontTex.render(static_cast<int>((double)_Width * 3.0 / 2.0), 10, _Renderer);
+            _HUD.update(getHUDState(), _Renderer, _TexMan, _Batch);
+            _HUD.render(_Renderer, _TexMan, _Batch, _CoinManager.getScore(), moneyColor);
+            // the damage flash changes every frame so it's drawn straight on top, in screen px like before
+            SDL_RenderSetScale(_Renderer, static_cast<float>(HUD_SCALE), static_cast<float>(HUD_SCALE));
+            if (last_damaged < 10.0f)
+            {
+                float offset {last_damaged * last_damaged};
+                SDL_Rect alert{2 - static_cast<int>(offset), 2 - static_cast<int>(offset), _Width - 4 + static_cast<int>(offset) * 2, _Height - 4 + static_cast<int>(offset) * 2};
+                RenderState::setDrawBlendMode(_Renderer, SDL_BLENDMODE_BLEND);
+                RenderState::setDrawColor(_Renderer, 0xFF, 0x00, 0x00, static_cast<int>(255.0 - _Player.getHealth() / _Player.getMaxHealth() * 200.0));
+                SDL_RenderDrawRect(_Renderer, &alert);
+                RenderState::setDrawColor(_Renderer, 0xFF, 0xFF, 0xFF, static_cast<int>(255.0 - _Player.getHealth() / _Player.getMaxHealth() * 200.0));
+                alert = SDL_Rect{1 - static_cast<int>(offset), 1 - static_cast<int>(offset), _Width - 2 + static_cast<int>(offset) * 2, _Height - 2 + static_cast<int>(offset) * 1};
+                SDL_RenderDrawRect(_Renderer, &alert);
+                RenderState::setDrawBlendMode(_Renderer, SDL_BLENDMODE_NONE);
+            }
+            SDL_RenderSetScale(_Renderer, 1.0f, 1.0f);
 
             if (fading)
             {
@@ -565,7 +800,7 @@ public:
                 fade = std::max(-10.0, std::min(static_cast<double>(_Height) * 3.0 + 10.0, fade - time_step * static_cast<double>(_Height * 3) / 60.0));
             }
             SDL_Rect fadeRect{0, 0, _Width * 3, static_cast<int>(fade)};
-            SDL_SetRenderDrawColor(_Renderer, 0x1f, 0x24, 0x4b, 0xFF);
+            RenderState::setDrawColor(_Renderer, 0x1f, 0x24, 0x4b, 0xFF);
             SDL_RenderFillRect(_Renderer, &fadeRect);
 
             if (changing)
@@ -580,7 +815,7 @@ public:
                     _Player.setHealth(_Player.getMaxHealth());
                     if (checkWin())
                     {
-                        bool play_again{win()};
+                        bool play_again{_headless ? false : win()};
                         running = false;
                         return play_again;
                     }
@@ -589,17 +824,23 @@ public:
 
             std::stringstream levelText{};
             levelText << "Level " << _level + 1;
-            fontTex.loadFromRenderedText(levelText.str().c_str(), {0xF6, 0xe7, 0x9c, 0xFF}, _TexMan.baseFontBold, _Renderer);
-            fontTex.render(static_cast<int>((double)_Width * 3.0 / 2.0) - fontTex.getWidth() / 2, std::min(_Height * 3 / 2, static_cast<int>(fade) - 32), _Renderer);
+            _TexMan.baseTextBold.drawCentered(_Batch, SpriteLayer::TEXT, levelText.str(), static_cast<int>((double)_Width * 3.0 / 2.0), std::min(_Height * 3 / 2, static_cast<int>(fade) - 32), {0xF6, 0xe7, 0x9c, 0xFF});
+            _Batch.flush(_Renderer);
 
             SDL_RenderPresent(_Renderer);
+            RenderState::endFrame();
+            if (_headless)
+            {
+                _FrameStats.endFrame(RenderState::getIssued(), RenderState::getElided());
+                running = _FrameStats.getFrames() < _headless_frames;
+            }
 
             float avgFPS {frames / (fpsTimer.getTicks() / 1000.0f)};
             setWindowTitle(avgFPS); 
             ++frames;
             if (_CoinManager.getScore() < 0)
             {
-                bool play_again{gameover()};
+                bool play_again{_headless ? false : gameover()};
                 running = false;
                 return play_again;
             }
@@ -608,6 +849,24 @@ public:
         return false;
     }
 
+    // the scripted session's presses, done the same way the keys do them
+    void applyHeadlessInput(const int frame)
+    {
+        const HeadlessInput input{getHeadlessInput(frame)};
+        Controller* controller {_Player.getController()};
+        controller->setControl(Control::LEFT, input.left);
+        controller->setControl(Control::RIGHT, input.right);
+        if (input.up && !(controller->getControl(Control::UP)))
+        {
+            controller->setJumping(0.0);
+        }
+        controller->setControl(Control::UP, input.up);
+        if (input.attack)
+        {
+            _Player.attackSword(&_TexMan);
+        }
+    }
+
     void setWindowTitle(float avgFPS)
     {
         std::stringstream caption;
@@ -615,21 +874,16 @@ public:
         SDL_SetWindowTitle(_Window, caption.str().c_str());
     }
 
-    void renderPlayerHealthBar()
+    HUDState getHUDState()
     {
-        _TexMan.playerHealthBar.render(2, 3, _Renderer, nullptr);
         SDL_Color greenDark{0x32, 0x6b, 0x64, 0xFF};
         SDL_Color greenLight{0x60, 0xae, 0x7b, 0xFF};
         SDL_Color redDark{0xa8, 0x60, 0x5d, 0xFF};
         SDL_Color redLight{0xd1, 0xa7, 0x7e, 0xFF};
         SDL_Color lightColor {Util::lerpColor(redLight, greenLight, _playerHealth / _Player.getMaxHealth())};
         SDL_Color darkColor {Util::lerpColor(redDark, greenDark, _playerHealth / _Player.getMaxHealth())};
-        SDL_SetRenderDrawColor(_Renderer, lightColor.r, lightColor.g, lightColor.b, 0xFF);
-        SDL_Rect fillRect = SDL_Rect{5, 5, static_cast<int>(26.0 * _playerHealth / _Player.getMaxHealth()), 2};
-        SDL_RenderFillRect(_Renderer, &fillRect);
-        SDL_SetRenderDrawColor(_Renderer, darkColor.r, darkColor.g, darkColor.b, 0xFF);
-        fillRect = SDL_Rect{5, 7, static_cast<int>(26.0 * _playerHealth / _Player.getMaxHealth()), 2};
-        SDL_RenderFillRect(_Renderer, &fillRect);
+        return HUDState{static_cast<int>(_playerHealth), static_cast<int>(_Player.getMaxHealth()), static_cast<int>(26.0 * _playerHealth / _Player.getMaxHealth()),
+                        lightColor, darkColor, _Width, _Height};
     }
 
     bool checkWin()
@@ -742,7 +996,7 @@ public:
             _Screen.setAsRenderTarget(_Renderer);
 
             // clear screen (0x1f, 0x24, 0x4b)
-            SDL_SetRenderDrawColor(_Renderer, 0x00, 0x00, 0x00, 0xFF);
+            RenderState::setDrawColor(_Renderer, 0x00, 0x00, 0x00, 0xFF);
             SDL_RenderClear(_Renderer);
             
             if (!logo_shown)
@@ -797,14 +1051,15 @@ public:
             SDL_SetRenderTarget(_Renderer, NULL);
             _Screen.renderClean(0, 0, _Renderer, 3);
 
-            _PopUpManager.update(time_step, _Renderer, _TexMan.baseFontBold);
+            _PopUpManager.update(time_step, _Batch, _TexMan.baseTextBold);
 
-            Texture fontTex{};
             double faded{static_cast<double>(std::min(static_cast<Uint32>(5000), animTimer.getTicks())) / 5000.0};
-            fontTex.loadFromRenderedText("A game by @snej55", SDL_Color{static_cast<Uint8>(static_cast<int>(faded * 246.0)), static_cast<Uint8>(static_cast<int>(faded * 231.0)), static_cast<Uint8>(static_cast<int>(faded * 156.0)), 0xFF}, _TexMan.baseFontBold, _Renderer);
-            fontTex.render(static_cast<int>((double)_Width * 3.0 / 2.0) - fontTex.getWidth() / 2, _Height * 3 - 50, _Renderer);
+            const SDL_Color textColor{static_cast<Uint8>(static_cast<int>(faded * 246.0)), static_cast<Uint8>(static_cast<int>(faded * 231.0)), static_cast<Uint8>(static_cast<int>(faded * 156.0)), 0xFF};
+            _TexMan.baseTextBold.drawCentered(_Batch, SpriteLayer::TEXT, "A game by @snej55", static_cast<int>((double)_Width * 3.0 / 2.0), _Height * 3 - 50, textColor);
+            _Batch.flush(_Renderer);
 
             SDL_RenderPresent(_Renderer);
+            RenderState::endFrame();
             handleVolume();
         } while (running);
         _TexMan.SFX_portal_0.play();
@@ -908,7 +1163,7 @@ public:
             _Screen.setAsRenderTarget(_Renderer);
 
             // clear screen (0x1f, 0x24, 0x4b)
-            SDL_SetRenderDrawColor(_Renderer, 0x00, 0x00, 0x00, 0xFF);
+            RenderState::setDrawColor(_Renderer, 0x00, 0x00, 0x00, 0xFF);
             SDL_RenderClear(_Renderer);
             
             if (play_shown)
@@ -927,21 +1182,19 @@ public:
             SDL_SetRenderTarget(_Renderer, NULL);
             _Screen.renderClean(0, 0, _Renderer, 3);
 
-            Texture fontTex{};
             double faded{static_cast<double>(std::min(static_cast<Uint32>(5000), animTimer.getTicks())) / 5000.0};
-            fontTex.loadFromRenderedText("A game by that guy -> @snej55", SDL_Color{static_cast<Uint8>(static_cast<int>(faded * 246.0)), static_cast<Uint8>(static_cast<int>(faded * 231.0)), static_cast<Uint8>(static_cast<int>(faded * 156.0)), 0xFF}, _TexMan.baseFontBold, _Renderer);
-            fontTex.render(static_cast<int>((double)_Width * 3.0 / 2.0) - fontTex.getWidth() / 2, _Height * 3 - 50, _Renderer);
+            const SDL_Color textColor{static_cast<Uint8>(static_cast<int>(faded * 246.0)), static_cast<Uint8>(static_cast<int>(faded * 231.0)), static_cast<Uint8>(static_cast<int>(faded * 156.0)), 0xFF};
+            _TexMan.baseTextBold.drawCentered(_Batch, SpriteLayer::TEXT, "A game by that guy -> @snej55", static_cast<int>((double)_Width * 3.0 / 2.0), _Height * 3 - 50, textColor);
 
-            fontTex.loadFromRenderedText("Uh oh. You have $0 left.", SDL_Color{static_cast<Uint8>(static_cast<int>(faded * 246.0)), static_cast<Uint8>(static_cast<int>(faded * 231.0)), static_cast<Uint8>(static_cast<int>(faded * 156.0)), 0xFF}, _TexMan.baseFontBold, _Renderer);
-            fontTex.render(static_cast<int>((double)_Width * 3.0 / 2.0) - fontTex.getWidth() / 2, 50, _Renderer);
+            _TexMan.baseTextBold.drawCentered(_Batch, SpriteLayer::TEXT, "Uh oh. You have $0 left.", static_cast<int>((double)_Width * 3.0 / 2.0), 50, textColor);
 
-            fontTex.loadFromRenderedText("GAME OVER!", SDL_Color{static_cast<Uint8>(static_cast<int>(faded * 246.0)), static_cast<Uint8>(static_cast<int>(faded * 231.0)), static_cast<Uint8>(static_cast<int>(faded * 156.0)), 0xFF}, _TexMan.baseFontBold, _Renderer);
-            fontTex.render(static_cast<int>((double)_Width * 3.0 / 2.0) - fontTex.getWidth() / 2, 80, _Renderer);
+            _TexMan.baseTextBold.drawCentered(_Batch, SpriteLayer::TEXT, "GAME OVER!", static_cast<int>((double)_Width * 3.0 / 2.0), 80, textColor);
 
-            fontTex.loadFromRenderedText("Play again?", SDL_Color{static_cast<Uint8>(static_cast<int>(faded * 246.0)), static_cast<Uint8>(static_cast<int>(faded * 231.0)), static_cast<Uint8>(static_cast<int>(faded * 156.0)), 0xFF}, _TexMan.baseFontBold, _Renderer);
-            fontTex.render(static_cast<int>((double)_Width * 3.0 / 2.0) - fontTex.getWidth() / 2, 150, _Renderer);
+            _TexMan.baseTextBold.drawCentered(_Batch, SpriteLayer::TEXT, "Play again?", static_cast<int>((double)_Width * 3.0 / 2.0), 150, textColor);
+            _Batch.flush(_Renderer);
 
             SDL_RenderPresent(_Renderer);
+            RenderState::endFrame();
             handleVolume();
         } while (running);
         return playAgain;
@@ -1037,7 +1290,7 @@ public:
             _Screen.setAsRenderTarget(_Renderer);
 
             // clear screen (0x1f, 0x24, 0x4b)
-            SDL_SetRenderDrawColor(_Renderer, 0x00, 0x00, 0x00, 0xFF);
+            RenderState::setDrawColor(_Renderer, 0x00, 0x00, 0x00, 0xFF);
             SDL_RenderClear(_Renderer);
             
             if (play_shown)
@@ -1056,23 +1309,20 @@ public:
             SDL_SetRenderTarget(_Renderer, NULL);
             _Screen.renderClean(0, 0, _Renderer, 3);
 
-            Texture fontTex{};
             double faded{static_cast<double>(std::min(static_cast<Uint32>(5000), animTimer.getTicks())) / 5000.0};
-            fontTex.loadFromRenderedText("A game by @snej55", SDL_Color{static_cast<Uint8>(static_cast<int>(faded * 246.0)), static_cast<Uint8>(static_cast<int>(faded * 231.0)), static_cast<Uint8>(static_cast<int>(faded * 156.0)), 0xFF}, _TexMan.baseFontBold, _Renderer);
-            fontTex.render(static_cast<int>((double)_Width * 3.0 / 2.0) - fontTex.getWidth() / 2, _Height * 3 - 50, _Renderer);
+            const SDL_Color textColor{static_cast<Uint8>(static_cast<int>(faded * 246.0)), static_cast<Uint8>(static_cast<int>(faded * 231.0)), static_cast<Uint8>(static_cast<int>(faded * 156.0)), 0xFF};
+            _TexMan.baseTextBold.drawCentered(_Batch, SpriteLayer::TEXT, "A game by @snej55", static_cast<int>((double)_Width * 3.0 / 2.0), _Height * 3 - 50, textColor);
 
-            fontTex.loadFromRenderedText("'Imagine dying.'.", SDL_Color{static_cast<Uint8>(static_cast<int>(faded * 246.0)), static_cast<Uint8>(static_cast<int>(faded * 231.0)), static_cast<Uint8>(static_cast<int>(faded * 156.0)), 0xFF}, _TexMan.baseFontBold, _Renderer);
-            fontTex.render(static_cast<int>((double)_Width * 3.0 / 2.0) - fontTex.getWidth() / 2, 50, _Renderer);
-            fontTex.loadFromRenderedText(" - @snej55 c. 2025", SDL_Color{static_cast<Uint8>(static_cast<int>(faded * 246.0)), static_cast<Uint8>(static_cast<int>(faded * 231.0)), static_cast<Uint8>(static_cast<int>(faded * 156.0)), 0xFF}, _TexMan.baseFontBold, _Renderer);
-            fontTex.render(static_cast<int>((double)_Width * 3.0 / 2.0) - fontTex.getWidth() / 2 + 20, 70, _Renderer);
+            _TexMan.baseTextBold.drawCentered(_Batch, SpriteLayer::TEXT, "'Imagine dying.'.", static_cast<int>((double)_Width * 3.0 / 2.0), 50, textColor);
+            _TexMan.baseTextBold.drawCentered(_Batch, SpriteLayer::TEXT, " - @snej55 c. 2025", static_cast<int>((double)_Width * 3.0 / 2.0) + 20, 70, textColor);
 
-            fontTex.loadFromRenderedText("You Win! (Underwhelming I know right)", SDL_Color{static_cast<Uint8>(static_cast<int>(faded * 246.0)), static_cast<Uint8>(static_cast<int>(faded * 231.0)), static_cast<Uint8>(static_cast<int>(faded * 156.0)), 0xFF}, _TexMan.baseFontBold, _Renderer);
-            fontTex.render(static_cast<int>((double)_Width * 3.0 / 2.0) - fontTex.getWidth() / 2, 100, _Renderer);
+            _TexMan.baseTextBold.drawCentered(_Batch, SpriteLayer::TEXT, "You Win! (Underwhelming I know right)", static_cast<int>((double)_Width * 3.0 / 2.0), 100, textColor);
 
-            fontTex.loadFromRenderedText("Play again?", SDL_Color{static_cast<Uint8>(static_cast<int>(faded * 246.0)), static_cast<Uint8>(static_cast<int>(faded * 231.0)), static_cast<Uint8>(static_cast<int>(faded * 156.0)), 0xFF}, _TexMan.baseFontBold, _Renderer);
-            fontTex.render(static_cast<int>((double)_Width * 3.0 / 2.0) - fontTex.getWidth() / 2, 150, _Renderer);
+            _TexMan.baseTextBold.drawCentered(_Batch, SpriteLayer::TEXT, "Play again?", static_cast<int>((double)_Width * 3.0 / 2.0), 150, textColor);
+            _Batch.flush(_Renderer);
 
             SDL_RenderPresent(_Renderer);
+            RenderState::endFrame();
             handleVolume();
         } while (running);
         return playAgain;
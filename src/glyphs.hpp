@@ -0,0 +1,175 @@
+#ifndef GLYPHS_H
+#define GLYPHS_H
+
+#include "SDL2/SDL.h"
+#include "SDL2/SDL_ttf.h"
+
+#include "./texture.hpp"
+#include "./atlas.hpp"
+#include "./spritebatch.hpp"
+
+#include <iostream>
+#include <array>
+#include <algorithm>
+#include <vector>
+#include <string_view>
+
+// printable ASCII, anything else draws as '?'
+inline constexpr char GLYPH_FIRST{' '};
+inline constexpr char GLYPH_LAST{'~'};
+inline constexpr std::size_t GLYPH_COUNT{static_cast<std::size_t>(GLYPH_LAST - GLYPH_FIRST + 1)};
+
+struct Glyph
+{
+    SDL_Rect src; // on the page, empty for ones with nothing to draw (space)
+    int advance; // px to the next glyph
+};
+
+// every glyph of one font at one size rendered once, white, onto a page. Text is then laid out from
+// the glyph metrics & drawn through a SpriteBatch, coloured by the vertex colours, so changing text
+// costs nothing but quads
+class GlyphAtlas
+{
+private:
+    Texture _Page{};
+    std::array<Glyph, GLYPH_COUNT> _Glyphs{};
+    int _height{0};
+    int _line_skip{0};
+
+    const Glyph& getGlyph(const char c) const
+    {
+        const char g{c >= GLYPH_FIRST && c <= GLYPH_LAST ? c : '?'};
+        return _Glyphs[static_cast<std::size_t>(g - GLYPH_FIRST)];
+    }
+
+public:
+    GlyphAtlas()
+    {
+    }
+
+    ~GlyphAtlas()
+    {
+        free();
+    }
+
+    void free()
+    {
+        _Page.free();
+        _Glyphs = {};
+        _height = 0;
+        _line_skip = 0;
+    }
+
+    bool build(TTF_Font* font, SDL_Renderer* renderer)
+    {
+        free();
+        if (font == nullptr)
+        {
+            std::cout << "GLYPHATLAS::BUILD No font!\n";
+            return false;
+        }
+        _height = TTF_FontHeight(font);
+        _line_skip = TTF_FontLineSkip(font);
+
+        std::array<SDL_Surface*, GLYPH_COUNT> surfaces{};
+        std::vector<SDL_Point> sizes{};
+        for (std::size_t i{0}; i < GLYPH_COUNT; ++i)
+        {
+            const Uint16 c{static_cast<Uint16>(GLYPH_FIRST + i)};
+            int advance{0};
+            TTF_GlyphMetrics(font, c, NULL, NULL, NULL, NULL, &advance);
+            _Glyphs[i].advance = advance;
+            // the surface is the glyph's whole cell, laid out like a one letter string
+            surfaces[i] = TTF_RenderGlyph_Solid(font, c, SDL_Color{0xFF, 0xFF, 0xFF, 0xFF});
+            sizes.push_back(surfaces[i] != NULL ? SDL_Point{surfaces[i]->w, surfaces[i]->h} : SDL_Point{0, 0});
+        }
+
+        AtlasPacker packer{};
+        std::vector<AtlasPlacement> placements{};
+        packer.pack(sizes, ATLAS_PAGE_SIZE, placements);
+        bool success{packer.getPages() == 1};
+        if (success)
+        {
+            const SDL_Point size{packer.getPageSize(0)};
+            SDL_Surface* page{SDL_CreateRGBSurfaceWithFormat(0, size.x, size.y, 32, SDL_PIXELFORMAT_ARGB8888)};
+            if (page == NULL)
+            {
+                std::cout << "GLYPHATLAS::BUILD Unable to create page surface! SDL_Error: " << SDL_GetError() << '\n';
+                success = false;
+            } else {
+                SDL_FillRect(page, NULL, SDL_MapRGBA(page->format, 0, 0, 0, 0));
+                for (std::size_t i{0}; i < GLYPH_COUNT; ++i)
+                {
+                    if (surfaces[i] != NULL && placements[i].page == 0)
+                    {
+                        _Glyphs[i].src = placements[i].rect;
+                        SDL_Rect dst{placements[i].rect};
+                        SDL_BlitSurface(surfaces[i], NULL, page, &dst);
+                    }
+                }
+                success = _Page.loadFromSurface(page, renderer);
+                SDL_FreeSurface(page);
+            }
+        } else {
+            std::cout << "GLYPHATLAS::BUILD Glyphs don't fit on one page!\n";
+        }
+
+        for (SDL_Surface* surface : surfaces)
+        {
+            SDL_FreeSurface(surface);
+        }
+        return success;
+    }
+
+    int getHeight() const {return _height;}
+
+    // px wide the longest line of text would be
+    int measure(const std::string_view text) const
+    {
+        int width{0};
+        int line{0};
+        for (const char c : text)
+        {
+            if (c == '\n')
+            {
+                line = 0;
+                continue;
+            }
+            line += getGlyph(c).advance;
+            width = std::max(width, line);
+        }
+        return width;
+    }
+
+    // x, y is the top left of the first line, same as rendering the text to a texture & drawing that
+    void draw(SpriteBatch& batch, const SpriteLayer layer, const std::string_view text, const int x, const int y, const SDL_Color color)
+    {
+        _Page.setColor(color.r, color.g, color.b);
+        _Page.setAlpha(color.a);
+        int pen_x{x};
+        int pen_y{y};
+        for (const char c : text)
+        {
+            if (c == '\n')
+            {
+                pen_x = x;
+                pen_y += _line_skip;
+                continue;
+            }
+            const Glyph& glyph{getGlyph(c)};
+            if (glyph.src.w > 0)
+            {
+                batch.draw(_Page, layer, SDL_Rect{pen_x, pen_y, glyph.src.w, glyph.src.h}, &glyph.src);
+            }
+            pen_x += glyph.advance;
+        }
+    }
+
+    // centred on center_x
+    void drawCentered(SpriteBatch& batch, const SpriteLayer layer, const std::string_view text, const int center_x, const int y, const SDL_Color color)
+    {
+        draw(batch, layer, text, center_x - measure(text) / 2, y, color);
+    }
+};
+
+#endif
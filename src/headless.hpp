@@ -0,0 +1,113 @@
+#ifndef HEADLESS_H
+#define HEADLESS_H
+
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <numeric>
+
+// Defblade --headless [frames] [level]: no display, no GPU & no sound. SDL's dummy video driver, the
+// software renderer without vsync, a fixed time step & scripted input, so runs on different builds &
+// machines play much the same session and their frame times can be compared
+
+inline constexpr int HEADLESS_DEFAULT_FRAMES{1800}; // 30s of game time
+
+// what's held down on a frame of the scripted session
+struct HeadlessInput
+{
+    bool left;
+    bool right;
+    bool up; // jumps when it goes down, higher the longer it's held
+    bool attack; // swings when true
+};
+
+// runs right the whole way, hopping every so often & swinging the sword, with a short turn back every
+// ten seconds so the camera & parallax go both ways
+inline HeadlessInput getHeadlessInput(const int frame)
+{
+    const bool back{frame % 600 >= 540};
+    return HeadlessInput{back, !back, frame % 45 < 15, frame % 20 == 10};
+}
+
+// per frame times, split into simulating (input to events played) & rendering (to the present)
+class FrameStats
+{
+private:
+    using Clock = std::chrono::steady_clock;
+
+    std::vector<double> _Sim{};
+    std::vector<double> _Render{};
+    Clock::time_point _start{};
+    Clock::time_point _split{};
+    long _state_issued{0};
+    long _state_elided{0};
+
+    static double getMs(const Clock::time_point from, const Clock::time_point to)
+    {
+        return std::chrono::duration<double, std::milli>(to - from).count();
+    }
+
+    static void report(const char* name, std::vector<double> times)
+    {
+        if (times.empty())
+        {
+            return;
+        }
+        std::sort(times.begin(), times.end());
+        const auto percentile = [&](const double p)
+        {
+            return times[std::min(times.size() - 1, static_cast<std::size_t>(p * static_cast<double>(times.size())))];
+        };
+        const double mean{std::accumulate(times.begin(), times.end(), 0.0) / static_cast<double>(times.size())};
+        std::cout << "headless: " << name << " mean " << mean << "ms, min " << times.front() << "ms, p50 " << percentile(0.5)
+                  << "ms, p95 " << percentile(0.95) << "ms, p99 " << percentile(0.99) << "ms, max " << times.back() << "ms\n";
+    }
+
+public:
+    FrameStats()
+    {
+    }
+
+    void reserve(const int frames)
+    {
+        _Sim.reserve(frames);
+        _Render.reserve(frames);
+    }
+
+    void startFrame() {_start = Clock::now();}
+    // simulation's done, the rest of the frame is rendering
+    void split() {_split = Clock::now();}
+
+    // state_issued/elided are the RenderState counts for the frame just presented
+    void endFrame(const int state_issued, const int state_elided)
+    {
+        const Clock::time_point end{Clock::now()};
+        _Sim.push_back(getMs(_start, _split));
+        _Render.push_back(getMs(_split, end));
+        _state_issued += state_issued;
+        _state_elided += state_elided;
+    }
+
+    int getFrames() const {return static_cast<int>(_Sim.size());}
+
+    void report() const
+    {
+        const int frames{getFrames()};
+        if (frames == 0)
+        {
+            std::cout << "headless: no frames run\n";
+            return;
+        }
+        std::vector<double> total(_Sim.size());
+        std::transform(_Sim.begin(), _Sim.end(), _Render.begin(), total.begin(), [](const double sim, const double render) {return sim + render;});
+        const double seconds{std::accumulate(total.begin(), total.end(), 0.0) / 1000.0};
+        std::cout << "headless: " << frames << " frames in " << seconds << "s, " << static_cast<double>(frames) / seconds << " fps\n";
+        report("frame ", total);
+        report("sim   ", _Sim);
+        report("render", _Render);
+        std::cout << "headless: " << _state_issued / frames << " render state changes sent a frame, " << _state_elided / frames << " dropped\n";
+    }
+};
+
+#endif
@@ -4,6 +4,7 @@
 #include "./vec2.hpp"
 #include "./util.hpp"
 #include "./texman.hpp"
+#include "./spritebatch.hpp"
 
 class EntityHealthBar
 {
@@ -11,7 +12,6 @@ private:
     Texture* _tex;
     vec2<int> _dimensions;
     double _maxHealth;
-    double _health{0.0};
     SDL_Color _greenDark{0x32, 0x6b, 0x64, 0xFF};
     SDL_Color _greenLight{0x60, 0xae, 0x7b, 0xFF};
     SDL_Color _redDark{0xa8, 0x60, 0x5d, 0xFF};
@@ -21,12 +21,11 @@ private:
 public:
     EntityHealthBar(Texture* tex, vec2<int> dimensions, const double maxHealth);
 
-    void update(void* entity);
-
     void setDimensions(vec2<int> dimensions);
     void setOffset(vec2<int> offset);
 
-    void render(const int scrollX, const int scrollY, SDL_Renderer* renderer, void* entity);
+    // pos is the top left of the entity the bar floats over
+    void render(const int scrollX, const int scrollY, SpriteBatch& batch, const vec2<double>& pos, const double health);
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,127 @@
+#ifndef HUD_H
+#define HUD_H
+
+#include "SDL2/SDL.h"
+
+#include "./texture.hpp"
+#include "./texman.hpp"
+#include "./spritebatch.hpp"
+
+#include <string>
+
+inline constexpr int HUD_SCALE{3}; // the screen gets blown up this much onto the window
+inline constexpr int HUD_HEIGHT{15}; // screen px, the bar & the line under it
+
+// everything the retained part of the top bar shows. The HUD only redraws when one of these changes
+struct HUDState
+{
+    int health; // the number shown, not the bar
+    int max_health;
+    int bar; // px of the health bar filled
+    SDL_Color bar_light;
+    SDL_Color bar_dark;
+    int width; // screen size
+    int height;
+};
+
+// the top bar, health bar & health text, kept in its own target texture at window size and copied
+// over the screen each frame. Anything that changes most frames (the money, which flashes for a few
+// seconds after every coin, the damage flash, the level name) is still drawn straight on top
+class HUD
+{
+private:
+    Texture _Layer{};
+    HUDState _State{};
+    bool _valid{false};
+    int _redraws{0};
+
+    static bool sameColor(const SDL_Color a, const SDL_Color b)
+    {
+        return a.r == b.r && a.g == b.g && a.b == b.b && a.a == b.a;
+    }
+
+    static bool sameState(const HUDState& a, const HUDState& b)
+    {
+        return a.health == b.health && a.max_health == b.max_health && a.bar == b.bar && sameColor(a.bar_light, b.bar_light) && sameColor(a.bar_dark, b.bar_dark)
+               && a.width == b.width && a.height == b.height;
+    }
+
+    void redraw(const HUDState& state, SDL_Renderer* renderer, TexMan& texman, SpriteBatch& batch)
+    {
+        SDL_Texture* target{SDL_GetRenderTarget(renderer)};
+        _Layer.setAsRenderTarget(renderer);
+
+        // the bar & health bar are drawn as they would be on the screen, blown up
+        SDL_Rect uiRect{0, 0, state.width * HUD_SCALE, (HUD_HEIGHT - 1) * HUD_SCALE};
+        RenderState::setDrawColor(renderer, 0x1f, 0x24, 0x4b, 0xFF);
+        SDL_RenderFillRect(renderer, &uiRect);
+        RenderState::setDrawColor(renderer, 0xF6, 0xe7, 0x9c, 0xFF);
+        SDL_Rect line{0, (HUD_HEIGHT - 1) * HUD_SCALE, state.width * HUD_SCALE, HUD_SCALE};
+        SDL_RenderFillRect(renderer, &line);
+        texman.playerHealthBar.render(2 * HUD_SCALE, 3 * HUD_SCALE, renderer, 0.0, NULL, SDL_FLIP_NONE, NULL, HUD_SCALE);
+        RenderState::setDrawColor(renderer, state.bar_light.r, state.bar_light.g, state.bar_light.b, 0xFF);
+        SDL_Rect fillRect{5 * HUD_SCALE, 5 * HUD_SCALE, state.bar * HUD_SCALE, 2 * HUD_SCALE};
+        SDL_RenderFillRect(renderer, &fillRect);
+        RenderState::setDrawColor(renderer, state.bar_dark.r, state.bar_dark.g, state.bar_dark.b, 0xFF);
+        fillRect = SDL_Rect{5 * HUD_SCALE, 7 * HUD_SCALE, state.bar * HUD_SCALE, 2 * HUD_SCALE};
+        SDL_RenderFillRect(renderer, &fillRect);
+
+        // text is at window res
+        texman.baseTextBold.draw(batch, SpriteLayer::TEXT, std::to_string(state.health) + "/" + std::to_string(state.max_health), 110, 10, {0xF6, 0xe7, 0x9c, 0xFF});
+        batch.flush(renderer);
+
+        SDL_SetRenderTarget(renderer, target);
+        ++_redraws;
+    }
+
+public:
+    HUD()
+    {
+    }
+
+    void free()
+    {
+        _Layer.free();
+        _valid = false;
+    }
+
+    // redraws the layer if anything it shows changed, gives back whether it had to
+    bool update(const HUDState& state, SDL_Renderer* renderer, TexMan& texman, SpriteBatch& batch)
+    {
+        if (_valid && sameState(state, _State))
+        {
+            return false;
+        }
+        if (!_valid || state.width != _State.width)
+        {
+            if (!_Layer.createBlank(state.width * HUD_SCALE, HUD_HEIGHT * HUD_SCALE, renderer, SDL_TEXTUREACCESS_TARGET))
+            {
+                std::cout << "HUD::UPDATE Failed to create the HUD layer!\n";
+                _valid = false;
+                return false;
+            }
+        }
+        redraw(state, renderer, texman, batch);
+        _State = state;
+        _valid = true;
+        return true;
+    }
+
+    // one copy over the top of the window, then the money on top of that. money flashes red or green
+    // as it goes & comes
+    void render(SDL_Renderer* renderer, TexMan& texman, SpriteBatch& batch, const int score, const SDL_Color money)
+    {
+        if (!_valid)
+        {
+            return;
+        }
+        _Layer.renderClean(0, 0, renderer);
+        texman.baseTextBold.draw(batch, SpriteLayer::TEXT, "$" + std::to_string(score), _State.width * HUD_SCALE / 2, 10, money);
+        batch.flush(renderer);
+    }
+
+    // how many times the layer's been redrawn, for checking it isn't every frame
+    int getRedraws() const {return _redraws;}
+};
+
+#endif
@@ -2,18 +2,25 @@
 #define LEAF_H
 
 #include "./texman.hpp"
-#include "./anim.hpp"
+#include "./spritebatch.hpp"
 #include "./vec2.hpp"
 #include "./util.hpp"
+#include "./constants.hpp"
 
 #include <vector>
 #include <array>
+#include <algorithm>
 
+inline constexpr int LEAF_FRAMES{17};
+inline constexpr double LEAF_ANIM_SPEED{0.1};
+inline constexpr int LEAF_SIZE{8};
+
+// leaves are plain values in one pool, the animation is just a frame counter
 struct Leaf
 {
     vec2<double> pos;
     vec2<double> vel;
-    Anim* anim;
+    double frame;
     bool solid{false};
 };
 
@@ -26,8 +33,13 @@ struct LeafSpawner
 class LeafManager
 {
 private:
-    std::vector<Leaf*> _leaves{};
+    std::vector<Leaf> _leaves{};
     std::vector<LeafSpawner> _spawn_rects{};
+    std::vector<std::vector<int>> _Buckets{std::vector<std::vector<int>>(LEVEL_WIDTH * LEVEL_HEIGHT)}; // spawner indices, by the chunk the rect starts in
+
+    // reused every frame
+    std::vector<int> _Visible{};
+    std::vector<double> _Area{}; // running total of visible spawner area
 
     std::array<std::array<double, 2>, 3> _wind {{
         {0.0, 10.0},
@@ -38,6 +50,7 @@ private:
 public:
     LeafManager()
     {
+        _leaves.reserve(256);
     }
 
     ~LeafManager()
@@ -47,29 +60,70 @@ public:
 
     void free()
     {
-        for (std::size_t i{0}; i < _leaves.size(); ++i)
-        {
-            Leaf* leaf = _leaves[i];
-            if (leaf != nullptr)
-            {
-                delete leaf->anim;
-                delete leaf;
-                _leaves[i] = nullptr;
-            }
-        }
         _leaves.clear();
         _spawn_rects.clear();
+        for (std::vector<int>& bucket : _Buckets)
+        {
+            bucket.clear();
+        }
     }
 
     void loadRects(std::vector<LeafSpawner>& rects)
     {
         for (std::size_t i{0}; i < rects.size(); ++i)
         {
+            const int chunkX{std::max(0, std::min(LEVEL_WIDTH - 1, rects[i].rect.x / (TILE_SIZE * CHUNK_SIZE)))};
+            const int chunkY{std::max(0, std::min(LEVEL_HEIGHT - 1, rects[i].rect.y / (TILE_SIZE * CHUNK_SIZE)))};
+            _Buckets[chunkY * LEVEL_WIDTH + chunkX].push_back(static_cast<int>(_spawn_rects.size()));
             _spawn_rects.push_back(rects[i]);
         }
     }
 
-    void update(const double& time_step, const int scrollX, const int scrollY, const int width, const int height, TexMan* texman, SDL_Renderer* renderer)
+    void spawnLeaves(const double& time_step, const SDL_Rect& screen_rect, const double average_gust)
+    {
+        // only look at the chunks around the screen, one extra up & left for rects that start outside it
+        constexpr int chunk_px{TILE_SIZE * CHUNK_SIZE};
+        const int x0{std::max(0, static_cast<int>(std::floor(static_cast<double>(screen_rect.x) / chunk_px)) - 1)};
+        const int y0{std::max(0, static_cast<int>(std::floor(static_cast<double>(screen_rect.y) / chunk_px)) - 1)};
+        const int x1{std::min(LEVEL_WIDTH - 1, (screen_rect.x + screen_rect.w) / chunk_px)};
+        const int y1{std::min(LEVEL_HEIGHT - 1, (screen_rect.y + screen_rect.h) / chunk_px)};
+
+        _Visible.clear();
+        _Area.clear();
+        double total{0.0};
+        for (int y{y0}; y <= y1; ++y)
+        {
+            for (int x{x0}; x <= x1; ++x)
+            {
+                for (const int i : _Buckets[y * LEVEL_WIDTH + x])
+                {
+                    if (Util::checkCollision(&(_spawn_rects[i].rect), &screen_rect))
+                    {
+                        total += static_cast<double>(_spawn_rects[i].rect.w * _spawn_rects[i].rect.h);
+                        _Visible.push_back(i);
+                        _Area.push_back(total);
+                    }
+                }
+            }
+        }
+        if (_Visible.empty())
+        {
+            return;
+        }
+
+        // each spawner used to roll area * gust / 20000 every frame, so that's the expected number of leaves
+        const int num{Util::poisson(total * average_gust * 0.15 * time_step / 20000.0)};
+        for (int n{0}; n < num; ++n)
+        {
+            // bigger spawners get picked more often
+            const std::size_t pick{static_cast<std::size_t>(std::upper_bound(_Area.begin(), _Area.end(), Util::random() * total) - _Area.begin())};
+            const LeafSpawner& spawner{_spawn_rects[_Visible[std::min(pick, _Visible.size() - 1)]]};
+            vec2<double> pos{static_cast<double>(spawner.rect.x) + Util::random() * static_cast<double>(spawner.rect.w), static_cast<double>(spawner.rect.y) + Util::random() * static_cast<double>(spawner.rect.h)};
+            _leaves.push_back(Leaf{pos, {-0.1, 0.2}, static_cast<double>(static_cast<int>(Util::random() * 15.0)), spawner.solid});
+        }
+    }
+
+    void update(const double& time_step, const int scrollX, const int scrollY, const int width, const int height, TexMan* texman, SpriteBatch& batch)
     {
         // wind? wrote this ages ago
         double average_gust{0.0};
@@ -86,47 +140,32 @@ public:
         average_gust *= 0.5;
 
         SDL_Rect screen_rect{scrollX - 64, scrollY - 64, width + 128, height + 128};
-        for (std::size_t i{0}; i < _spawn_rects.size(); ++i)
-        {
-            // don't ask
-            LeafSpawner spawner{_spawn_rects[i]};
-            if (Util::random() * 20000.0 / (average_gust * 0.15) / time_step < static_cast<double>(spawner.rect.w * spawner.rect.h))
-            {
-                if (Util::checkCollision(&(spawner.rect), &screen_rect))
-                {
-                    vec2<double> pos{static_cast<double>(spawner.rect.x) + Util::random() * static_cast<double>(spawner.rect.w), static_cast<double>(spawner.rect.y) + Util::random() * static_cast<double>(spawner.rect.h)};
-                    Leaf* leaf{new Leaf{pos, {-0.1, 0.2}, new Anim{8, 8, 17, 0.1, false, &(texman->leafTex)}, spawner.solid}};
-                    leaf->anim->setFrame(static_cast<int>(Util::random() * 15.0));
-                    _leaves.push_back(leaf);
-                }
-            }
-        }
+        spawnLeaves(time_step, screen_rect, average_gust);
 
         // update the leaves
-        for (std::size_t i{0}; i < _leaves.size(); ++i)
+        texman->leafTex.setBlendMode(SDL_BLENDMODE_BLEND);
+        for (std::size_t i{0}; i < _leaves.size();)
         {
-            Leaf* leaf{_leaves[i]};
-            if (leaf != nullptr)
+            Leaf& leaf{_leaves[i]};
+            leaf.pos.x += leaf.vel.x * time_step;
+            leaf.pos.y += leaf.vel.y * time_step;
+            leaf.pos.x += std::sin(leaf.frame * 0.08) * 0.8 * time_step - 0.5 * time_step * average_gust * 0.1;
+            leaf.vel.y = std::min(0.2, leaf.vel.y + 0.005 / (average_gust * 0.1) * time_step);
+            leaf.frame += LEAF_ANIM_SPEED * time_step;
+            if (leaf.frame > static_cast<double>(LEAF_FRAMES))
             {
-                leaf->pos.x += leaf->vel.x * time_step;
-                leaf->pos.y += leaf->vel.y * time_step;
-                leaf->pos.x += std::sin(leaf->anim->getFrame() * 0.08) * 0.8 * time_step - 0.5 * time_step * average_gust * 0.1;
-                leaf->vel.y = std::min(0.2, leaf->vel.y + 0.005 / (average_gust * 0.1) * time_step);
-                leaf->anim->tick(time_step);
-                leaf->anim->getTex()->setAlpha(static_cast<Uint8>(static_cast<int>((17.0 - leaf->anim->getFrame()) / 17.0 * 255.0)));
-                leaf->anim->getTex()->setBlendMode(SDL_BLENDMODE_BLEND);
-                leaf->anim->render(static_cast<int>(leaf->pos.x), static_cast<int>(leaf->pos.y), scrollX, scrollY, renderer);
-                if (leaf->anim->getFinished())
-                {
-                    delete leaf->anim;
-                    delete leaf;
-                    _leaves[i] = nullptr;
-                }
+                // order doesn't matter, so swap with the last one instead of shifting everything down
+                leaf = _leaves.back();
+                _leaves.pop_back();
+                continue;
             }
+            const int step{std::min(static_cast<int>(leaf.frame), LEAF_FRAMES - 1)};
+            texman->leafTex.setAlpha(static_cast<Uint8>(static_cast<int>((17.0 - leaf.frame) / 17.0 * 255.0)));
+            SDL_Rect clip{step * LEAF_SIZE, 0, LEAF_SIZE, LEAF_SIZE};
+            batch.draw(texman->leafTex, SpriteLayer::LEAVES, static_cast<int>(leaf.pos.x) - scrollX, static_cast<int>(leaf.pos.y) - scrollY, &clip);
+            ++i;
         }
-        // black magic
-        _leaves.erase(std::remove_if(_leaves.begin(), _leaves.end(), [](Leaf* leaf){return (leaf == nullptr);}), _leaves.end());
     }
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -34,6 +34,20 @@ bool ParticleSpawner::isDead(Particle* particle)
     return particle->size < 0.1;
 }
 
+void ParticleSpawner::addParticles(vec2<double> pos, int num, vec2<double> vel, vec2<double> spread, SDL_Color color)
+{
+    for (std::size_t i{0}; i < _total && num > 0; ++i)
+    {
+        Particle* particle {_particles[i]};
+        if (particle == nullptr || isDead(particle))
+        {
+            delete particle;
+            _particles[i] = new Particle{pos, vec2<double>{vel.x + Util::random() * spread.x - spread.x / 2.0, vel.y + Util::random() * spread.y - spread.y / 2.0}, 5.0, color};
+            --num;
+        }
+    }
+}
+
 void ParticleSpawner::updateParticle(Particle* particle, const double& time_step, World* world)
 {
     particle->vel.y += _gravity * time_step;
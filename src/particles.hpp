@@ -65,6 +65,9 @@ public:
 
     bool isDead(Particle* particle);
 
+    // spawn a burst right away at pos, instead of waiting for update() to use _pos
+    void addParticles(vec2<double> pos, int num, vec2<double> vel, vec2<double> spread, SDL_Color color);
+
     void updateParticle(Particle* particle, const double& time_step, World* world);
     void renderParticle(Particle* particle, const int scrollX, const int scrollY, SDL_Renderer* renderer, TexMan* texman);
 
@@ -20,10 +20,6 @@ Player::~Player()
 
 void Player::free()
 {
-    delete _idleAnim;
-    delete _runAnim;
-    delete _jumpAnim;
-    delete _landAnim;
     if (_Sword != nullptr)
     {
         delete _Sword;
@@ -44,12 +40,9 @@ void Player::reset()
 
 void Player::loadAnim(TexMan* texman)
 {
-    _idleAnim = new Anim{8, 8, 5, 0.16, true, &(texman->playerIdle)};
-    _runAnim = new Anim{8, 8, 5, 0.3, true, &(texman->playerRun)};
-    _jumpAnim = new Anim{8, 8, 2, 0.2, true, &(texman->playerJump)};
-    _landAnim = new Anim{8, 8, 5, 0.2, false, &(texman->playerLand)};
+    _texman = texman;
     _flash = &(texman->playerFlash);
-    _anim = _idleAnim;
+    setClip(PLAYER_IDLE);
     _Sword = new Sword(this, texman);
 }
 
@@ -83,58 +76,65 @@ vec2<double> Player::getCenter()
     return {_pos.x + _dimensions.x / 2.0, _pos.y + _dimensions.y / 2.0};
 }
 
-void Player::damage(double amount, double* screen_shake, double* slomo, ShockWaveManager& shockwaves)
+void Player::damage(double amount, double* screen_shake, double* slomo, EventQueue& events)
 {
     // we can add buffs later
     if (_recover > _recover_time + 30)
     {
         *screen_shake = std::max(*screen_shake, 8.0);
         _health -= amount;
-        _Particles.setPos(getCenter());
-        _Smoke.setPos(getCenter());
-        _Fire.setPos(getCenter());
-        _Particles.setSpawning(16, {4.0, 4.0}, _Palette[0]);
-        int num{(std::rand() % 10) + 15};
-        for (int i{0}; i < num; ++i)
-        {
-            _SparkManager.addSpark(new Spark{getCenter(), Util::random() * M_PI * 2.0, Util::random() * 3.0 + 1.0});
-        }
+        events.post(GameEventType::PLAYER_HURT, getCenter());
         //_Smoke.setSpawning(2, {1, 2}, {0x88, 0x88, 0x88});
         _recover = 0.0;
         *slomo = std::min(0.7, *slomo);
         if (_health < 0.0)
         {
             *slomo = std::min(0.5, *slomo);
-            die(screen_shake, shockwaves);
+            die(screen_shake, events);
         }
         _should_damage = true;
     }
 }
 
-void Player::die(double* screen_shake, ShockWaveManager& shockwaves)
+void Player::die(double* screen_shake, EventQueue& events)
 {
     _last_pos = _pos;
     _health = _max_health;
     _ad = 0;
-    _Particles.setPos(getCenter());
-    _Smoke.setPos(getCenter());
-    _Fire.setPos(getCenter());
-    _Particles.setSpawning(128, {16.0, 8.0}, _Palette[0]);
-    _Smoke.setSpawning(100, {1, 2}, {0xAA, 0xAA, 0xAA});
-    _Fire.setSpawning(100);
-    shockwaves.addShockWave(getCenter());
-    int num{(std::rand() % 20) + 10};
-    for (int i{0}; i < num; ++i)
-    {
-        _SparkManager.addSpark(new Spark{getCenter(), Util::random() * M_PI * 2.0, Util::random() * 5.0 + 3.0});
-    }
+    events.post(GameEventType::PLAYER_DIED, getCenter());
     _pos = _spawn_pos;
     _rect.x = _pos.x;
     _rect.y = _pos.y;
     *screen_shake = std::max(*screen_shake, 16.0);
 }
 
-void Player::update(const double& time_step, World& world, double* screen_shake, TexMan* texman, ShockWaveManager& shockwaves)
+void Player::playEffect(const GameEvent& event)
+{
+    _Particles.setPos(event.pos);
+    _Smoke.setPos(event.pos);
+    _Fire.setPos(event.pos);
+    if (event.type == GameEventType::PLAYER_HURT)
+    {
+        _Particles.setSpawning(16, {4.0, 4.0}, _Palette[0]);
+        int num{(std::rand() % 10) + 15};
+        for (int i{0}; i < num; ++i)
+        {
+            _SparkManager.addSpark(new Spark{event.pos, Util::random() * M_PI * 2.0, Util::random() * 3.0 + 1.0});
+        }
+    } else if (event.type == GameEventType::PLAYER_DIED)
+    {
+        _Particles.setSpawning(128, {16.0, 8.0}, _Palette[0]);
+        _Smoke.setSpawning(100, {1, 2}, {0xAA, 0xAA, 0xAA});
+        _Fire.setSpawning(100);
+        int num{(std::rand() % 20) + 10};
+        for (int i{0}; i < num; ++i)
+        {
+            _SparkManager.addSpark(new Spark{event.pos, Util::random() * M_PI * 2.0, Util::random() * 5.0 + 3.0});
+        }
+    }
+}
+
+void Player::update(const double& time_step, World& world, double* screen_shake, TexMan* texman, EventQueue& events)
 {
     // add all the timers here
     _swordAttacked += time_step;
@@ -145,7 +145,7 @@ void Player::update(const double& time_step, World& world, double* screen_shake,
     if (_ad > 120)
     {
         updateVel(time_step);
-        handlePhysics(time_step, _vel, world, screen_shake, texman, shockwaves);
+        handlePhysics(time_step, _vel, world, screen_shake, texman, events);
         // updateSword(time_step);
         handleAnim(time_step);
         updateRect();
@@ -171,6 +171,31 @@ void Player::update(const double& time_step, World& world, double* screen_shake,
     }
 }
 
+void Player::bounce(Spring* spring, TexMan* texman)
+{
+    _vel.y = -5;
+    spring->setVel(4.0);
+    texman->SFX_spring.play();
+}
+
+void Player::updateWater(const bool in_water, TexMan* texman)
+{
+    if (in_water)
+    {
+        if (_in_water > 120.0)
+        {
+            texman->SFX_water_in.play();
+        }
+        _in_water = 0.0;
+    } else {
+        if (_in_water > 6.0 && _in_water < 120.0)
+        {
+            texman->SFX_water_out.play();
+            _in_water = 130.0;
+        }
+    }
+}
+
 void Player::updateVel(const double& time_step)
 {
     // x velocity
@@ -214,7 +239,7 @@ void Player::updateVel(const double& time_step)
     _vel.y = std::min(8.0, _vel.y);
 }
 
-void Player::handlePhysics(const double& time_step, vec2<double> frame_movement, World& world, double* screen_shake, TexMan* texman, ShockWaveManager& shockwaves)
+void Player::handlePhysics(const double& time_step, vec2<double> frame_movement, World& world, double* screen_shake, TexMan* texman, EventQueue& events)
 {
     _pos.x += frame_movement.x * time_step;
     _rect.x = _pos.x;
@@ -270,18 +295,6 @@ void Player::handlePhysics(const double& time_step, vec2<double> frame_movement,
 
     _rect.x = _pos.x;
     _rect.y = _pos.y;
-    std::vector<Spring*>& springs {world.getSprings()};
-    for (Spring* spring : springs)
-    {
-        if (Util::checkCollision(&_rect, spring->getRect()))
-        {
-            _vel.y = -5;
-            spring->setVel(4.0);
-            texman->SFX_spring.play();
-            break;
-        }
-    }
-
     // check for danger
     world.getDangerAroundPos(_pos, rects);
     for (int i{0}; i < 9; ++i)
@@ -290,13 +303,13 @@ void Player::handlePhysics(const double& time_step, vec2<double> frame_movement,
         if (Util::checkCollision(&_rect, tile_rect))
         {
             // we died
-            die(screen_shake, shockwaves);
+            die(screen_shake, events);
             return;
         }
     }
     if (_lava_struck)
     {
-        die(screen_shake, shockwaves);
+        die(screen_shake, events);
     }
 }
 
@@ -314,41 +327,35 @@ void Player::updateParticles(const double& time_step, const int scrollX, const i
     }
 }
 
+void Player::setClip(const ClipDef& clip)
+{
+    // switching restarts the clip, staying on it carries on
+    _clip = &clip;
+    _Anim.play(clip.anim);
+}
+
 void Player::handleAnim(const double& time_step)
 {
     if (_falling > 3.0)
     {
-        _anim = _jumpAnim;
-        _runAnim->reset();
-        _idleAnim->reset();
-        _landAnim->reset();
+        setClip(PLAYER_JUMP);
         _grounded = 99.9;
     } else if (_Controller.getControl(Control::RIGHT) || _Controller.getControl(Control::LEFT))
     {
-        _anim = _runAnim;
-        _jumpAnim->reset();
-        _idleAnim->reset();
-        _landAnim->reset();
+        setClip(PLAYER_RUN);
         _grounded = 0.0;
     } else if (_grounded > 3.0)
     {
-        _anim = _landAnim;
-        _jumpAnim->reset();
-        _idleAnim->reset();
-        _runAnim->reset();
-        if (_landAnim->getFinished())
+        setClip(PLAYER_LAND);
+        if (_Anim.getFinished())
         {
             _grounded = 0.0;
         }
     } else {
-        _anim = _idleAnim;
-        _jumpAnim->reset();
-        _runAnim->reset();
-        _landAnim->reset();
+        setClip(PLAYER_IDLE);
         _grounded = 0.0;
     }
-    _anim->tick(time_step);
-    _anim->setFlipped(_flipped ? SDL_FLIP_HORIZONTAL : SDL_FLIP_NONE);
+    _Anim.tick(time_step);
 }
 
 void Player::render(const int scrollX, const int scrollY, SDL_Renderer* renderer)
@@ -384,7 +391,7 @@ void Player::renderPlayer(const int scrollX, const int scrollY, SDL_Renderer* re
     {
         _flash->render((int)_pos.x - 2 - scrollX, (int)_pos.y - scrollY, renderer, 0, NULL, _flipped ? SDL_FLIP_HORIZONTAL : SDL_FLIP_NONE, NULL);    
     } else {
-        _anim->render((int)_pos.x - 2, (int)_pos.y, scrollX, scrollY, renderer);
+        _Anim.render(_texman->*(_clip->texture), (int)_pos.x - 2, (int)_pos.y, scrollX, scrollY, renderer, 0.0, _flipped ? SDL_FLIP_HORIZONTAL : SDL_FLIP_NONE);
     }
 }
 
@@ -10,7 +10,12 @@
 #include "./sparks.hpp"
 #include "./anim.hpp"
 #include "./weapons.hpp"
-#include "./shockwaves.hpp"
+#include "./events.hpp"
+
+inline constexpr ClipDef PLAYER_IDLE{&TexMan::playerIdle, {8, 8, 5, 0.16, true}};
+inline constexpr ClipDef PLAYER_RUN{&TexMan::playerRun, {8, 8, 5, 0.3, true}};
+inline constexpr ClipDef PLAYER_JUMP{&TexMan::playerJump, {8, 8, 2, 0.2, true}};
+inline constexpr ClipDef PLAYER_LAND{&TexMan::playerLand, {8, 8, 5, 0.2, false}};
 
 enum class Control
 {
@@ -73,12 +78,10 @@ private:
     double _recover_time{10.0};
 
     // Animations
-    Anim* _idleAnim;
-    Anim* _runAnim;
-    Anim* _jumpAnim;
-    Anim* _landAnim;
+    TexMan* _texman{nullptr};
+    const ClipDef* _clip{&PLAYER_IDLE}; // clip we render
+    Anim _Anim{PLAYER_IDLE.anim};
     Texture* _flash;
-    Anim* _anim {nullptr}; // animation we render;
 
     double _grounded{99.9};
     bool _flipped{false};
@@ -137,6 +140,9 @@ public:
 
     double getInWater() {return _in_water;}
     void setInWater(double val) {_in_water = val;}
+    // splash sounds going in & out, in_water is whether they're touching any water this frame
+    void updateWater(const bool in_water, TexMan* texman);
+    void bounce(Spring* spring, TexMan* texman);
 
     double getFalling() {return _falling;}
     void setVelY(const double val) {_vel.y = val;}
@@ -156,7 +162,9 @@ public:
     double getRecover() {return _recover;}
     void setRecover(double val) {_recover = val;}
 
-    void damage(double amount, double* screen_shake, double* slomo, ShockWaveManager& shockwaves);
+    void damage(double amount, double* screen_shake, double* slomo, EventQueue& events);
+    // particles & sparks for PLAYER_HURT & PLAYER_DIED, once the game gets round to playing them
+    void playEffect(const GameEvent& event);
 
     double getAd() {return _ad;}
     void setAd(double val) {_ad = val;}
@@ -190,13 +198,14 @@ public:
         _recover += time_step;
     }
 
-    void die(double* screen_shake, ShockWaveManager& shockwaves);
+    void die(double* screen_shake, EventQueue& events);
 
-    void update(const double& time_step, World& world, double* screen_shake, TexMan* texman, ShockWaveManager& shockwaves);
+    void update(const double& time_step, World& world, double* screen_shake, TexMan* texman, EventQueue& events);
     void updateVel(const double& time_step);
-    void handlePhysics(const double& time_step, vec2<double> frame_movement, World& world, double* screen_shake, TexMan* texman, ShockWaveManager& shockwaves);
+    void handlePhysics(const double& time_step, vec2<double> frame_movement, World& world, double* screen_shake, TexMan* texman, EventQueue& events);
     void updateParticles(const double& time_step, const int scrollX, const int scrollY, SDL_Renderer* renderer, World* world, TexMan* tex);
 
+    void setClip(const ClipDef& clip);
     void handleAnim(const double& time_step);
 
     void render(const int scrollX, const int scrollY, SDL_Renderer* renderer);
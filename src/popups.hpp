@@ -49,7 +49,8 @@ public:
         _PopUps.push_back(new PopUp{pos, text});
     }
 
-    void update(const double& time_step, SDL_Renderer* renderer, TTF_Font* font)
+    // text goes on the TEXT layer, so flush the batch after
+    void update(const double& time_step, SpriteBatch& batch, GlyphAtlas& glyphs)
     {
         for (std::size_t i{0}; i < _PopUps.size(); ++i)
         {
@@ -62,9 +63,7 @@ public:
                 if (popup->size >= 1.0)
                 {
                     // render popup
-                    Texture fontTex{};
-                    fontTex.loadFromRenderedText(popup->text.c_str(), SDL_Color{246, 231, 156, static_cast<Uint8>(static_cast<int>(popup->size))}, font, renderer);
-                    fontTex.render(static_cast<int>(popup->pos.x), static_cast<int>(popup->pos.y), renderer);
+                    glyphs.draw(batch, SpriteLayer::TEXT, popup->text, static_cast<int>(popup->pos.x), static_cast<int>(popup->pos.y), SDL_Color{246, 231, 156, static_cast<Uint8>(static_cast<int>(popup->size))});
                 } else {
                     // cleanup
                     delete popup;
@@ -0,0 +1,163 @@
+#ifndef RENDERSTATE_H
+#define RENDERSTATE_H
+
+#include "SDL2/SDL.h"
+
+#include <unordered_map>
+
+// shadows the renderer's draw colour & blend mode and every texture's colour, alpha & blend mode, so
+// setting something to what it already is never reaches SDL (every one of those is a driver call and
+// can break the renderer's own batching). Anything that changes that state has to go through here,
+// or the shadow goes stale. In counting mode it shadows & counts the same but never calls SDL, for the
+// benches, which have no renderer & only stand-in texture pointers
+namespace RenderState
+{
+    struct TextureMods
+    {
+        SDL_Color mod;
+        SDL_BlendMode blend;
+    };
+
+    struct Shadow
+    {
+        SDL_Renderer* renderer{nullptr}; // the one the draw state's for
+        bool color_known{false};
+        bool blend_known{false};
+        SDL_Color color{0, 0, 0, 0};
+        SDL_BlendMode blend{SDL_BLENDMODE_NONE};
+        std::unordered_map<SDL_Texture*, TextureMods> textures{};
+        bool counting{false};
+
+        // this frame so far, and the last whole frame
+        int issued{0};
+        int elided{0};
+        int last_issued{0};
+        int last_elided{0};
+    };
+
+    inline Shadow shadow{};
+
+    inline void checkRenderer(SDL_Renderer* renderer)
+    {
+        if (renderer != shadow.renderer)
+        {
+            shadow.renderer = renderer;
+            shadow.color_known = false;
+            shadow.blend_known = false;
+        }
+    }
+
+    inline void setDrawColor(SDL_Renderer* renderer, const Uint8 r, const Uint8 g, const Uint8 b, const Uint8 a)
+    {
+        checkRenderer(renderer);
+        if (shadow.color_known && shadow.color.r == r && shadow.color.g == g && shadow.color.b == b && shadow.color.a == a)
+        {
+            ++shadow.elided;
+            return;
+        }
+        if (!shadow.counting)
+        {
+            SDL_SetRenderDrawColor(renderer, r, g, b, a);
+        }
+        shadow.color = {r, g, b, a};
+        shadow.color_known = true;
+        ++shadow.issued;
+    }
+
+    inline void setDrawBlendMode(SDL_Renderer* renderer, const SDL_BlendMode blend)
+    {
+        checkRenderer(renderer);
+        if (shadow.blend_known && shadow.blend == blend)
+        {
+            ++shadow.elided;
+            return;
+        }
+        if (!shadow.counting)
+        {
+            SDL_SetRenderDrawBlendMode(renderer, blend);
+        }
+        shadow.blend = blend;
+        shadow.blend_known = true;
+        ++shadow.issued;
+    }
+
+    inline SDL_BlendMode getDrawBlendMode(SDL_Renderer* renderer)
+    {
+        checkRenderer(renderer);
+        if (!shadow.blend_known)
+        {
+            if (!shadow.counting)
+            {
+                SDL_GetRenderDrawBlendMode(renderer, &shadow.blend);
+            }
+            shadow.blend_known = true;
+        }
+        return shadow.blend;
+    }
+
+    // each of colour, alpha & blend is only set if it changed
+    inline void setTextureMods(SDL_Texture* texture, const SDL_Color mod, const SDL_BlendMode blend)
+    {
+        if (texture == nullptr)
+        {
+            return;
+        }
+        const auto [it, added] = shadow.textures.try_emplace(texture, TextureMods{mod, blend});
+        TextureMods& current{it->second};
+        if (added || current.mod.r != mod.r || current.mod.g != mod.g || current.mod.b != mod.b)
+        {
+            if (!shadow.counting)
+            {
+                SDL_SetTextureColorMod(texture, mod.r, mod.g, mod.b);
+            }
+            ++shadow.issued;
+        } else {
+            ++shadow.elided;
+        }
+        if (added || current.mod.a != mod.a)
+        {
+            if (!shadow.counting)
+            {
+                SDL_SetTextureAlphaMod(texture, mod.a);
+            }
+            ++shadow.issued;
+        } else {
+            ++shadow.elided;
+        }
+        if (added || current.blend != blend)
+        {
+            if (!shadow.counting)
+            {
+                SDL_SetTextureBlendMode(texture, blend);
+            }
+            ++shadow.issued;
+        } else {
+            ++shadow.elided;
+        }
+        current = TextureMods{mod, blend};
+    }
+
+    inline void setCounting(const bool counting) {shadow.counting = counting;}
+    inline bool isCounting() {return shadow.counting;}
+
+    // call before destroying a texture, another one could get the same address
+    inline void forget(SDL_Texture* texture)
+    {
+        shadow.textures.erase(texture);
+    }
+
+    // after the frame's presented: keeps its counts for getIssued/getElided & starts again
+    inline void endFrame()
+    {
+        shadow.last_issued = shadow.issued;
+        shadow.last_elided = shadow.elided;
+        shadow.issued = 0;
+        shadow.elided = 0;
+    }
+
+    // state changes that reached SDL & ones dropped for changing nothing, over the last frame
+    inline int getIssued() {return shadow.last_issued;}
+    inline int getElided() {return shadow.last_elided;}
+}
+
+#endif
@@ -4,20 +4,25 @@
 #include "./texture.hpp"
 #include "./vec2.hpp"
 #include "./anim.hpp"
+#include "./spritebatch.hpp"
 
 #include <vector>
+#include <algorithm>
 
+inline constexpr AnimDef SHOCKWAVE_ANIM{24, 24, 6, 0.5, false};
+
+// waves all play SHOCKWAVE_ANIM, so one is just where it is & how far along
 struct ShockWave
 {
     vec2<double> pos;
-    Anim* anim;
+    double frame{0.0};
 };
 
 class ShockWaveManager
 {
 private:
     Texture* _tex;
-    std::vector<ShockWave*> _Waves{};
+    std::vector<ShockWave> _Waves{};
 
 public:
     ShockWaveManager()
@@ -36,16 +41,6 @@ public:
 
     void free()
     {
-        for (std::size_t i{0}; i < _Waves.size(); ++i)
-        {
-            ShockWave* wave{_Waves[i]};
-            if (wave != nullptr)
-            {
-                delete wave->anim;
-                delete wave;
-                _Waves[i] = nullptr;
-            }
-        }
         _Waves.clear();
     }
 
@@ -56,25 +51,20 @@ public:
 
     void addShockWave(vec2<double> pos)
     {
-        Anim* anim{new Anim{24, 24, 6, 0.5, false, _tex}};
-        _Waves.push_back(new ShockWave{{pos.x - 12.0, pos.y - 12.0}, anim});
+        _Waves.push_back(ShockWave{{pos.x - 12.0, pos.y - 12.0}});
     }
 
-    void update(const double& time_step, const int scrollX, const int scrollY, SDL_Renderer* renderer)
+    void update(const double& time_step, const int scrollX, const int scrollY, SpriteBatch& batch)
     {
-        for (std::size_t i{0}; i < _Waves.size(); ++i)
+        const AnimDef& anim{SHOCKWAVE_ANIM};
+        SDL_Point center{anim.width / 2, anim.height / 2};
+        for (ShockWave& wave : _Waves)
         {
-            ShockWave* wave{_Waves[i]};
-            wave->anim->tick(time_step);
-            wave->anim->render(static_cast<int>(wave->pos.x), static_cast<int>(wave->pos.y), scrollX, scrollY, renderer);
-            if (wave->anim->getFinished())
-            {
-                delete wave->anim;
-                delete wave;
-                _Waves[i] = nullptr;
-            }
+            wave.frame += anim.speed * time_step;
+            SDL_Rect clip_rect{anim.getStep(wave.frame) * anim.width, 0, anim.width, anim.height};
+            batch.draw(*_tex, SpriteLayer::EFFECTS, static_cast<int>(wave.pos.x) - scrollX, static_cast<int>(wave.pos.y) - scrollY, &clip_rect, 0.0, &center);
         }
-        _Waves.erase(std::remove_if(_Waves.begin(), _Waves.end(), [](ShockWave* wave){return (wave == nullptr);}), _Waves.end());
+        _Waves.erase(std::remove_if(_Waves.begin(), _Waves.end(), [&](const ShockWave& wave){return anim.isFinished(wave.frame);}), _Waves.end());
     }
 };
 
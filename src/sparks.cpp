@@ -70,7 +70,7 @@ void SparkManager::renderSpark(Spark* spark, const int scrollX, const int scroll
         col, {1.0f, 0.0f}}
     };
     std::vector<int> indices {0, 1, 2, 2, 3, 1}; // indices for quad
-    Polygons::renderPolygon(renderer, _particleTexture->getTexture(), vertices, indices);
+    Polygons::renderPolygon(renderer, _particleTexture->bindTexture(), vertices, indices);
 }
 
 void SparkManager::update(const double& time_step, const int scrollX, const int scrollY, SDL_Renderer* renderer)
@@ -0,0 +1,121 @@
+#ifndef SPATIAL_H
+#define SPATIAL_H
+
+#include "SDL2/SDL.h"
+
+#include <vector>
+#include <algorithm>
+
+// uniform grid over the level, each cell keeps a list of the items overlapping it
+// items are meant to be small handles (indices, pointers), the grid doesn't own them
+template <typename T>
+class SpatialGrid
+{
+private:
+    int _cell_size{64};
+    int _width{0}; // in cells
+    int _height{0};
+    std::vector<std::vector<T>> _Cells{};
+
+    int clampX(const int x) const {return std::max(0, std::min(_width - 1, x));}
+    int clampY(const int y) const {return std::max(0, std::min(_height - 1, y));}
+
+public:
+    SpatialGrid()
+    {
+    }
+
+    SpatialGrid(const int width, const int height, const int cell_size)
+    {
+        init(width, height, cell_size);
+    }
+
+    // width & height in px
+    void init(const int width, const int height, const int cell_size)
+    {
+        _cell_size = cell_size;
+        _width = std::max(1, (width + cell_size - 1) / cell_size);
+        _height = std::max(1, (height + cell_size - 1) / cell_size);
+        _Cells.assign(_width * _height, std::vector<T>{});
+    }
+
+    void clear()
+    {
+        for (std::vector<T>& cell : _Cells)
+        {
+            cell.clear();
+        }
+    }
+
+    bool empty() const
+    {
+        return std::all_of(_Cells.begin(), _Cells.end(), [](const std::vector<T>& cell){return cell.empty();});
+    }
+
+    int getCellSize() const {return _cell_size;}
+
+    // cell a px coordinate falls in, clamped to the grid
+    int cellX(const int x) const {return clampX(x / _cell_size);}
+    int cellY(const int y) const {return clampY(y / _cell_size);}
+
+    void insert(const SDL_Rect& rect, const T& item)
+    {
+        const int x0{clampX(rect.x / _cell_size)};
+        const int y0{clampY(rect.y / _cell_size)};
+        const int x1{clampX((rect.x + rect.w - 1) / _cell_size)};
+        const int y1{clampY((rect.y + rect.h - 1) / _cell_size)};
+        for (int y{y0}; y <= y1; ++y)
+        {
+            for (int x{x0}; x <= x1; ++x)
+            {
+                _Cells[y * _width + x].push_back(item);
+            }
+        }
+    }
+
+    // calls fn(item, cell_x, cell_y) for every entry in the cells overlapping rect. Items spanning several
+    // cells come up once per cell, callers that need them once can use the cell coords to pick one
+    template <typename Fn>
+    void visit(const SDL_Rect& rect, Fn fn) const
+    {
+        const int x0{cellX(rect.x)};
+        const int y0{cellY(rect.y)};
+        const int x1{cellX(rect.x + rect.w - 1)};
+        const int y1{cellY(rect.y + rect.h - 1)};
+        for (int y{y0}; y <= y1; ++y)
+        {
+            for (int x{x0}; x <= x1; ++x)
+            {
+                for (const T& item : _Cells[y * _width + x])
+                {
+                    fn(item, x, y);
+                }
+            }
+        }
+    }
+
+    // appends every item in the cells overlapping rect, items spanning several cells are only added once
+    void query(const SDL_Rect& rect, std::vector<T>& out) const
+    {
+        const std::size_t start{out.size()};
+        const int x0{clampX(rect.x / _cell_size)};
+        const int y0{clampY(rect.y / _cell_size)};
+        const int x1{clampX((rect.x + rect.w - 1) / _cell_size)};
+        const int y1{clampY((rect.y + rect.h - 1) / _cell_size)};
+        for (int y{y0}; y <= y1; ++y)
+        {
+            for (int x{x0}; x <= x1; ++x)
+            {
+                for (const T& item : _Cells[y * _width + x])
+                {
+                    if (std::find(out.begin() + start, out.end(), item) == out.end())
+                    {
+                        out.push_back(item);
+                    }
+                }
+            }
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,261 @@
+#ifndef SPRITEBATCH_H
+#define SPRITEBATCH_H
+
+#include "SDL2/SDL.h"
+
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <array>
+#include <utility>
+#include <cstdint>
+#include <cmath>
+
+#include "./texture.hpp"
+
+// what gets drawn over what within one flush. Inside a layer sprites are grouped by SDL texture,
+// so anything that has to go on top of something else needs a later layer
+enum class SpriteLayer : uint8_t
+{
+    BACKDROP, // the far hills
+    SKY, // stars & the moon
+    CLOUDS,
+    DECOR, // trees & big decor behind the tiles
+    TILES, // tiles & springs
+    GRASS,
+    ENTITY_GLOW,
+    ENTITIES,
+    HEALTH_BARS,
+    PORTAL,
+    LEAVES,
+    COIN_GLOW,
+    COINS,
+    EFFECTS, // shockwaves
+    TEXT,
+    TOTAL
+};
+
+struct Sprite
+{
+    Texture* texture; // nullptr for a solid rect
+    SDL_Texture* page; // what actually gets bound, the atlas page for views
+    SDL_BlendMode blend;
+    SpriteLayer layer;
+    uint32_t order; // when it was drawn, for ties
+    SDL_Rect src; // on the page
+    SDL_FRect dst;
+    float angle; // degrees clockwise, like SDL_RenderCopyEx
+    SDL_FPoint center; // relative to dst
+    SDL_RendererFlip flip;
+    SDL_Color color; // the texture's colour & alpha mod when it was drawn
+};
+
+// collects the frame's textured quads and draws them with as few SDL_RenderGeometry calls as it can.
+// Colour, alpha & blend mode are read off the texture when a sprite is drawn, so the usual setColor,
+// setAlpha & setBlendMode calls before a draw still work. Views on the same atlas page batch together
+// whichever Texture they came from. Nothing hits the renderer until flush(), so
+// it needs flushing before anything drawn straight to the renderer that should go on top. In
+// RenderState's counting mode flush() sorts, batches & counts the same but draws nothing
+class SpriteBatch
+{
+private:
+    std::vector<Sprite> _Sprites{};
+    std::vector<uint32_t> _Sorted{};
+    std::vector<SDL_Vertex> _Vertices{};
+    std::vector<int> _Indices{};
+
+    // since the last resetStats()
+    int _quads{0};
+    int _calls{0};
+    int _switches{0}; // calls that bound a different texture to the one before
+    int _unsorted_switches{0}; // the same if every quad was drawn in the order it came in
+    int _solid{0}; // quads with no texture
+    SDL_Texture* _bound{nullptr};
+
+    bool sameRun(const Sprite& a, const Sprite& b) const
+    {
+        return a.page == b.page && a.blend == b.blend;
+    }
+
+    void addQuad(const Sprite& sprite, const float tex_w, const float tex_h)
+    {
+        float u0{0.0f};
+        float v0{0.0f};
+        float u1{1.0f};
+        float v1{1.0f};
+        if (sprite.texture != nullptr)
+        {
+            u0 = sprite.src.x / tex_w;
+            v0 = sprite.src.y / tex_h;
+            u1 = (sprite.src.x + sprite.src.w) / tex_w;
+            v1 = (sprite.src.y + sprite.src.h) / tex_h;
+        }
+        if (sprite.flip & SDL_FLIP_HORIZONTAL)
+        {
+            std::swap(u0, u1);
+        }
+        if (sprite.flip & SDL_FLIP_VERTICAL)
+        {
+            std::swap(v0, v1);
+        }
+
+        // corners around the rotation center, top left then clockwise
+        const SDL_FRect& dst{sprite.dst};
+        const std::array<SDL_FPoint, 4> corners{{{-sprite.center.x, -sprite.center.y}, {dst.w - sprite.center.x, -sprite.center.y}, {dst.w - sprite.center.x, dst.h - sprite.center.y}, {-sprite.center.x, dst.h - sprite.center.y}}};
+        const std::array<SDL_FPoint, 4> uvs{{{u0, v0}, {u1, v0}, {u1, v1}, {u0, v1}}};
+        float c{1.0f};
+        float s{0.0f};
+        if (sprite.angle != 0.0f)
+        {
+            c = std::cos(sprite.angle * static_cast<float>(M_PI) / 180.0f);
+            s = std::sin(sprite.angle * static_cast<float>(M_PI) / 180.0f);
+        }
+        const int first{static_cast<int>(_Vertices.size())};
+        for (int i{0}; i < 4; ++i)
+        {
+            const SDL_FPoint& p{corners[i]};
+            _Vertices.push_back(SDL_Vertex{{dst.x + sprite.center.x + p.x * c - p.y * s, dst.y + sprite.center.y + p.x * s + p.y * c}, sprite.color, uvs[i]});
+        }
+        for (const int i : {0, 1, 2, 0, 2, 3})
+        {
+            _Indices.push_back(first + i);
+        }
+    }
+
+    void submit(SDL_Renderer* renderer, SDL_Texture* sdl_texture, const SDL_BlendMode blend)
+    {
+        if (sdl_texture != _bound)
+        {
+            ++_switches;
+            _bound = sdl_texture;
+        }
+        if (sdl_texture != nullptr)
+        {
+            // the mods are baked into the vertex colours, so take them off the texture while it draws.
+            // Immediate draws put their own back on through RenderState
+            RenderState::setTextureMods(sdl_texture, SDL_Color{255, 255, 255, 255}, blend);
+            if (!RenderState::isCounting())
+            {
+                SDL_RenderGeometry(renderer, sdl_texture, _Vertices.data(), static_cast<int>(_Vertices.size()), _Indices.data(), static_cast<int>(_Indices.size()));
+            }
+        } else {
+            const SDL_BlendMode old_blend{RenderState::getDrawBlendMode(renderer)};
+            RenderState::setDrawBlendMode(renderer, blend);
+            if (!RenderState::isCounting())
+            {
+                SDL_RenderGeometry(renderer, nullptr, _Vertices.data(), static_cast<int>(_Vertices.size()), _Indices.data(), static_cast<int>(_Indices.size()));
+            }
+            RenderState::setDrawBlendMode(renderer, old_blend);
+        }
+        ++_calls;
+        _Vertices.clear();
+        _Indices.clear();
+    }
+
+public:
+    SpriteBatch()
+    {
+    }
+
+    std::size_t size() const {return _Sprites.size();}
+
+    // clip is the part of the texture to draw (nullptr for all of it), scale multiplies the size
+    void draw(Texture& texture, const SpriteLayer layer, const int x, const int y, const SDL_Rect* clip = nullptr, const double angle = 0.0, const SDL_Point* center = nullptr, const SDL_RendererFlip flip = SDL_FLIP_NONE, const int scale = 1)
+    {
+        const SDL_Rect src{clip != nullptr ? *clip : SDL_Rect{0, 0, texture.getWidth(), texture.getHeight()}};
+        draw(texture, layer, SDL_Rect{x, y, src.w * SCALE_FACTOR * scale, src.h * SCALE_FACTOR * scale}, clip, angle, center, flip);
+    }
+
+    // stretched over dst
+    void draw(Texture& texture, const SpriteLayer layer, const SDL_Rect& dst, const SDL_Rect* clip = nullptr, const double angle = 0.0, const SDL_Point* center = nullptr, const SDL_RendererFlip flip = SDL_FLIP_NONE)
+    {
+        const SDL_FPoint pivot{center != nullptr ? SDL_FPoint{static_cast<float>(center->x), static_cast<float>(center->y)} : SDL_FPoint{dst.w / 2.0f, dst.h / 2.0f}};
+        _Sprites.push_back(Sprite{&texture, texture.getTexture(), texture.getBlendMode(), layer, static_cast<uint32_t>(_Sprites.size()), texture.getSource(clip),
+                                  SDL_FRect{static_cast<float>(dst.x), static_cast<float>(dst.y), static_cast<float>(dst.w), static_cast<float>(dst.h)},
+                                  static_cast<float>(angle), pivot, flip, texture.getMod()});
+    }
+
+    // blend works like SDL_SetRenderDrawBlendMode does for SDL_RenderFillRect
+    void fillRect(const SpriteLayer layer, const SDL_Rect& rect, const SDL_Color color, const SDL_BlendMode blend = SDL_BLENDMODE_NONE)
+    {
+        _Sprites.push_back(Sprite{nullptr, nullptr, blend, layer, static_cast<uint32_t>(_Sprites.size()), SDL_Rect{0, 0, 0, 0},
+                                  SDL_FRect{static_cast<float>(rect.x), static_cast<float>(rect.y), static_cast<float>(rect.w), static_cast<float>(rect.h)},
+                                  0.0f, SDL_FPoint{0.0f, 0.0f}, SDL_FLIP_NONE, color});
+    }
+
+    // draws everything by layer, then SDL texture, then the order it came in, and empties the batch
+    void flush(SDL_Renderer* renderer)
+    {
+        if (_Sprites.empty())
+        {
+            return;
+        }
+        SDL_Texture* last{nullptr};
+        for (const Sprite& sprite : _Sprites)
+        {
+            _unsorted_switches += sprite.page != last;
+            _solid += sprite.texture == nullptr;
+            last = sprite.page;
+        }
+        _Sorted.resize(_Sprites.size());
+        for (uint32_t i{0}; i < _Sorted.size(); ++i)
+        {
+            _Sorted[i] = i;
+        }
+        std::sort(_Sorted.begin(), _Sorted.end(), [&](const uint32_t a, const uint32_t b)
+        {
+            const Sprite& sa{_Sprites[a]};
+            const Sprite& sb{_Sprites[b]};
+            if (sa.layer != sb.layer)
+            {
+                return sa.layer < sb.layer;
+            }
+            if (sa.page != sb.page)
+            {
+                return std::less<SDL_Texture*>{}(sa.page, sb.page);
+            }
+            if (sa.blend != sb.blend)
+            {
+                return sa.blend < sb.blend;
+            }
+            return sa.order < sb.order;
+        });
+
+        const Sprite* run{&_Sprites[_Sorted.front()]};
+        float tex_w{run->texture != nullptr ? static_cast<float>(run->texture->getPageWidth()) : 1.0f};
+        float tex_h{run->texture != nullptr ? static_cast<float>(run->texture->getPageHeight()) : 1.0f};
+        for (const uint32_t i : _Sorted)
+        {
+            const Sprite& sprite{_Sprites[i]};
+            if (!sameRun(*run, sprite))
+            {
+                submit(renderer, run->page, run->blend);
+                run = &sprite;
+                tex_w = run->texture != nullptr ? static_cast<float>(run->texture->getPageWidth()) : 1.0f;
+                tex_h = run->texture != nullptr ? static_cast<float>(run->texture->getPageHeight()) : 1.0f;
+            }
+            addQuad(sprite, tex_w, tex_h);
+        }
+        submit(renderer, run->page, run->blend);
+        _bound = nullptr; // anything can get bound between flushes
+        _quads += static_cast<int>(_Sprites.size());
+        _Sprites.clear();
+    }
+
+    // quads is how many SDL_RenderCopy calls it would have been without the batch
+    int getQuads() const {return _quads;}
+    int getCalls() const {return _calls;}
+    int getSwitches() const {return _switches;}
+    int getUnsortedSwitches() const {return _unsorted_switches;}
+    int getSolid() const {return _solid;}
+    void resetStats()
+    {
+        _quads = 0;
+        _calls = 0;
+        _switches = 0;
+        _unsorted_switches = 0;
+        _solid = 0;
+    }
+};
+
+#endif
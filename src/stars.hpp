@@ -2,9 +2,9 @@
 #define STARS_H
 
 #include "./texman.hpp"
+#include "./spritebatch.hpp"
 #include "./vec2.hpp"
 #include "./util.hpp"
-#include "./timer.hpp"
 
 #include <vector>
 
@@ -21,20 +21,18 @@ class StarManager
 private:
     std::vector<Star*> _Stars{};
     Texture* _tex{nullptr};
-    Timer timer{};
+    double _time{0.0}; // frames @ 60fps it's been updated for, so the twinkling keeps to the game's clock
 
 public:
     StarManager(int stariness)
     {
         generate(stariness);
-        timer.start();
     }
 
     StarManager(int stariness, TexMan* texman)
     {
         generate(stariness);
         setTex(&(texman->lightTex));
-        timer.start();
     }
 
     ~StarManager()
@@ -70,17 +68,19 @@ public:
         _tex = tex;
     }
 
-    void update(const double& time_step, const int scrollX, const int scrollY, const int width, const int height, SDL_Renderer* renderer)
+    void update(const double& time_step, const int scrollX, const int scrollY, const int width, const int height, SpriteBatch& batch)
     {
+        _time += time_step;
+        const double ticks{_time * 1000.0 / 60.0}; // ms
+        _tex->setBlendMode(SDL_BLENDMODE_ADD);
         for (std::size_t i{0}; i < _Stars.size(); ++i)
         {
             Star* star{_Stars[i]};
             // Star->pos.x += Star->speed * time_step;
             vec2<double> render_pos{star->pos.x - static_cast<double>(scrollX) * star->depth * 0.1, star->pos.y - static_cast<double>(scrollY) * star->depth * 0.1};
-            _tex->setBlendMode(SDL_BLENDMODE_ADD);
-            _tex->setAlpha(static_cast<Uint8>(static_cast<int>(std::sin(static_cast<double>(timer.getTicks()) * 0.0005 + star->frame) * 50.0 + 50.0)));
+            _tex->setAlpha(static_cast<Uint8>(static_cast<int>(std::sin(ticks * 0.0005 + star->frame) * 50.0 + 50.0)));
             SDL_Rect renderQuad{(static_cast<int>(render_pos.x) % (width + 64)) - 64, (static_cast<int>(render_pos.y) % (height + 64)) - 64, 3, 3};
-            SDL_RenderCopyEx(renderer, _tex->getTexture(), NULL, &renderQuad, 0, NULL, SDL_FLIP_NONE);
+            batch.draw(*_tex, SpriteLayer::SKY, renderQuad);
         }
     }
 };
@@ -5,8 +5,12 @@
 #include "SDL2/SDL_ttf.h"
 
 #include "./texture.hpp"
+#include "./atlas.hpp"
+#include "./glyphs.hpp"
 #include "./audio.hpp"
 
+#include <vector>
+
 class TexMan
 {
 public:
@@ -102,11 +106,76 @@ public:
     Music MUS_Menu{};
     Music MUS_Level1{};
 
+    // everything but particle lives on here
+    Atlas atlas{};
+
     TTF_Font* baseFont{nullptr};
     TTF_Font* baseFontBold{nullptr};
+    // the fonts' glyphs, for drawing text without making a texture for it
+    GlyphAtlas baseText{};
+    GlyphAtlas baseTextBold{};
 
     bool freed{false};
 
+    struct TexFile
+    {
+        Texture TexMan::* texture;
+        const char* path;
+    };
+
+    // the textures that get packed into the atlas
+    static const std::vector<TexFile>& getAtlasFiles()
+    {
+        static const std::vector<TexFile> files{
+            {&TexMan::tileGrassTex, "data/images/tiles/grass.png"},
+            {&TexMan::tileRockTex, "data/images/tiles/rock.png"},
+            {&TexMan::tileSpikeTex, "data/images/tiles/spike.png"},
+            {&TexMan::tileSpringTex, "data/images/tiles/spring.png"},
+            {&TexMan::tileTrees, "data/images/tiles/trees.png"},
+            {&TexMan::largeDecor, "data/images/tiles/large_decor.png"},
+            {&TexMan::particleFire, "data/images/particles/fire.png"},
+            {&TexMan::slimeIdle, "data/images/entities/slime/idle.png"},
+            {&TexMan::slimeRun, "data/images/entities/slime/run.png"},
+            {&TexMan::slimeJump, "data/images/entities/slime/jump.png"},
+            {&TexMan::bat, "data/images/entities/bat/bat.png"},
+            {&TexMan::batFlash, "data/images/entities/bat/flash.png"},
+            {&TexMan::slimeFlash, "data/images/entities/slime/flash.png"},
+            {&TexMan::lightTex, "data/images/particles/light.png"},
+            {&TexMan::playerIdle, "data/images/entities/player/idle.png"},
+            {&TexMan::playerRun, "data/images/entities/player/run.png"},
+            {&TexMan::playerJump, "data/images/entities/player/jump.png"},
+            {&TexMan::playerLand, "data/images/entities/player/land.png"},
+            {&TexMan::playerFlash, "data/images/entities/player/flash.png"},
+            {&TexMan::grass, "data/images/grass/grass.png"},
+            {&TexMan::swordBase, "data/images/entities/sword.png"},
+            {&TexMan::slash, "data/images/vfx/slash.png"},
+            {&TexMan::blasterBase, "data/images/blasters/blaster.png"},
+            {&TexMan::laserBlue, "data/images/blasters/laser.png"},
+            {&TexMan::laserRed, "data/images/blasters/laser_red.png"},
+            {&TexMan::enemyHealthBar, "data/images/entities/enemy_health_bar.png"},
+            {&TexMan::playerHealthBar, "data/images/entities/health_bar.png"},
+            {&TexMan::turtleIdle, "data/images/entities/turtle/idle.png"},
+            {&TexMan::turtleRun, "data/images/entities/turtle/run.png"},
+            {&TexMan::turtleJump, "data/images/entities/turtle/jump.png"},
+            {&TexMan::turtleLand, "data/images/entities/turtle/land.png"},
+            {&TexMan::turtleFlash, "data/images/entities/turtle/flash.png"},
+            {&TexMan::leafTex, "data/images/particles/leaf.png"},
+            {&TexMan::coin, "data/images/collectables/coin.png"},
+            {&TexMan::circle, "data/images/particles/circle.png"},
+            {&TexMan::uiPlay, "data/images/ui/play.png"},
+            {&TexMan::shockwave, "data/images/vfx/shockwave.png"},
+            {&TexMan::portalTex, "data/images/tiles/portal.png"},
+            {&TexMan::logo, "data/images/ui/logo.png"},
+            {&TexMan::backdropTex, "data/images/background/backdrop.png"},
+            {&TexMan::cloud_dark, "data/images/background/clouds_dark.png"},
+            {&TexMan::cloud_light, "data/images/background/clouds_light.png"},
+            {&TexMan::black, "data/images/vfx/black.png"},
+            {&TexMan::moon, "data/images/background/moon.png"},
+            {&TexMan::buttonMusic, "data/images/ui/music.png"},
+        };
+        return files;
+    }
+
     TexMan()
     {
     }
@@ -120,50 +189,12 @@ public:
     {
         if (!freed)
         {
-            tileGrassTex.free();
-            tileRockTex.free();
-            tileSpikeTex.free();
-            tileSpringTex.free();
-            tileTrees.free();
-            largeDecor.free();
-            portalTex.free();
+            for (const TexFile& file : getAtlasFiles())
+            {
+                (this->*file.texture).free();
+            }
             particle.free();
-            particleFire.free();
-            lightTex.free();
-            shockwave.free();
-            circle.free();
-            backdropTex.free();
-            buttonMusic.free();
-            cloud_dark.free();
-            cloud_light.free();
-            leafTex.free();
-            slimeIdle.free();
-            slimeRun.free();
-            slimeJump.free();
-            slimeFlash.free();
-            bat.free();
-            batFlash.free();
-            playerIdle.free();
-            playerRun.free();
-            playerJump.free();
-            playerLand.free();
-            grass.free();
-            swordBase.free();
-            slash.free();
-            blasterBase.free();
-            laserBlue.free();
-            laserRed.free();
-            enemyHealthBar.free();
-            playerHealthBar.free();
-            turtleIdle.free();
-            turtleRun.free();
-            turtleJump.free();
-            turtleLand.free();
-            turtleFlash.free();
-            uiPlay.free();
-            logo.free();
-            black.free();
-            moon.free();
+            atlas.free();
             SFX_death_0.free();
             SFX_hit_0.free();
             SFX_hit_1.free();
@@ -187,6 +218,8 @@ public:
             MUS_Level1.free();
             MUS_Menu.free();
 
+            baseText.free();
+            baseTextBold.free();
             TTF_CloseFont(baseFont);
             TTF_CloseFont(baseFontBold);
             std::cout << "closed fonts\n";
@@ -206,52 +239,18 @@ public:
     {
         bool success{true};
         freed = false;
-        confirm(tileGrassTex.loadFromFile("data/images/tiles/grass.png", window, renderer), success);
-        confirm(tileRockTex.loadFromFile("data/images/tiles/rock.png", window, renderer), success);
-        confirm(tileSpikeTex.loadFromFile("data/images/tiles/spike.png", window, renderer), success);
-        confirm(tileSpringTex.loadFromFile("data/images/tiles/spring.png", window, renderer), success);
-        confirm(tileTrees.loadFromFile("data/images/tiles/trees.png", window, renderer), success);
-        confirm(largeDecor.loadFromFile("data/images/tiles/large_decor.png", window, renderer), success);
+        const Uint64 start{SDL_GetPerformanceCounter()};
+        // the particle texture gets drawn as polygons with UVs over the whole texture, so it can't be a view
         confirm(particle.loadFromFile("data/images/particles/particle.png", window, renderer), success);
-        confirm(particleFire.loadFromFile("data/images/particles/fire.png", window, renderer), success);
-        confirm(slimeIdle.loadFromFile("data/images/entities/slime/idle.png", window, renderer), success);
-        confirm(slimeRun.loadFromFile("data/images/entities/slime/run.png", window, renderer), success);
-        confirm(slimeJump.loadFromFile("data/images/entities/slime/jump.png", window, renderer), success);
-        confirm(bat.loadFromFile("data/images/entities/bat/bat.png", window, renderer), success);
-        confirm(batFlash.loadFromFile("data/images/entities/bat/flash.png", window, renderer), success);
-        confirm(slimeFlash.loadFromFile("data/images/entities/slime/flash.png", window, renderer), success);
-        confirm(lightTex.loadFromFile("data/images/particles/light.png", window, renderer), success);
-        confirm(playerIdle.loadFromFile("data/images/entities/player/idle.png", window, renderer), success);
-        confirm(playerRun.loadFromFile("data/images/entities/player/run.png", window, renderer), success);
-        confirm(playerJump.loadFromFile("data/images/entities/player/jump.png", window, renderer), success);
-        confirm(playerLand.loadFromFile("data/images/entities/player/land.png", window, renderer), success);
-        confirm(playerFlash.loadFromFile("data/images/entities/player/flash.png", window, renderer), success);
-        confirm(grass.loadFromFile("data/images/grass/grass.png", window, renderer), success);
-        confirm(swordBase.loadFromFile("data/images/entities/sword.png", window, renderer), success);
-        confirm(slash.loadFromFile("data/images/vfx/slash.png", window, renderer), success);
-        confirm(blasterBase.loadFromFile("data/images/blasters/blaster.png", window, renderer), success);
-        confirm(laserBlue.loadFromFile("data/images/blasters/laser.png", window, renderer), success);
-        confirm(laserRed.loadFromFile("data/images/blasters/laser_red.png", window, renderer), success);
-        confirm(enemyHealthBar.loadFromFile("data/images/entities/enemy_health_bar.png", window, renderer), success);
-        confirm(playerHealthBar.loadFromFile("data/images/entities/health_bar.png", window, renderer), success);
-        confirm(turtleIdle.loadFromFile("data/images/entities/turtle/idle.png", window, renderer), success);
-        confirm(turtleRun.loadFromFile("data/images/entities/turtle/run.png", window, renderer), success);
-        confirm(turtleJump.loadFromFile("data/images/entities/turtle/jump.png", window, renderer), success);
-        confirm(turtleLand.loadFromFile("data/images/entities/turtle/land.png", window, renderer), success);
-        confirm(turtleFlash.loadFromFile("data/images/entities/turtle/flash.png", window, renderer), success);
-        confirm(leafTex.loadFromFile("data/images/particles/leaf.png", window, renderer), success);
-        confirm(coin.loadFromFile("data/images/collectables/coin.png", window, renderer), success);
-        confirm(circle.loadFromFile("data/images/particles/circle.png", window, renderer), success);
-        confirm(uiPlay.loadFromFile("data/images/ui/play.png", window, renderer), success);
-        confirm(shockwave.loadFromFile("data/images/vfx/shockwave.png", window, renderer), success);
-        confirm(portalTex.loadFromFile("data/images/tiles/portal.png", window, renderer), success);
-        confirm(logo.loadFromFile("data/images/ui/logo.png", window, renderer), success);
-        confirm(backdropTex.loadFromFile("data/images/background/backdrop.png", window, renderer), success);
-        confirm(cloud_dark.loadFromFile("data/images/background/clouds_dark.png", window, renderer), success);
-        confirm(cloud_light.loadFromFile("data/images/background/clouds_light.png", window, renderer), success);
-        confirm(black.loadFromFile("data/images/vfx/black.png", window, renderer), success);
-        confirm(moon.loadFromFile("data/images/background/moon.png", window, renderer), success);
-        confirm(buttonMusic.loadFromFile("data/images/ui/music.png", window, renderer), success);
+        std::vector<Texture*> packed{};
+        for (const TexFile& file : getAtlasFiles())
+        {
+            Texture& texture{this->*file.texture};
+            confirm(texture.loadPixelsFromFile(file.path, window), success);
+            packed.push_back(&texture);
+        }
+        confirm(atlas.pack(packed, renderer), success);
+        std::cout << "Loaded " << packed.size() + 1 << " textures, " << atlas.getSprites() << " packed into " << atlas.getPages() << " atlas page(s) (" << static_cast<int>(atlas.getFill() * 100.0) << "% full) in " << (SDL_GetPerformanceCounter() - start) * 1000.0 / SDL_GetPerformanceFrequency() << "ms\n";
         SFX_death_0.loadFromFileWAV("data/audio/death/death_0.wav");
         SFX_hit_0.loadFromFileWAV("data/audio/hit/hit_0.wav");
         SFX_hit_1.loadFromFileWAV("data/audio/hit/hit_1.wav");
@@ -277,6 +276,8 @@ public:
 
         baseFont = TTF_OpenFont("data/fonts/PixelOperator.ttf", 20);
         baseFontBold = TTF_OpenFont("data/fonts/PixelOperator-Bold.ttf", 20);
+        confirm(baseText.build(baseFont, renderer), success);
+        confirm(baseTextBold.build(baseFontBold, renderer), success);
         return success;
     }
 
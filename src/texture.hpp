@@ -7,6 +7,7 @@
 #include "SDL2/SDL_ttf.h"
 
 #include "./constants.hpp"
+#include "./renderstate.hpp"
 
 #include <iostream>
 #include <string>
@@ -31,6 +32,21 @@ private:
     int _Width;
     int _Height;
 
+    // a view is a sub rect of an atlas page it doesn't own. The mods are kept here & put on the SDL
+    // texture right before each draw (through RenderState, so it's free when nothing changed), since
+    // every other view on the page shares its SDL state
+    bool _View;
+    SDL_Rect _Source;
+    int _PageWidth;
+    int _PageHeight;
+    SDL_Color _Mod;
+    SDL_BlendMode _Blend;
+
+    void applyMods()
+    {
+        RenderState::setTextureMods(_Texture, _Mod, _Blend);
+    }
+
 public:
     Texture()
     {
@@ -41,6 +57,12 @@ public:
         _RawPitch = 0;
         _Width = 0;
         _Height = 0;
+        _View = false;
+        _Source = {0, 0, 0, 0};
+        _PageWidth = 0;
+        _PageHeight = 0;
+        _Mod = {255, 255, 255, 255};
+        _Blend = SDL_BLENDMODE_BLEND;
     }
 
     ~Texture()
@@ -103,6 +125,8 @@ public:
             assert(_Texture != NULL && SDL_GetError());
             _Width = _SurfacePixels->w;
             _Height = _SurfacePixels->h;
+            _PageWidth = _Width;
+            _PageHeight = _Height;
             SDL_FreeSurface(_SurfacePixels);
             _SurfacePixels = NULL;
         }
@@ -124,6 +148,8 @@ public:
             } else {
                 _Width = textSurface->w;
                 _Height = textSurface->h;
+                _PageWidth = _Width;
+                _PageHeight = _Height;
             }
 
             SDL_FreeSurface(textSurface);
@@ -132,6 +158,24 @@ public:
         return _Texture != NULL;
     }
 
+    // copies surface as it is, no colour key. The surface still belongs to the caller
+    bool loadFromSurface(SDL_Surface* surface, SDL_Renderer* renderer)
+    {
+        free();
+        _Texture = SDL_CreateTextureFromSurface(renderer, surface);
+        if (_Texture == NULL)
+        {
+            std::cout << "Unable to create texture from surface! SDL_Error: " << SDL_GetError() << '\n';
+        } else {
+            _Width = surface->w;
+            _Height = surface->h;
+            _PageWidth = _Width;
+            _PageHeight = _Height;
+        }
+
+        return _Texture != NULL;
+    }
+
     bool createBlank(int width, int height, SDL_Renderer* renderer, SDL_TextureAccess access)
     {
         free();
@@ -143,20 +187,47 @@ public:
         } else {
             _Width = width;
             _Height = height;
+            _PageWidth = width;
+            _PageHeight = height;
+            _Blend = SDL_BLENDMODE_NONE;
         }
 
         return _Texture != NULL;
     }
 
+    // turns this into a view of source on an atlas page, dropping whatever it had before. The page
+    // belongs to whoever packed it and has to outlive the view
+    void setView(SDL_Texture* page, const SDL_Rect& source, int page_width, int page_height)
+    {
+        free();
+        _Texture = page;
+        _View = true;
+        _Source = source;
+        _Width = source.w;
+        _Height = source.h;
+        _PageWidth = page_width;
+        _PageHeight = page_height;
+    }
+
     void free()
     {
         if (_Texture != NULL)
         {
-            SDL_DestroyTexture(_Texture);
+            if (!_View)
+            {
+                RenderState::forget(_Texture);
+                SDL_DestroyTexture(_Texture);
+            }
             _Texture = NULL;
             _Width = 0;
             _Height = 0;
         }
+        _View = false;
+        _Source = {0, 0, 0, 0};
+        _PageWidth = 0;
+        _PageHeight = 0;
+        _Mod = {255, 255, 255, 255};
+        _Blend = SDL_BLENDMODE_BLEND;
 
         if (_SurfacePixels != NULL)
         {
@@ -167,17 +238,58 @@ public:
 
     void setColor(Uint8 red, Uint8 green, Uint8 blue)
     {
-        SDL_SetTextureColorMod(_Texture, red, green, blue);
+        _Mod.r = red;
+        _Mod.g = green;
+        _Mod.b = blue;
     }
 
     void setBlendMode(SDL_BlendMode blending)
     {
-        SDL_SetTextureBlendMode(_Texture, blending);
+        _Blend = blending;
     }
 
     void setAlpha(Uint8 alpha)
     {
-        SDL_SetTextureAlphaMod(_Texture, alpha);
+        _Mod.a = alpha;
+    }
+
+    // colour & alpha mod as one colour
+    SDL_Color getMod() const {return _Mod;}
+    SDL_BlendMode getBlendMode() const {return _Blend;}
+
+    // clip (or all of it) as a rect on the SDL texture, which is the page for a view
+    SDL_Rect getSource(const SDL_Rect* clip = NULL) const
+    {
+        if (clip == NULL)
+        {
+            return SDL_Rect{_Source.x, _Source.y, _Width, _Height};
+        }
+        return SDL_Rect{clip->x + _Source.x, clip->y + _Source.y, clip->w, clip->h};
+    }
+
+    int getPageWidth() const {return _PageWidth;}
+    int getPageHeight() const {return _PageHeight;}
+    bool isView() const {return _View;}
+
+    // the surface from loadPixelsFromFile, NULL once it's been made into a texture
+    SDL_Surface* getSurface()
+    {
+        return _SurfacePixels;
+    }
+
+    // puts the mods on & gives back the SDL texture, for drawing it some other way (SDL_RenderGeometry)
+    SDL_Texture* bindTexture()
+    {
+        applyMods();
+        return _Texture;
+    }
+
+    // the whole texture stretched over dst
+    void renderStretched(const SDL_Rect& dst, SDL_Renderer* renderer)
+    {
+        const SDL_Rect source{getSource()};
+        applyMods();
+        SDL_RenderCopy(renderer, _Texture, &source, &dst);
     }
 
     void render(int x, int y, SDL_Renderer* renderer, SDL_Rect* clip = NULL)
@@ -193,7 +305,9 @@ public:
         renderQuad.w *= SCALE_FACTOR;
         renderQuad.h *= SCALE_FACTOR;
 
-        SDL_RenderCopy(renderer, _Texture, clip, &renderQuad);
+        const SDL_Rect source{getSource(clip)};
+        applyMods();
+        SDL_RenderCopy(renderer, _Texture, &source, &renderQuad);
     }
 
     void render(int x, int y, SDL_Renderer* renderer, double angle, SDL_Point* center, SDL_RendererFlip flip, SDL_Rect* clip = NULL, int scale_factor = 0)
@@ -215,7 +329,9 @@ public:
             renderQuad.h *= scale_factor;
         }
 
-        SDL_RenderCopyEx(renderer, _Texture, clip, &renderQuad, angle, center, flip);
+        const SDL_Rect source{getSource(clip)};
+        applyMods();
+        SDL_RenderCopyEx(renderer, _Texture, &source, &renderQuad, angle, center, flip);
     }
 
     void renderClean(int x, int y, SDL_Renderer* renderer, int scale_factor)
@@ -223,13 +339,13 @@ public:
         SDL_Rect renderQuad {x, y, _Width, _Height};
         renderQuad.w *= scale_factor;
         renderQuad.h *= scale_factor;
-        SDL_RenderCopy(renderer, _Texture, NULL, &renderQuad);
+        renderStretched(renderQuad, renderer);
     }
 
     void renderClean(int x, int y, SDL_Renderer* renderer)
     {
         SDL_Rect renderQuad {x, y, _Width, _Height};
-        SDL_RenderCopy(renderer, _Texture, NULL, &renderQuad);
+        renderStretched(renderQuad, renderer);
     }
 
     void setAsRenderTarget(SDL_Renderer* renderer)
@@ -8,13 +8,16 @@
 #include <vector>
 #include <array>
 #include <iostream>
+#include <algorithm>
 #include <cmath> // for calculating tile/chunk coords (std::floor)
 
 #include "./vec2.hpp"
 #include "./util.hpp"
 #include "./constants.hpp"
+#include "./broadphase.hpp"
 
 #include "./texman.hpp"
+#include "./spritebatch.hpp"
 #include "./timer.hpp"
 
 #include "./leaf.hpp"
@@ -39,6 +42,8 @@ struct GrassTile
     int total{0};
 };
 
+inline constexpr uint8_t GRASS_BODIES{BODY_PLAYER}; // what pushes the grass over
+
 class GrassManager
 {
 private:
@@ -46,6 +51,8 @@ private:
     GrassTile** _GrassTiles;
     int _total{0};
 
+    std::vector<int> _Nearby{}; // bodies by the grass tile being updated
+
     // for wind
     Timer windTimer{};
 
@@ -98,11 +105,12 @@ public:
         ++_total;
     }
 
-    void updateGrass(Grass* grass, const double& time_step, SDL_Rect* rect, bool check_collision = true)
+    // rect is whatever is pushing on the grass, nullptr if nothing is
+    void updateGrass(Grass* grass, const double& time_step, const SDL_Rect* rect)
     {
         double target_angle = 0.0;
         SDL_Rect grassRect{static_cast<int>(grass->pos.x), static_cast<int>(grass->pos.y) + 4, 4, 5};
-        if (Util::checkCollision(&grassRect, rect))
+        if (rect != nullptr && Util::checkCollision(&grassRect, rect))
         {
             double distance {std::pow(static_cast<double>(grassRect.x + grassRect.w / 2) - static_cast<double>(rect->x + rect->w / 2), 2) + std::pow(static_cast<double>(grassRect.y + grassRect.h / 2) - static_cast<double>(rect->y + rect->h / 2), 2)};
             double hd = static_cast<double>(grassRect.x + grassRect.w / 2) - static_cast<double>(rect->x + rect->w / 2);
@@ -124,7 +132,7 @@ public:
         grass->target_angle += (target_angle - grass->target_angle) * 0.5 * time_step;
     }
 
-    void renderGrass(const int scrollX, const int scrollY, SDL_Renderer* renderer, TexMan* texman, const int width, const int height, SDL_Rect* player_rect, const double& time_step)
+    void renderGrass(const int scrollX, const int scrollY, SpriteBatch& batch, TexMan* texman, const int width, const int height, const Broadphase& bodies, const double& time_step)
     {
         double time{static_cast<double>(windTimer.getTicks())};
         for (std::size_t i{0}; i < _total; ++i)
@@ -133,12 +141,15 @@ public:
             // check if it is on the screen
             if (-TILE_SIZE * 2 < grassTile->pos.x * TILE_SIZE - scrollX && grassTile->pos.x * TILE_SIZE - scrollX < width + TILE_SIZE * 2 && -TILE_SIZE * 2 < grassTile->pos.y * TILE_SIZE - scrollY && grassTile->pos.y * TILE_SIZE - scrollY < height + TILE_SIZE * 2)
             {
+                const SDL_Rect tileRect {grassTile->pos.x * TILE_SIZE - 8, grassTile->pos.y * TILE_SIZE - 8, TILE_SIZE + 16, TILE_SIZE + 16};
+                _Nearby.clear();
+                bodies.queryAABB(tileRect, GRASS_BODIES, _Nearby);
+                const SDL_Rect* pusher{_Nearby.empty() ? nullptr : &bodies.getBody(_Nearby.front()).rect};
                 // iterate through grass in grassTile
                 for (std::size_t g{0}; g < grassTile->total; ++g)
                 {
                     Grass* grass {grassTile->grass[g]};
-                    SDL_Rect tileRect {grassTile->pos.x * TILE_SIZE - 8, grassTile->pos.y * TILE_SIZE - 8, TILE_SIZE + 16, TILE_SIZE + 16};
-                    updateGrass(grass, time_step, player_rect, Util::checkCollision(&tileRect, player_rect));
+                    updateGrass(grass, time_step, pusher);
                     grass->target_angle += std::sin(time * 0.001 + (grass->pos.x + grass->pos.y) / 10.0) * (std::sin(time * 0.003 + (grass->pos.x + grass->pos.y) * 0.1) + 1.0) / 2 * time_step;
                     grass->target_angle += std::cos(time * (0.01 + 0.01 * (std::sin(grass->pos.x + grass->pos.y) + 1.0)) + (grass->pos.x + grass->pos.y) / 5.0) * 0.2 * (std::sin(time * 0.003 + (grass->pos.x + grass->pos.y) * 0.1) + 1.0) / 2 * time_step;
                     double force {grass->target_angle - grass->angle / _tension};
@@ -148,13 +159,15 @@ public:
                     grass->angle = std::max(-90.0, std::min(90.0, grass->angle));
                     SDL_Rect clipRect{grass->variant * 9, 0, 9, 9};
                     SDL_Point center{5, 5};
-                    texman->grass.render(static_cast<int>(grass->pos.x) - scrollX - 2.5, static_cast<int>(grass->pos.y) - scrollY + 3, renderer, grass->angle, &center, SDL_FLIP_NONE, &clipRect);
+                    batch.draw(texman->grass, SpriteLayer::GRASS, static_cast<int>(grass->pos.x) - scrollX - 2.5, static_cast<int>(grass->pos.y) - scrollY + 3, &clipRect, grass->angle, &center);
                 }
             }
         }
     }
 };
 
+inline constexpr int SPRING_TRAVEL{TILE_SIZE * 2}; // px a spring can bounce either way, its trigger covers all of it
+
 class Spring
 {
 private:
@@ -196,9 +209,9 @@ public:
         _vel += (_vel * _dampening - _vel) * time_step;
     }
 
-    void render(const int scrollX, const int scrollY, SDL_Renderer* renderer, TexMan* texman)
+    void render(const int scrollX, const int scrollY, SpriteBatch& batch, TexMan* texman)
     {
-        texman->tileSpringTex.render(static_cast<int>(_pos.x) - scrollX, static_cast<int>(_pos.y + _spring_factor) - scrollY, renderer);
+        batch.draw(texman->tileSpringTex, SpriteLayer::TILES, static_cast<int>(_pos.x) - scrollX, static_cast<int>(_pos.y + _spring_factor) - scrollY);
     }
 };
 
@@ -235,6 +248,29 @@ struct Decor
     uint8_t variant;
 };
 
+// what a ray stops at
+enum RayMask : uint8_t
+{
+    RAY_SOLID = 1 << 0,
+    RAY_DANGER = 1 << 1
+};
+
+struct Ray
+{
+    vec2<double> origin; // px
+    vec2<double> dir; // doesn't have to be normalized
+    double max_dist; // px
+};
+
+struct RayHit
+{
+    bool hit{false};
+    vec2<int> tile{0, 0}; // tile coords of what it hit
+    vec2<double> point{0.0, 0.0}; // px, where it entered the tile
+    vec2<int> normal{0, 0}; // side of the tile it came in through, {0, 0} if it started inside
+    double distance{0.0}; // px along the ray, max_dist if it didn't hit anything
+};
+
 struct Chunk
 {
     vec2<int> pos; // relaative position. real position = pos.x * TILE_SIZE * CHUNK_SIZE, pos.y * TILE_SIZE * CHUNK_SIZE
@@ -258,6 +294,29 @@ private:
     
     std::vector<Spring*> _Springs;
 
+    // dense copy of which tiles are solid, so lookups don't need to search through a chunk
+    std::vector<uint8_t> _Solid{std::vector<uint8_t>(LEVEL_TILE_WIDTH * LEVEL_TILE_HEIGHT, 0)};
+    // same for tile lookups, points into the chunks, rebuilt after loading
+    std::vector<Tile*> _TileGrid{std::vector<Tile*>(LEVEL_TILE_WIDTH * LEVEL_TILE_HEIGHT, nullptr)};
+
+    void buildTileGrid()
+    {
+        std::fill(_TileGrid.begin(), _TileGrid.end(), nullptr);
+        for (Chunk& chunk : _Chunks)
+        {
+            for (Tile& tile : chunk.tiles)
+            {
+                if (0 <= tile.pos.x && tile.pos.x < LEVEL_TILE_WIDTH && 0 <= tile.pos.y && tile.pos.y < LEVEL_TILE_HEIGHT)
+                {
+                    Tile*& slot{_TileGrid[tile.pos.y * LEVEL_TILE_WIDTH + tile.pos.x]};
+                    if (slot == nullptr) // first one wins, same as searching the chunk
+                    {
+                        slot = &tile;
+                    }
+                }
+            }
+        }
+    }
 
 public:
 
@@ -294,23 +353,122 @@ public:
         return nullptr;
     }
 
-    Tile* getTileAt(const double x, const double y)
+    // tile coords, anything outside the level counts as solid
+    bool isSolid(const int tileX, const int tileY) const
+    {
+        if (0 <= tileX && tileX < LEVEL_TILE_WIDTH && 0 <= tileY && tileY < LEVEL_TILE_HEIGHT)
+        {
+            return _Solid[tileY * LEVEL_TILE_WIDTH + tileX];
+        }
+        return true;
+    }
+
+    // tile coords, spikes & anything else in DANGER_TILES
+    bool isDanger(const int tileX, const int tileY)
+    {
+        Tile* tile{getTileAt(tileX * TILE_SIZE, tileY * TILE_SIZE)};
+        return tile != nullptr && Util::elementIn<TileType, std::size(DANGER_TILES)>(tile->type, DANGER_TILES);
+    }
+
+    // tile coords, out of bounds never blocks a ray (it just stops)
+    bool blocksRay(const int tileX, const int tileY, const uint8_t mask) const
+    {
+        const int i{tileY * LEVEL_TILE_WIDTH + tileX};
+        if ((mask & RAY_SOLID) && _Solid[i])
+        {
+            return true;
+        }
+        return (mask & RAY_DANGER) && _TileGrid[i] != nullptr && Util::elementIn<TileType, std::size(DANGER_TILES)>(_TileGrid[i]->type, DANGER_TILES);
+    }
+
+    // walks the tile grid along the ray one tile at a time (DDA), and stops at the first tile in mask
+    RayHit raycast(const Ray& ray, const uint8_t mask = RAY_SOLID) const
     {
-        Chunk* chunk{getChunkAt(x, y)};
-        if (chunk != nullptr)
+        RayHit hit{};
+        hit.distance = ray.max_dist;
+        const double length{std::sqrt(ray.dir.x * ray.dir.x + ray.dir.y * ray.dir.y)};
+        if (length <= 0.0)
         {
-            for (std::size_t i{0}; i < chunk->tiles.size(); ++i)
+            return hit;
+        }
+        const vec2<double> dir{ray.dir.x / length, ray.dir.y / length};
+        int x{static_cast<int>(std::floor(ray.origin.x / TILE_SIZE))};
+        int y{static_cast<int>(std::floor(ray.origin.y / TILE_SIZE))};
+        const int step_x{dir.x > 0.0 ? 1 : -1};
+        const int step_y{dir.y > 0.0 ? 1 : -1};
+        // distance along the ray to the next vertical & horizontal tile edge, and between edges
+        const double delta_x{dir.x != 0.0 ? TILE_SIZE / std::abs(dir.x) : INFINITY};
+        const double delta_y{dir.y != 0.0 ? TILE_SIZE / std::abs(dir.y) : INFINITY};
+        double next_x{dir.x != 0.0 ? ((x + (step_x > 0 ? 1 : 0)) * TILE_SIZE - ray.origin.x) / dir.x : INFINITY};
+        double next_y{dir.y != 0.0 ? ((y + (step_y > 0 ? 1 : 0)) * TILE_SIZE - ray.origin.y) / dir.y : INFINITY};
+        double t{0.0};
+        vec2<int> normal{0, 0};
+        while (t <= ray.max_dist)
+        {
+            if (x < 0 || x >= LEVEL_TILE_WIDTH || y < 0 || y >= LEVEL_TILE_HEIGHT)
             {
-                Tile* tile = &(chunk->tiles[i]);
-                int tileX {static_cast<int>(std::floor(x / (double)TILE_SIZE))};
-                int tileY {static_cast<int>(std::floor(y / (double)TILE_SIZE))};
-                //std::cout << tileX << '\t' << tileY << '\n';
-                if (tileX == tile->pos.x && tileY == tile->pos.y)
-                {
-                    return tile;
-                }
+                return hit;
+            }
+            if (blocksRay(x, y, mask))
+            {
+                hit.hit = true;
+                hit.tile = {x, y};
+                hit.point = {ray.origin.x + dir.x * t, ray.origin.y + dir.y * t};
+                hit.normal = normal;
+                hit.distance = t;
+                return hit;
+            }
+            if (next_x < next_y)
+            {
+                x += step_x;
+                t = next_x;
+                next_x += delta_x;
+                normal = {-step_x, 0};
+            } else {
+                y += step_y;
+                t = next_y;
+                next_y += delta_y;
+                normal = {0, -step_y};
             }
         }
+        return hit;
+    }
+
+    // same as raycast, but from a to b
+    RayHit segment(const vec2<double>& a, const vec2<double>& b, const uint8_t mask = RAY_SOLID) const
+    {
+        const vec2<double> delta{b.x - a.x, b.y - a.y};
+        return raycast(Ray{a, delta, std::sqrt(delta.x * delta.x + delta.y * delta.y)}, mask);
+    }
+
+    bool hasLineOfSight(const vec2<double>& a, const vec2<double>& b) const
+    {
+        return !segment(a, b).hit;
+    }
+
+    // lots of rays at once, hits[i] is for rays[i]
+    void raycast(const std::vector<Ray>& rays, std::vector<RayHit>& hits, const uint8_t mask = RAY_SOLID) const
+    {
+        hits.resize(rays.size());
+        for (std::size_t i{0}; i < rays.size(); ++i)
+        {
+            hits[i] = raycast(rays[i], mask);
+        }
+    }
+
+    const std::vector<uint8_t>& getSolidGrid() const
+    {
+        return _Solid;
+    }
+
+    Tile* getTileAt(const double x, const double y)
+    {
+        const int tileX{static_cast<int>(std::floor(x / (double)TILE_SIZE))};
+        const int tileY{static_cast<int>(std::floor(y / (double)TILE_SIZE))};
+        if (0 <= tileX && tileX < LEVEL_TILE_WIDTH && 0 <= tileY && tileY < LEVEL_TILE_HEIGHT)
+        {
+            return _TileGrid[tileY * LEVEL_TILE_WIDTH + tileX];
+        }
         return nullptr;
     }
 
@@ -439,7 +597,13 @@ public:
         // load data
         std::ifstream f{path};
         json data = json::parse(f);
+        f.close();
+        loadFromJson(data);
+    }
 
+    // the level as parsed from a map file, benchmarks build these in memory
+    void loadFromJson(const json& data)
+    {
         // clear chunks
         for (std::size_t i{0}; i < LEVEL_WIDTH * LEVEL_HEIGHT; ++i)
         {
@@ -451,6 +615,7 @@ public:
         }
 
         _Springs.clear();
+        std::fill(_Solid.begin(), _Solid.end(), 0);
 
         // the leaf spawner rects
         std::vector<LeafSpawner> leaf_spawner_rects{};        
@@ -469,6 +634,15 @@ public:
                 if (tile["type"] != 3) // grass key
                 {
                     chunk->tiles.push_back(Tile{{tile["pos"][0], tile["pos"][1]}, getTileType(tile["type"]), tile["variant"]});
+                    if (Util::elementIn<TileType, std::size(SOLID_TILES)>(chunk->tiles.back().type, SOLID_TILES))
+                    {
+                        const int tileX{tile["pos"][0]};
+                        const int tileY{tile["pos"][1]};
+                        if (0 <= tileX && tileX < LEVEL_TILE_WIDTH && 0 <= tileY && tileY < LEVEL_TILE_HEIGHT)
+                        {
+                            _Solid[tileY * LEVEL_TILE_WIDTH + tileX] = 1;
+                        }
+                    }
                     if (tile["type"] == 0 && (tile["variant"] == 1 || tile["variant"] == 13))
                     {
                         leaf_spawner_rects.push_back(LeafSpawner{{static_cast<int>(tile["pos"][0]) * TILE_SIZE, static_cast<int>(tile["pos"][1]) * TILE_SIZE, TILE_SIZE, TILE_SIZE}, false});
@@ -544,10 +718,10 @@ public:
         _LeafManager.free();
         _LeafManager.loadRects(leaf_spawner_rects);
 
-        f.close();
+        buildTileGrid();
     }
 
-    void render(const int scrollX, const int scrollY, SDL_Window* window, SDL_Renderer* renderer, TexMan* texman, const int width, const int height)
+    void render(const int scrollX, const int scrollY, SDL_Window* window, SpriteBatch& batch, TexMan* texman, const int width, const int height)
     {
         // location in relative chunk coords
         int chunkX {static_cast<int>(std::floor((double)scrollX / (double)TILE_SIZE / (double)CHUNK_SIZE))};
@@ -562,22 +736,22 @@ public:
                 {
                     int chunk_idx{targetY * LEVEL_WIDTH + targetX};
                     DecorChunk* decor{&(_DecorChunks[chunk_idx])};
-                    renderDecorChunk(decor, scrollX, scrollY, window, renderer, texman);
+                    renderDecorChunk(decor, scrollX, scrollY, window, batch, texman);
                     Chunk* chunk{&(_Chunks[chunk_idx])};
-                    renderChunk(chunk, scrollX, scrollY, window, renderer, texman);
+                    renderChunk(chunk, scrollX, scrollY, window, batch, texman);
                 }
             }
         }
 
         for (Spring* spring : _Springs)
         {
-            spring->render(scrollX, scrollY, renderer, texman);
+            spring->render(scrollX, scrollY, batch, texman);
         }
     }
 
-    void updateLeaves(const double& time_step, const int scrollX, const int scrollY, const int width, const int height, TexMan* texman, SDL_Renderer* renderer)
+    void updateLeaves(const double& time_step, const int scrollX, const int scrollY, const int width, const int height, TexMan* texman, SpriteBatch& batch)
     {
-        _LeafManager.update(time_step, scrollX, scrollY, width, height, texman, renderer);
+        _LeafManager.update(time_step, scrollX, scrollY, width, height, texman, batch);
     }
 
     void handleSprings(const double& time_step)
@@ -641,7 +815,7 @@ public:
         return clip;
     }
 
-    void renderChunk(Chunk* chunk, const int scrollX, const int scrollY, SDL_Window* window, SDL_Renderer* renderer, TexMan* texman)
+    void renderChunk(Chunk* chunk, const int scrollX, const int scrollY, SDL_Window* window, SpriteBatch& batch, TexMan* texman)
     {
         for (const auto& tile : chunk->tiles)
         {
@@ -651,22 +825,22 @@ public:
             y = (variant - x) / w
             */
             SDL_Rect clip{getClipRect(tile)};
-            getTileTex(tile, texman)->render(tile.pos.x * TILE_SIZE - scrollX, tile.pos.y * TILE_SIZE - scrollY, renderer, &clip);
+            batch.draw(*getTileTex(tile, texman), SpriteLayer::TILES, tile.pos.x * TILE_SIZE - scrollX, tile.pos.y * TILE_SIZE - scrollY, &clip);
         }
     }
 
-    void renderDecorChunk(DecorChunk* chunk, const int scrollX, const int scrollY, SDL_Window* window, SDL_Renderer* renderer, TexMan* texman)
+    void renderDecorChunk(DecorChunk* chunk, const int scrollX, const int scrollY, SDL_Window* window, SpriteBatch& batch, TexMan* texman)
     {
         for (const Decor& tile : chunk->decor)
         {
             SDL_Rect clip{getDecorClipRect(tile)};
-            getTileTex(tile, texman)->render(tile.pos.x - scrollX, tile.pos.y - scrollY, renderer, &clip);
+            batch.draw(*getTileTex(tile, texman), SpriteLayer::DECOR, tile.pos.x - scrollX, tile.pos.y - scrollY, &clip);
         }
     }
 
-    void handleGrass(const int scrollX, const int scrollY, SDL_Renderer* renderer, TexMan* texman, const int width, const int height, SDL_Rect* entity_rect, const double& time_step)
+    void handleGrass(const int scrollX, const int scrollY, SpriteBatch& batch, TexMan* texman, const int width, const int height, const Broadphase& bodies, const double& time_step)
     {
-        _GrassManager->renderGrass(scrollX, scrollY, renderer, texman, width, height, entity_rect, time_step);
+        _GrassManager->renderGrass(scrollX, scrollY, batch, texman, width, height, bodies, time_step);
     }
 };
 
@@ -0,0 +1,126 @@
+#ifndef TRIGGERS_H
+#define TRIGGERS_H
+
+#include "SDL2/SDL.h"
+
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+
+#include "./constants.hpp"
+#include "./util.hpp"
+#include "./spatial.hpp"
+
+// static things in the level that do something when you're inside them
+enum class TriggerType : uint8_t
+{
+    SPRING,
+    PORTAL,
+    WATER,
+    LAVA,
+    TOTAL
+};
+
+enum class TriggerEvent : uint8_t
+{
+    ENTER, // wasn't inside last update
+    STAY,
+    EXIT // was inside last update, isn't now
+};
+
+struct Trigger
+{
+    TriggerType type;
+    SDL_Rect rect; // volume, things that move a bit (springs, the portal) cover everywhere they can get to
+    uint32_t index; // into whatever list the type lives in (World::getSprings(), WaterManager::getWater()...)
+};
+
+struct TriggerHit
+{
+    int trigger;
+    TriggerEvent event;
+};
+
+// what one body was inside as of its last update, everything that moves through triggers keeps one
+struct TriggerState
+{
+    std::vector<int> inside{}; // sorted
+    std::vector<TriggerHit> hits{}; // from the last update
+    std::vector<int> found{}; // query scratch
+
+    void clear()
+    {
+        inside.clear();
+        hits.clear();
+    }
+};
+
+// spatial index over the trigger volumes, filled once when a level loads. Each update is one grid
+// query for the body's rect, diffed against what it was inside last time to get the events
+class TriggerIndex
+{
+private:
+    std::vector<Trigger> _Triggers{};
+    SpatialGrid<int> _Grid{};
+
+public:
+    TriggerIndex()
+    {
+        init(LEVEL_TILE_WIDTH * TILE_SIZE, LEVEL_TILE_HEIGHT * TILE_SIZE);
+    }
+
+    // width & height in px
+    void init(const int width, const int height)
+    {
+        _Grid.init(width, height, CHUNK_SIZE * TILE_SIZE);
+        _Triggers.clear();
+    }
+
+    // bodies' TriggerStates need clearing too, their indices are stale after this
+    void clear()
+    {
+        _Grid.clear();
+        _Triggers.clear();
+    }
+
+    std::size_t size() const {return _Triggers.size();}
+
+    int add(const TriggerType type, const SDL_Rect& rect, const uint32_t index)
+    {
+        const int trigger{static_cast<int>(_Triggers.size())};
+        _Triggers.push_back(Trigger{type, rect, index});
+        _Grid.insert(rect, trigger);
+        return trigger;
+    }
+
+    const Trigger& get(const int trigger) const {return _Triggers[trigger];}
+
+    void update(const SDL_Rect& rect, TriggerState& state) const
+    {
+        state.found.clear();
+        _Grid.query(rect, state.found);
+        state.found.erase(std::remove_if(state.found.begin(), state.found.end(), [&](const int t){return !Util::checkCollision(&_Triggers[t].rect, &rect);}), state.found.end());
+        std::sort(state.found.begin(), state.found.end());
+
+        // both lists are sorted, so walk them together
+        state.hits.clear();
+        std::size_t a{0};
+        std::size_t b{0};
+        while (a < state.inside.size() || b < state.found.size())
+        {
+            if (b == state.found.size() || (a < state.inside.size() && state.inside[a] < state.found[b]))
+            {
+                state.hits.push_back(TriggerHit{state.inside[a++], TriggerEvent::EXIT});
+            } else if (a == state.inside.size() || state.found[b] < state.inside[a])
+            {
+                state.hits.push_back(TriggerHit{state.found[b++], TriggerEvent::ENTER});
+            } else {
+                state.hits.push_back(TriggerHit{state.found[b++], TriggerEvent::STAY});
+                ++a;
+            }
+        }
+        state.inside.swap(state.found);
+    }
+};
+
+#endif
@@ -6,6 +6,7 @@
 #include <vector>
 #include <cstdlib>
 #include <cmath>
+#include <algorithm>
 
 #include "./vec2.hpp"
 
@@ -39,6 +40,32 @@ namespace Util {
         return static_cast<double>((double)std::rand() / (RAND_MAX));
     }
 
+    // number of events in an interval where mean events are expected, so callers can roll once instead of once per thing
+    inline int poisson(const double mean)
+    {
+        if (mean <= 0.0)
+        {
+            return 0;
+        }
+        if (mean > 30.0)
+        {
+            // close enough to a normal distribution by now
+            const double u{std::max(1e-9, random())};
+            const double v{random()};
+            const double n{std::sqrt(-2.0 * std::log(u)) * std::cos(2.0 * M_PI * v)};
+            return std::max(0, static_cast<int>(std::round(mean + n * std::sqrt(mean))));
+        }
+        const double limit{std::exp(-mean)};
+        double product{random()};
+        int count{0};
+        while (product > limit)
+        {
+            ++count;
+            product *= random();
+        }
+        return count;
+    }
+
     template <typename T>
     inline double distance(vec2<T> vec1, vec2<T> vec2)
     {
@@ -73,7 +100,7 @@ namespace Util {
     }
 
     template <typename type>
-    std::vector<int> get_water_indices(std::vector<type> vertices)
+    std::vector<int> get_water_indices(const std::vector<type>& vertices)
     {
         int T{static_cast<int>(vertices.size())};
         int H{static_cast<int>((T + 1) / 2)};
@@ -1,135 +1,160 @@
 #include "./water.hpp"
 
-Water::Water(vec2<int> pos, vec2<int> dimensions, double spacing)
- : _pos{pos}, _dimensions{dimensions}, _spacing{spacing}
+void FluidSurface::init(vec2<int> pos, vec2<int> dimensions, const WaveConfig& config)
 {
+    clear();
+    _pos = pos;
+    _dimensions = dimensions;
     _Rect = SDL_Rect{pos.x * TILE_SIZE, pos.y * TILE_SIZE, dimensions.x * TILE_SIZE, dimensions.y * TILE_SIZE};
-    loadSprings();
-    timer.start();
+    _Surface.init(static_cast<double>(pos.x * TILE_SIZE), static_cast<double>(pos.y * TILE_SIZE) + 4.0, static_cast<double>(dimensions.x * TILE_SIZE), config); // remember relative tile dimensions
+    _sleeping = false;
+    _rest = 0.0;
 }
 
-Water::~Water()
+void FluidSurface::load(vec2<int> pos, vec2<int> dimensions, const WaveConfig& config, const SDL_Color col)
 {
-    free();
-}
+    init(pos, dimensions, config);
+    const int num{_Surface.getSize()};
 
-void Water::free()
-{
-    // dirty >:)
-    for (WaterSpring*& spring : _Springs)
+    // the colour and uvs never change, so only the positions get written each frame
+    _Points.resize(num * 2);
+    for (int i{0}; i < num * 2; ++i)
     {
-        delete spring;
+        _Points[i] = SDL_Vertex{{0.0f, 0.0f}, col, {static_cast<float>(i % num) / static_cast<float>(std::max(1, num - 1)), 0.0f}};
     }
-    _Springs.clear();
-    std::cout << "Water freed!\n";
+    _Indices = Util::get_water_indices<SDL_Vertex>(_Points);
+    _Line.resize(num);
 }
 
-void Water::loadSprings()
+void FluidSurface::clear()
 {
-    free();
-    int num{static_cast<int>(std::floor(static_cast<double>(_dimensions.x * TILE_SIZE) / _spacing)) + 1}; // remember relative tile dimensions
+    _Surface.clear();
+    _Points.clear();
+    _Indices.clear();
+    _Line.clear();
+}
+
+bool FluidSurface::isVisible(const int scrollX, const int scrollY, const int width, const int height)
+{
+    SDL_Rect view{scrollX - FLUID_VIEW_MARGIN, scrollY - FLUID_VIEW_MARGIN, width + FLUID_VIEW_MARGIN * 2, height + FLUID_VIEW_MARGIN * 2};
+    return Util::checkCollision(&_Rect, &view);
+}
+
+bool FluidSurface::isDisturbed(Player* player)
+{
+    // the surface sits a few pixels above the rect, so check a bit higher up too
+    SDL_Rect area{_Rect.x, _Rect.y - TILE_SIZE, _Rect.w, _Rect.h + TILE_SIZE};
+    return Util::checkCollision(&area, player->getRect());
+}
+
+void FluidSurface::disturb(const double& time_step, Player* player)
+{
+    const SDL_Rect* rect{player->getRect()};
+    _Surface.disturbArea(rect->x, rect->y, rect->w, rect->h, player->getVelX(), player->getVelY(), time_step);
+}
+
+void FluidSurface::sleep()
+{
+    _Surface.reset();
+    _sleeping = true;
+}
+
+void FluidSurface::wake()
+{
+    _Surface.resetToAmbient(0.5);
+    _sleeping = false;
+    _rest = 0.0;
+}
+
+bool FluidSurface::rest(const double& time_step, const bool settled, const bool visible)
+{
+    // only bodies nobody can see are allowed to doze off
+    _rest = (settled && !visible) ? _rest + time_step : 0.0;
+    return _rest > FLUID_SLEEP_TIME;
+}
+
+void FluidSurface::updateBuffers(const int scrollX, const int scrollY)
+{
+    const int num{_Surface.getSize()};
+    const float bottom{static_cast<float>((_pos.y + _dimensions.y) * TILE_SIZE) - static_cast<float>(scrollY)};
     for (int i{0}; i < num; ++i)
     {
-        _Springs.push_back(new WaterSpring{{static_cast<double>(_pos.x * TILE_SIZE) + _spacing * (double)i, static_cast<double>(_pos.y * TILE_SIZE) + 4.0}, static_cast<double>(_pos.y * TILE_SIZE) + 4.0});
+        const double x{_Surface.getX(i)};
+        const double y{_Surface.getY(i)};
+        _Points[i].position = SDL_FPoint{static_cast<float>(x - scrollX), static_cast<float>(y - scrollY)};
+        _Points[num + i].position = SDL_FPoint{static_cast<float>(x - scrollX), bottom};
+        _Line[i] = SDL_Point{static_cast<int>(x) - scrollX, static_cast<int>(y) - scrollY};
     }
-    std::cout << "yo again\n";
 }
 
-SDL_Rect* Water::getRect()
+Water::Water(vec2<int> pos, vec2<int> dimensions, double spacing)
+ : _spacing{spacing}
 {
-    return &_Rect;
+    loadSprings(pos, dimensions);
 }
 
-void Water::updateSpring(WaterSpring* spring, WaterSpring* left, WaterSpring* right, const double& time_step)
+Water::~Water()
 {
-    double dh{spring->target_y - ((spring->pos.y - left->pos.y) + (spring->pos.y - right->pos.y)) - spring->pos.y};
-    if (std::abs(dh) < 0.01)
-    {
-        spring->pos.y = spring->target_y;
-    }
-    spring->vel += (dh - spring->vel) * time_step * _tension * 1.1;
-    spring->pos.y += spring->vel / 2.0 * time_step;
+    free();
 }
 
-void Water::update(const double& time_step, const int scrollX, const int scrollY, SDL_Renderer* renderer, TexMan* texman, Player* player)
+void Water::free()
 {
-    std::vector<SDL_Vertex> points{};
-    SDL_Color col{0x28, 0xca, 0xb1, 0xaa};
-    for (int i{0}; i < static_cast<int>(std::size(_Springs)); ++i)
-    {
-        WaterSpring* spring{_Springs[i]};
-        SDL_Rect spring_rect {static_cast<int>(spring->pos.x), static_cast<int>(spring->pos.y), 1, 1};
-        double time{static_cast<double>(timer.getTicks())};
-        if (Util::checkCollision(&spring_rect, player->getRect()))
-        {
-            if (std::abs(player->getVelY()) > 0.5 || std::abs(player->getVelX()) > 0.5)
-            {
-                if (std::abs(spring->target_y - spring->pos.y) < 3.0)
-                    spring->vel += (std::max(-3.0, std::min(8.0, player->getVelY() * 3.0)) + -std::abs(std::max(-3.0, std::min(3.0, player->getVelX())))) * 0.5 * time_step;
-            }
-        }
-        if (std::abs(spring->target_y - spring->pos.y) < 3.0)
-        {
-            spring->vel += std::sin(time * 0.002 + spring->pos.x * 0.6) * 0.05 * time_step;
-            spring->vel += std::cos(time * 0.005 + spring->pos.x * 0.8) * 0.02 * time_step;
-            spring->vel += std::cos(time * 0.006 + spring->pos.x * 0.7) * 0.03 * time_step;
-            // spring->vel += std::sin(time * 0.004 + spring->pos.x * 0.6) * 0.08;
-            // spring->vel += std::cos(time * 0.007 + spring->pos.x * 0.8) * 0.04;
-            // spring->vel += std::cos(time * 0.008 + spring->pos.x * 0.7) * 0.06;
-        }
+    _Body.clear();
+    std::cout << "Water freed!\n";
+}
 
-        updateSpring(spring, _Springs[std::max(0, std::min(static_cast<int>(std::size(_Springs)) - 1, i - 1))], _Springs[std::max(0, std::min(static_cast<int>(std::size(_Springs)) - 1, i + 1))], time_step);
-        points.push_back(SDL_Vertex{{static_cast<float>(spring->pos.x) - static_cast<float>(scrollX), static_cast<float>(spring->pos.y) - static_cast<float>(scrollY)}, col, {static_cast<float>(i) / static_cast<float>(static_cast<int>(std::size(_Springs)) - 1), 0.0f}});
-    }
+void Water::loadSprings(vec2<int> pos, vec2<int> dimensions)
+{
+    free();
+    WaveConfig config{WATER_WAVES};
+    config.spacing = _spacing;
+    _Body.load(pos, dimensions, config, WATER_COLOR);
+    std::cout << "yo again\n";
+}
 
-    for (int i{0}; i < static_cast<int>(std::size(_Springs)); ++i)
-    {
-        WaterSpring* spring{_Springs[i]};
-        points.push_back(SDL_Vertex{{static_cast<float>(spring->pos.x) - static_cast<float>(scrollX), static_cast<float>((_pos.y + _dimensions.y) * TILE_SIZE) - static_cast<float>(scrollY)}, col, {static_cast<float>(i) / static_cast<float>(static_cast<int>(std::size(_Springs)) - 1), 0.0f}});
-    }
-    std::vector<int> indices{Util::get_water_indices<SDL_Vertex>(points)};
-    // Util::printVector(indices);
-    // for (int i{0}; i < std::size(points); ++i)
-    // {
-    //     SDL_SetRenderDrawColor(renderer, 0x28, 0xca, 0xb1, 0xaa);
-    //     SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
-    //     SDL_RenderDrawPointF(renderer, points[i].position.x, points[i].position.y - 3.0f);
-    // }
-    SDL_SetRenderDrawColor(renderer, 0x28, 0xca, 0xb1, 0xaa);
-    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+bool Water::simulate(const double& time_step, Player* player)
+{
+    _Body.disturb(time_step, player);
+    _Body.getSurface().update(time_step);
+    return _Body.getSurface().isSettled(FLUID_REST_HEIGHT, FLUID_REST_VEL);
+}
+
+void Water::render(const int scrollX, const int scrollY, SDL_Renderer* renderer, TexMan* texman)
+{
+    _Body.updateBuffers(scrollX, scrollY);
+
+    RenderState::setDrawColor(renderer, WATER_COLOR.r, WATER_COLOR.g, WATER_COLOR.b, WATER_COLOR.a);
+    RenderState::setDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
     texman->particle.setBlendMode(SDL_BLENDMODE_BLEND);
-    Polygons::renderPolygon(renderer, texman->particle.getTexture(), points, indices);
-    SDL_Rect fillRect{_pos.x * TILE_SIZE - scrollX, _pos.y * TILE_SIZE - scrollY, _dimensions.x * TILE_SIZE, _dimensions.y * TILE_SIZE};
-    SDL_SetRenderDrawColor(renderer, 0x28, 0xca, 0xb1, 0xaa);
+    Polygons::renderPolygon(renderer, texman->particle.bindTexture(), _Body.getPoints(), _Body.getIndices());
     texman->particle.setBlendMode(SDL_BLENDMODE_NONE);
-    
-    std::vector<SDL_Point> line;
-    line.resize(std::size(_Springs));
-    for (int i{0}; i < static_cast<int>(std::size(_Springs)); ++i)
-    {
-        line[i] = SDL_Point{static_cast<int>(_Springs[i]->pos.x) - scrollX, static_cast<int>(_Springs[i]->pos.y) - scrollY};
-    }
-    SDL_SetRenderDrawColor(renderer, 0xb2, 0xde, 0xd8, 0x88);
+
+    const std::vector<SDL_Point>& line{_Body.getLine()};
+    RenderState::setDrawColor(renderer, WATER_LINE_COLOR.r, WATER_LINE_COLOR.g, WATER_LINE_COLOR.b, WATER_LINE_COLOR.a);
     SDL_RenderDrawLines(renderer, line.data(), static_cast<int>(line.size()));
-    //SDL_RenderFillRect(renderer, &fillRect);
-    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
+    RenderState::setDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
+}
 
-    const bool in_water{Util::checkCollision(getRect(), player->getRect())};
-    if (in_water)
+void Water::update(const double& time_step, const int scrollX, const int scrollY, const int width, const int height, SDL_Renderer* renderer, TexMan* texman, Player* player)
+{
+    const bool visible{_Body.isVisible(scrollX, scrollY, width, height)};
+    if (_Body.getSleeping() && (visible || _Body.isDisturbed(player)))
     {
-        if (player->getInWater() > 120.0)
-        {
-            texman->SFX_water_in.play();
-        }
-        player->setInWater(0.0);
-        return;
-    } else {
-        if (player->getInWater() > 6.0 && player->getInWater() < 120.0)
+        _Body.wake();
+    }
+    if (!_Body.getSleeping())
+    {
+        const bool settled{simulate(time_step, player)};
+        if (_Body.rest(time_step, settled, visible))
         {
-            texman->SFX_water_out.play();
-            player->setInWater(130.0);
+            _Body.sleep();
         }
     }
+    if (visible)
+    {
+        render(scrollX, scrollY, renderer, texman);
+    }
 }
 
 WaterManager::WaterManager(const char* path)
@@ -168,20 +193,18 @@ void WaterManager::loadFromFile(const char* path)
     f.close();
 }
 
-void WaterManager::update(const double& time_step, const int scrollX, const int scrollY, SDL_Renderer* renderer, TexMan* texman, Player* player)
+void WaterManager::update(const double& time_step, const int scrollX, const int scrollY, const int width, const int height, SDL_Renderer* renderer, TexMan* texman, Player* player)
 {
     for (std::size_t i{0}; i < _Water.size(); ++i)
     {
-        _Water[i]->update(time_step, scrollX, scrollY, renderer, texman, player);
+        _Water[i]->update(time_step, scrollX, scrollY, width, height, renderer, texman, player);
     }
 }
 
 Lava::Lava(vec2<int> pos, vec2<int> dimensions, double spacing)
- : _pos{pos}, _dimensions{dimensions}, _spacing{spacing}
+ : _spacing{spacing}
 {
-    _Rect = SDL_Rect{pos.x * TILE_SIZE, pos.y * TILE_SIZE, dimensions.x * TILE_SIZE, dimensions.y * TILE_SIZE};
-    loadSprings();
-    timer.start();
+    loadSprings(pos, dimensions);
 }
 
 Lava::~Lava()
@@ -191,165 +214,133 @@ Lava::~Lava()
 
 void Lava::free()
 {
-    // dirty >:)
-    for (WaterSpring*& spring : _Springs)
-    {
-        delete spring;
-    }
-    _Springs.clear();
+    _Body.clear();
+    _Glow.clear();
     std::cout << "Lava freed!\n";
 }
 
 void Lava::addGlow(vec2<double> pos, vec2<double> vel)
 {
-    _Glow.push_back(new LavaGlow{pos, vel, 10.0 - Util::random()});
+    // capped at what loadSprings reserved, so the buffer never grows during play
+    if (_Glow.size() < _Glow.capacity())
+    {
+        _Glow.push_back(LavaGlow{pos, vel, 10.0 - Util::random()});
+    }
 }
 
-void Lava::loadSprings()
+void Lava::loadSprings(vec2<int> pos, vec2<int> dimensions)
 {
     free();
-    int num{static_cast<int>(std::floor(static_cast<double>(_dimensions.x * TILE_SIZE) / _spacing)) + 1}; // remember relative tile dimensions
-    for (int i{0}; i < num; ++i)
-    {
-        _Springs.push_back(new WaterSpring{{static_cast<double>(_pos.x * TILE_SIZE) + _spacing * (double)i, static_cast<double>(_pos.y * TILE_SIZE) + 4.0}, static_cast<double>(_pos.y * TILE_SIZE) + 4.0});
-    }
+    WaveConfig config{LAVA_WAVES};
+    config.spacing = _spacing;
+    _Body.load(pos, dimensions, config, SDL_Color{192, 41, 49, 150});//{0xff, 0x53, 0x53, 0xbb};
+    // glows live ~25 frames so this is rarely reached, addGlow drops any past it
+    _Glow.reserve(_Body.getSurface().getSize());
     std::cout << "yo again\n";
 }
 
-SDL_Rect* Lava::getRect()
+void Lava::sleep()
 {
-    return &_Rect;
+    _Body.sleep();
+    // glows are purely cosmetic, no point keeping them around
+    _Glow.clear();
 }
 
-void Lava::updateSpring(WaterSpring* spring, WaterSpring* left, WaterSpring* right, const double& time_step)
+bool Lava::simulate(const double& time_step, Player* player, const bool visible)
 {
-    double dh{spring->target_y - ((spring->pos.y - left->pos.y) + (spring->pos.y - right->pos.y)) * 1.5 - spring->pos.y};
-    if (std::abs(dh) < 0.01)
+    WaveSurface& surface{_Body.getSurface()};
+    _Body.disturb(time_step, player);
+    surface.update(time_step);
+    if (visible)
     {
-        spring->pos.y = spring->target_y;
+        const int num{surface.getSize()};
+        for (int i{0}; i < num; ++i)
+        {
+            if (Util::random() * 7000.0 / time_step < 128.0)
+            {
+                addGlow({surface.getX(i), surface.getY(i)}, {0.0, Util::random() * -1.0});
+            }
+        }
     }
-    spring->vel += (dh - spring->vel) * time_step * _tension * 1.1;
-    spring->pos.y += spring->vel / 2.0 * time_step;
+    return surface.isSettled(FLUID_REST_HEIGHT, FLUID_REST_VEL);
 }
 
-void Lava::update(const double& time_step, const int scrollX, const int scrollY, SDL_Renderer* renderer, TexMan* texman, Player* player)
+void Lava::render(const double& time_step, const int scrollX, const int scrollY, SDL_Renderer* renderer, TexMan* texman)
 {
-    for (std::size_t i{0}; i < _Glow.size(); ++i)
+    for (LavaGlow& glow : _Glow)
     {
-        LavaGlow* glow{_Glow[i]};
-        glow->vel.x *= 0.9;
-        glow->vel.y *= 0.9;
-        glow->pos.x += glow->vel.x * time_step;
-        glow->pos.y += glow->vel.y * time_step;
-        glow->size -= 0.4 * time_step; // decay
-        if (glow->size <= 0.0)
+        glow.vel.x *= 0.9;
+        glow.vel.y *= 0.9;
+        glow.pos.x += glow.vel.x * time_step;
+        glow.pos.y += glow.vel.y * time_step;
+        glow.size -= 0.4 * time_step; // decay
+        if (glow.size <= 0.0)
         {
-            if (glow->size < -0.5 * Util::random())
-            {
-                // flash effect
-                // texman->lightTex.setBlendMode(SDL_BLENDMODE_ADD);
-                // texman->lightTex.setAlpha(static_cast<Uint8>(static_cast<int>(255.0)));
-                // texman->lightTex.setColor(0xff, 0x53, 0x53);
-                // SDL_Rect renderQuad{static_cast<int>(glow->pos.x) - 1 - scrollX, static_cast<int>(glow->pos.y) - 1 - scrollY, 3, 3};
-                // SDL_RenderCopyEx(renderer, texman->lightTex.getTexture(), NULL, &renderQuad, 0, NULL, SDL_FLIP_NONE);
-                delete glow;
-                _Glow[i] = nullptr;
-            }
+            glow.dead = glow.size < -0.5 * Util::random();
         } else {
             texman->lightTex.setBlendMode(SDL_BLENDMODE_ADD);
-            texman->lightTex.setAlpha(static_cast<Uint8>(static_cast<int>(glow->size / 10.0 * 255.0)));
+            texman->lightTex.setAlpha(static_cast<Uint8>(static_cast<int>(glow.size / 10.0 * 255.0)));
             texman->lightTex.setColor(0xff, 0x53, 0x53); //0xd1, 0xa6, 0x7e
-            SDL_Rect renderQuad{static_cast<int>(glow->pos.x) - 1 - scrollX, static_cast<int>(glow->pos.y) - 1 - scrollY, 3, 3};
-            SDL_RenderCopyEx(renderer, texman->lightTex.getTexture(), NULL, &renderQuad, 0, NULL, SDL_FLIP_NONE);
+            SDL_Rect renderQuad{static_cast<int>(glow.pos.x) - 1 - scrollX, static_cast<int>(glow.pos.y) - 1 - scrollY, 3, 3};
+            texman->lightTex.renderStretched(renderQuad, renderer);
         }
     }
     // reset color
-    //texman->circle.setColor(246, 231, 156);
     texman->lightTex.setColor(246, 231, 156);
-    _Glow.erase(std::remove_if(_Glow.begin(), _Glow.end(), [](LavaGlow* glow){return (glow == nullptr);}), _Glow.end());
-    std::vector<SDL_Vertex> points{};
-    SDL_Color col{192, 41, 49, 150};//{0xff, 0x53, 0x53, 0xbb};
-    for (int i{0}; i < static_cast<int>(std::size(_Springs)); ++i)
+    _Glow.erase(std::remove_if(_Glow.begin(), _Glow.end(), [](const LavaGlow& glow){return glow.dead;}), _Glow.end());
+
+    _Body.updateBuffers(scrollX, scrollY);
+
+    RenderState::setDrawBlendMode(renderer, SDL_BLENDMODE_ADD);
+    texman->particle.setBlendMode(SDL_BLENDMODE_ADD);
+    Polygons::renderPolygon(renderer, texman->particle.bindTexture(), _Body.getPoints(), _Body.getIndices());
+    texman->particle.setBlendMode(SDL_BLENDMODE_NONE);
+
+    std::vector<SDL_Point>& line{_Body.getLine()};
+    RenderState::setDrawColor(renderer, 0xff, 0xff, 0xff, 0xaa);
+    SDL_RenderDrawLines(renderer, line.data(), static_cast<int>(line.size()));
+    // glow gradient under the surface, shift the same line buffer down one pixel at a time
+    const int depth{_Body.getDimensions().y * TILE_SIZE - 8};
+    RenderState::setDrawBlendMode(renderer, SDL_BLENDMODE_ADD);
+    for (int j{0}; j < depth; ++j)
     {
-        WaterSpring* spring{_Springs[i]};
-        SDL_Rect spring_rect {static_cast<int>(spring->pos.x), static_cast<int>(spring->pos.y), 1, 1};
-        double time{static_cast<double>(timer.getTicks())};
-        if (Util::checkCollision(&spring_rect, player->getRect()))
-        {
-            if (std::abs(player->getVelY()) > 0.5 || std::abs(player->getVelX()) > 0.5)
-            {
-                if (std::abs(spring->target_y - spring->pos.y) < 3.0)
-                    spring->vel += (std::max(-3.0, std::min(8.0, player->getVelY() * 3.0)) + -std::abs(std::max(-3.0, std::min(3.0, player->getVelX())))) * 0.5 * time_step;
-            }
-        }
-        if (Util::random() * 7000.0 / time_step < 128.0)
-        {
-            addGlow(spring->pos, {0.0, Util::random() * -1.0});
-        }
-        if (std::abs(spring->target_y - spring->pos.y) < 3.0)
+        for (SDL_Point& point : line)
         {
-            spring->vel += std::sin(time * 0.002 + spring->pos.x * 0.6) * 0.05 * time_step;
-            spring->vel += std::cos(time * 0.005 + spring->pos.x * 0.8) * 0.02 * time_step;
-            spring->vel += std::cos(time * 0.006 + spring->pos.x * 0.7) * 0.03 * time_step;
-            // spring->vel += std::sin(time * 0.004 + spring->pos.x * 0.6) * 0.08;
-            // spring->vel += std::cos(time * 0.007 + spring->pos.x * 0.8) * 0.04;
-            // spring->vel += std::cos(time * 0.008 + spring->pos.x * 0.7) * 0.06;
+            ++point.y;
         }
-
-        updateSpring(spring, _Springs[std::max(0, std::min(static_cast<int>(std::size(_Springs)) - 1, i - 1))], _Springs[std::max(0, std::min(static_cast<int>(std::size(_Springs)) - 1, i + 1))], time_step);
-        points.push_back(SDL_Vertex{{static_cast<float>(spring->pos.x) - static_cast<float>(scrollX), static_cast<float>(spring->pos.y) - static_cast<float>(scrollY)}, col, {static_cast<float>(i) / static_cast<float>(static_cast<int>(std::size(_Springs)) - 1), 0.0f}});
+        RenderState::setDrawColor(renderer, 0xff, 0x76, 0x00, static_cast<Uint8>(static_cast<int>(static_cast<double>(depth - j) / static_cast<double>(depth) * 200.0)));
+        SDL_RenderDrawLines(renderer, line.data(), static_cast<int>(line.size()));
     }
+    RenderState::setDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
+}
 
-    for (int i{0}; i < static_cast<int>(std::size(_Springs)); ++i)
-    {
-        WaterSpring* spring{_Springs[i]};
-        points.push_back(SDL_Vertex{{static_cast<float>(spring->pos.x) - static_cast<float>(scrollX), static_cast<float>((_pos.y + _dimensions.y) * TILE_SIZE) - static_cast<float>(scrollY)}, col, {static_cast<float>(i) / static_cast<float>(static_cast<int>(std::size(_Springs)) - 1), 0.0f}});
-    }
-    std::vector<int> indices{Util::get_water_indices<SDL_Vertex>(points)};
-    // Util::printVector(indices);
-    // for (int i{0}; i < std::size(points); ++i)
-    // {
-    //     SDL_SetRenderDrawColor(renderer, 0x28, 0xca, 0xb1, 0xaa);
-    //     SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
-    //     SDL_RenderDrawPointF(renderer, points[i].position.x, points[i].position.y - 3.0f);
-    // }
-    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_ADD);
-    texman->particle.setBlendMode(SDL_BLENDMODE_ADD);
-    Polygons::renderPolygon(renderer, texman->particle.getTexture(), points, indices);
-    SDL_Rect fillRect{_pos.x * TILE_SIZE - scrollX, _pos.y * TILE_SIZE - scrollY, _dimensions.x * TILE_SIZE, _dimensions.y * TILE_SIZE};
-    texman->particle.setBlendMode(SDL_BLENDMODE_NONE);
-    
-    std::vector<SDL_Point> line;
-    line.resize(std::size(_Springs));
-    for (int i{0}; i < static_cast<int>(std::size(_Springs)); ++i)
+void Lava::handlePlayer(TexMan* texman, Player* player)
+{
+    WaveSurface& surface{_Body.getSurface()};
+    surface.setVel(surface.getIndex(player->getCenter().x), -30.0);
+    player->setLavaStruck(true);
+    texman->SFX_water_out.play();
+    texman->SFX_fire.play();
+}
+
+void Lava::update(const double& time_step, const int scrollX, const int scrollY, const int width, const int height, SDL_Renderer* renderer, TexMan* texman, Player* player)
+{
+    const bool visible{_Body.isVisible(scrollX, scrollY, width, height)};
+    if (_Body.getSleeping() && (visible || _Body.isDisturbed(player)))
     {
-        line[i] = SDL_Point{static_cast<int>(_Springs[i]->pos.x) - scrollX, static_cast<int>(_Springs[i]->pos.y) - scrollY};
+        _Body.wake();
     }
-    SDL_SetRenderDrawColor(renderer, 0xff, 0xff, 0xff, 0xaa);
-    SDL_RenderDrawLines(renderer, line.data(), static_cast<int>(line.size()));
-    for (int j{0}; j < _dimensions.y * TILE_SIZE - 8; ++j)
+    if (!_Body.getSleeping())
     {
-        line.clear();
-        line.resize(std::size(_Springs));
-        for (int i{0}; i < static_cast<int>(std::size(_Springs)); ++i)
+        const bool settled{simulate(time_step, player, visible)};
+        if (_Body.rest(time_step, settled, visible))
         {
-            line[i] = SDL_Point{static_cast<int>(_Springs[i]->pos.x) - scrollX, static_cast<int>(_Springs[i]->pos.y) - scrollY + 1 + j};
+            sleep();
         }
-        SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_ADD);
-        SDL_SetRenderDrawColor(renderer, 0xff, 0x76, 0x00, static_cast<Uint8>(static_cast<int>(static_cast<double>(_dimensions.y * TILE_SIZE - 8 - j) / static_cast<double>(_dimensions.y * TILE_SIZE - 8) * 200.0)));
-        SDL_RenderDrawLines(renderer, line.data(), static_cast<int>(line.size()));
     }
-    //SDL_RenderFillRect(renderer, &fillRect);
-    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
-    if (Util::checkCollision(player->getRect(), getRect()))
+    if (visible)
     {
-        double player_x{player->getCenter().x - static_cast<double>(_pos.x * TILE_SIZE)};
-        player_x = player_x / _spacing;
-        int spring_x {std::min(static_cast<int>(_Springs.size() - 1), std::max(0, static_cast<int>(player_x)))};
-        _Springs[spring_x]->vel = -30;
-        player->setLavaStruck(true);
-        texman->SFX_water_out.play();
-        texman->SFX_fire.play();
+        render(time_step, scrollX, scrollY, renderer, texman);
     }
 }
 
@@ -389,10 +380,10 @@ void LavaManager::loadFromFile(const char* path)
     f.close();
 }
 
-void LavaManager::update(const double& time_step, const int scrollX, const int scrollY, SDL_Renderer* renderer, TexMan* texman, Player* player)
+void LavaManager::update(const double& time_step, const int scrollX, const int scrollY, const int width, const int height, SDL_Renderer* renderer, TexMan* texman, Player* player)
 {
     for (std::size_t i{0}; i < _Lava.size(); ++i)
     {
-        _Lava[i]->update(time_step, scrollX, scrollY, renderer, texman, player);
+        _Lava[i]->update(time_step, scrollX, scrollY, width, height, renderer, texman, player);
     }
 }
\ No newline at end of file
@@ -10,6 +10,7 @@
 #include "./polygons.hpp"
 #include "./player.hpp"
 #include "./timer.hpp"
+#include "./waves.hpp"
 
 #include <vector>
 #include <cmath>
@@ -23,40 +24,96 @@ struct LavaGlow // for the lava
     vec2<double> pos;
     vec2<double> vel;
     double size;
+    bool dead{false};
 };
 
-struct WaterSpring
+// surface tuning, spacing gets overwritten by whatever the manager passes in
+inline constexpr WaveConfig WATER_WAVES{1.0, 0.165f, 0.165f, 0.165f, 2, 0.5f, 1.0f};
+inline constexpr SDL_Color WATER_COLOR{0x28, 0xca, 0xb1, 0xaa};
+inline constexpr SDL_Color WATER_LINE_COLOR{0xb2, 0xde, 0xd8, 0x88}; // along the surface
+inline constexpr WaveConfig LAVA_WAVES{1.0, 0.077f, 0.077f, 0.1155f, 2, 0.5f, 1.0f}; // lava is thicker, but drags its neighbours along more
+
+// bodies this far outside the view still count as visible, so they wake up before they scroll in
+inline constexpr int FLUID_VIEW_MARGIN{32};
+// how long (in frames) an off-screen body has to stay settled before it goes to sleep
+inline constexpr double FLUID_SLEEP_TIME{60.0};
+// a surface counts as settled when every spring is within this of its rest height and speed
+inline constexpr double FLUID_REST_HEIGHT{1.5};
+inline constexpr double FLUID_REST_VEL{0.5};
+
+// the parts water & lava share: a spring surface across the top of a rect of tiles, the buffers it's
+// drawn from, the player stirring it up, and going to sleep when it's settled & off screen
+class FluidSurface
 {
-    vec2<double> pos;
-    double target_y;
-    double vel{0};
+private:
+    vec2<int> _pos{0, 0}; // relative tile pos
+    vec2<int> _dimensions{0, 0}; // relative tile dimensions
+
+    // the render buffers are sized once in load() and reused every frame
+    WaveSurface _Surface{};
+    std::vector<SDL_Vertex> _Points{}; // surface vertices, then the bottom row
+    std::vector<int> _Indices{};
+    std::vector<SDL_Point> _Line{};
+    SDL_Rect _Rect{0, 0, 0, 0};
+
+    // rest detection
+    bool _sleeping{false};
+    double _rest{0.0}; // frames spent settled and off-screen
+
+public:
+    FluidSurface()
+    {
+    }
+
+    // just the surface & rect, for something that draws itself (the cell fluid)
+    void init(vec2<int> pos, vec2<int> dimensions, const WaveConfig& config);
+    // the surface plus the buffers it's drawn from
+    void load(vec2<int> pos, vec2<int> dimensions, const WaveConfig& config, const SDL_Color col);
+    void clear();
+
+    SDL_Rect* getRect() {return &_Rect;}
+    WaveSurface& getSurface() {return _Surface;}
+    const WaveSurface& getSurface() const {return _Surface;}
+    bool getSleeping() const {return _sleeping;}
+    vec2<int> getDimensions() const {return _dimensions;}
+    std::vector<SDL_Vertex>& getPoints() {return _Points;}
+    const std::vector<int>& getIndices() const {return _Indices;}
+    std::vector<SDL_Point>& getLine() {return _Line;}
+
+    bool isVisible(const int scrollX, const int scrollY, const int width, const int height);
+    bool isDisturbed(Player* player);
+    void disturb(const double& time_step, Player* player);
+    void sleep();
+    void wake();
+    // counts up while settled & off screen, gives back true once it's been long enough to sleep
+    bool rest(const double& time_step, const bool settled, const bool visible);
+
+    // moves the vertices & the surface line to where the springs are on screen
+    void updateBuffers(const int scrollX, const int scrollY);
 };
 
 class Water
 {
 private:
-    vec2<int> _pos; // relative tile pos
-    vec2<int> _dimensions; // relative tile dimensions
     double _spacing;
-
-    double _tension{0.15};
-
-    std::vector<WaterSpring*> _Springs{};
-    SDL_Rect _Rect;
-
-    Timer timer{};
+    FluidSurface _Body{};
 
 public:
     Water(vec2<int> pos, vec2<int> dimensions, double spacing);
     ~Water();
 
     void free();
-    void loadSprings();
+    void loadSprings(vec2<int> pos, vec2<int> dimensions);
 
-    SDL_Rect* getRect();
+    SDL_Rect* getRect() {return _Body.getRect();}
+    WaveSurface& getSurface() {return _Body.getSurface();}
+    bool getSleeping() {return _Body.getSleeping();}
+    void wake() {_Body.wake();}
 
-    void updateSpring(WaterSpring* spring, WaterSpring* left, WaterSpring* right, const double& time_step);
-    void update(const double& time_step, const int scrollX, const int scrollY, SDL_Renderer* renderer, TexMan* texman, Player* player);
+    // returns true if the surface is settled
+    bool simulate(const double& time_step, Player* player);
+    void render(const int scrollX, const int scrollY, SDL_Renderer* renderer, TexMan* texman);
+    void update(const double& time_step, const int scrollX, const int scrollY, const int width, const int height, SDL_Renderer* renderer, TexMan* texman, Player* player);
 };
 
 class WaterManager
@@ -77,37 +134,37 @@ public:
 
     void loadFromFile(const char* path);
 
-    void update(const double& time_step, const int scrollX, const int scrollY, SDL_Renderer* renderer, TexMan* texman, Player* player);
+    void update(const double& time_step, const int scrollX, const int scrollY, const int width, const int height, SDL_Renderer* renderer, TexMan* texman, Player* player);
 };
 
 class Lava
 {
 private:
-    vec2<int> _pos; // relative tile pos
-    vec2<int> _dimensions; // relative tile dimensions
     double _spacing;
+    FluidSurface _Body{};
 
-    double _tension{0.07};
-
-    std::vector<WaterSpring*> _Springs{};
-    SDL_Rect _Rect;
-
-    Timer timer{};
-    std::vector<LavaGlow*> _Glow;
+    std::vector<LavaGlow> _Glow;
 
 public:
     Lava(vec2<int> pos, vec2<int> dimensions, double spacing);
     ~Lava();
 
     void free();
-    void loadSprings();
+    void loadSprings(vec2<int> pos, vec2<int> dimensions);
     
     void addGlow(vec2<double> pos, vec2<double> vel);
 
-    SDL_Rect* getRect();
-
-    void updateSpring(WaterSpring* spring, WaterSpring* left, WaterSpring* right, const double& time_step);
-    void update(const double& time_step, const int scrollX, const int scrollY, SDL_Renderer* renderer, TexMan* texman, Player* player);
+    SDL_Rect* getRect() {return _Body.getRect();}
+    WaveSurface& getSurface() {return _Body.getSurface();}
+    bool getSleeping() {return _Body.getSleeping();}
+    void wake() {_Body.wake();}
+    void sleep();
+
+    bool simulate(const double& time_step, Player* player, const bool visible);
+    void render(const double& time_step, const int scrollX, const int scrollY, SDL_Renderer* renderer, TexMan* texman);
+    // the player's touching it, from the game's trigger index
+    void handlePlayer(TexMan* texman, Player* player);
+    void update(const double& time_step, const int scrollX, const int scrollY, const int width, const int height, SDL_Renderer* renderer, TexMan* texman, Player* player);
 };
 
 class LavaManager
@@ -129,7 +186,7 @@ public:
 
     void loadFromFile(const char* path);
 
-    void update(const double& time_step, const int scrollX, const int scrollY, SDL_Renderer* renderer, TexMan* texman, Player* player);
+    void update(const double& time_step, const int scrollX, const int scrollY, const int width, const int height, SDL_Renderer* renderer, TexMan* texman, Player* player);
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,207 @@
+#include "./waves.hpp"
+
+namespace
+{
+    constexpr float TWO_PI{6.2831853f};
+    constexpr float TABLE_SCALE{static_cast<float>(WAVE_TABLE_SIZE) / TWO_PI}; // radians -> table units
+}
+
+const std::array<float, WAVE_TABLE_SIZE>& WaveSurface::getTable()
+{
+    static const std::array<float, WAVE_TABLE_SIZE> table{[]()
+    {
+        std::array<float, WAVE_TABLE_SIZE> values{};
+        for (int i{0}; i < WAVE_TABLE_SIZE; ++i)
+        {
+            values[i] = std::sin(static_cast<float>(i) / TABLE_SCALE);
+        }
+        return values;
+    }()};
+    return table;
+}
+
+WaveSurface::WaveSurface(const double x, const double rest_y, const double width, const WaveConfig& config)
+{
+    init(x, rest_y, width, config);
+}
+
+void WaveSurface::init(const double x, const double rest_y, const double width, const WaveConfig& config)
+{
+    _config = config;
+    _x = x;
+    _rest_y = rest_y;
+
+    const int num{static_cast<int>(std::floor(width / _config.spacing)) + 1};
+    _Height.assign(num, 0.0f);
+    _Vel.assign(num, 0.0f);
+    _Lap.assign(num, 0.0f);
+    _Base.assign(num, 0.0f);
+    for (std::size_t w{0}; w < AMBIENT_WAVES.size(); ++w)
+    {
+        _Offset[w].resize(num);
+        for (int i{0}; i < num; ++i)
+        {
+            const float angle{static_cast<float>(getX(i)) * AMBIENT_WAVES[w].frequency + AMBIENT_WAVES[w].phase};
+            _Offset[w][i] = static_cast<int>(angle * TABLE_SCALE) & WAVE_TABLE_MASK;
+        }
+    }
+    _phase.fill(0.0f);
+    _accumulator = 0.0;
+}
+
+void WaveSurface::clear()
+{
+    _Height.clear();
+    _Vel.clear();
+    _Lap.clear();
+    _Base.clear();
+    for (std::vector<int>& offset : _Offset)
+    {
+        offset.clear();
+    }
+}
+
+int WaveSurface::update(const double& time_step)
+{
+    _accumulator = std::min(_accumulator + time_step, WAVE_STEP * WAVE_MAX_STEPS);
+    int steps{0};
+    while (_accumulator >= WAVE_STEP)
+    {
+        step();
+        _accumulator -= WAVE_STEP;
+        ++steps;
+    }
+    return steps;
+}
+
+void WaveSurface::step()
+{
+    const int num{getSize()};
+    if (num == 0)
+    {
+        return;
+    }
+    const std::array<float, WAVE_TABLE_SIZE>& table{getTable()};
+    float* height{_Height.data()};
+    float* vel{_Vel.data()};
+    float* lap{_Lap.data()};
+
+    // idle waves, only on springs that aren't already in the middle of a splash
+    for (std::size_t w{0}; w < AMBIENT_WAVES.size(); ++w)
+    {
+        const int phase{static_cast<int>(_phase[w])};
+        const int* offset{_Offset[w].data()};
+        const float amplitude{AMBIENT_WAVES[w].amplitude * _config.ambient};
+        for (int i{0}; i < num; ++i)
+        {
+            const float gate{std::abs(height[i]) < 3.0f ? 1.0f : 0.0f};
+            vel[i] += table[(phase + offset[i]) & WAVE_TABLE_MASK] * amplitude * gate;
+        }
+        _phase[w] += AMBIENT_WAVES[w].rate * TABLE_SCALE;
+        if (_phase[w] >= static_cast<float>(WAVE_TABLE_SIZE))
+        {
+            _phase[w] -= static_cast<float>(WAVE_TABLE_SIZE);
+        }
+    }
+
+    // spring back to rest
+    const float tension{_config.tension};
+    const float damping{_config.damping};
+    for (int i{0}; i < num; ++i)
+    {
+        vel[i] -= height[i] * tension + vel[i] * damping;
+    }
+
+    // propagate to the neighbours, split into passes so waves can travel further than one spring per step
+    const int passes{std::max(1, _config.passes)};
+    const float spread{_config.spread / static_cast<float>(passes)};
+    const float speed{_config.speed / static_cast<float>(passes)};
+    for (int p{0}; p < passes; ++p)
+    {
+        // edges are mirrored
+        lap[0] = (num > 1) ? height[1] - height[0] : 0.0f;
+        lap[num - 1] = (num > 1) ? height[num - 2] - height[num - 1] : 0.0f;
+        for (int i{1}; i < num - 1; ++i)
+        {
+            lap[i] = height[i - 1] + height[i + 1] - height[i] * 2.0f;
+        }
+        for (int i{0}; i < num; ++i)
+        {
+            vel[i] += lap[i] * spread;
+            height[i] += vel[i] * speed;
+        }
+    }
+}
+
+void WaveSurface::disturb(const int i, const double force)
+{
+    if (i >= 0 && i < getSize())
+    {
+        _Vel[i] += static_cast<float>(force);
+    }
+}
+
+void WaveSurface::disturbArea(const double x, const double y, const double w, const double h, const double vel_x, const double vel_y, const double& time_step)
+{
+    if (std::abs(vel_y) <= 0.5 && std::abs(vel_x) <= 0.5)
+    {
+        return;
+    }
+    const double force{(std::max(-3.0, std::min(8.0, vel_y * 3.0)) + -std::abs(std::max(-3.0, std::min(3.0, vel_x)))) * 0.5 * time_step};
+    // only the springs under it can be touching it
+    const int last{getIndex(x + w)};
+    for (int i{getIndex(x)}; i <= last; ++i)
+    {
+        const double spring_x{getX(i)};
+        const double spring_y{getY(i)};
+        if (spring_x >= x && spring_x < x + w && spring_y >= y && spring_y < y + h && std::abs(_Height[i]) < 3.0f)
+        {
+            disturb(i, force);
+        }
+    }
+}
+
+void WaveSurface::setVel(const int i, const double vel)
+{
+    if (i >= 0 && i < getSize())
+    {
+        _Vel[i] = static_cast<float>(vel);
+    }
+}
+
+void WaveSurface::reset()
+{
+    std::fill(_Height.begin(), _Height.end(), 0.0f);
+    std::fill(_Vel.begin(), _Vel.end(), 0.0f);
+}
+
+void WaveSurface::resetToAmbient(const double amount)
+{
+    const std::array<float, WAVE_TABLE_SIZE>& table{getTable()};
+    const int phase{static_cast<int>(_phase[0])};
+    const int num{getSize()};
+    for (int i{0}; i < num; ++i)
+    {
+        _Height[i] = table[(phase + _Offset[0][i]) & WAVE_TABLE_MASK] * static_cast<float>(amount);
+        _Vel[i] = 0.0f;
+    }
+}
+
+bool WaveSurface::isSettled(const double max_height, const double max_vel) const
+{
+    const int num{getSize()};
+    for (int i{0}; i < num; ++i)
+    {
+        if (std::abs(_Height[i]) > max_height || std::abs(_Vel[i]) > max_vel)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+int WaveSurface::getIndex(const double x) const
+{
+    const int i{static_cast<int>((x - _x) / _config.spacing)};
+    return std::max(0, std::min(getSize() - 1, i));
+}
@@ -0,0 +1,100 @@
+#ifndef WAVES_H
+#define WAVES_H
+
+#include <vector>
+#include <array>
+#include <cmath>
+#include <algorithm>
+
+// shared 1D wave solver for water & lava surfaces
+
+inline constexpr int WAVE_TABLE_SIZE{1024}; // has to be a power of two
+inline constexpr int WAVE_TABLE_MASK{WAVE_TABLE_SIZE - 1};
+inline constexpr double WAVE_STEP{1.0}; // fixed step, in frames @ 60fps
+inline constexpr int WAVE_MAX_STEPS{4}; // don't spiral when the frame rate tanks
+
+struct WaveConfig
+{
+    double spacing{1.0}; // px between springs
+    float tension{0.165f}; // pull back to the rest height
+    float damping{0.165f};
+    float spread{0.165f}; // how strongly neighbours drag each other along
+    int passes{2}; // propagation sub-steps per step
+    float speed{0.5f}; // velocity -> height scale
+    float ambient{1.0f}; // strength of the idle waves
+};
+
+// the idle waves used to be three trig calls per spring per frame, now it's three table lookups
+struct AmbientWave
+{
+    float amplitude;
+    float rate; // radians per step
+    float frequency; // radians per px
+    float phase; // radians, cos is just sin shifted by a quarter turn
+};
+
+inline constexpr std::array<AmbientWave, 3> AMBIENT_WAVES{{
+    {0.05f, 0.002f * 1000.0f / 60.0f, 0.6f, 0.0f},
+    {0.02f, 0.005f * 1000.0f / 60.0f, 0.8f, 1.5707964f},
+    {0.03f, 0.006f * 1000.0f / 60.0f, 0.7f, 1.5707964f}
+}};
+
+class WaveSurface
+{
+private:
+    WaveConfig _config;
+    double _x{0.0}; // px pos of the first spring
+    double _rest_y{0.0}; // px height of the surface at rest
+
+    // structure of arrays, so the inner loops stay tight
+    std::vector<float> _Height{}; // offset from rest height, +ve is down
+    std::vector<float> _Vel{};
+    std::vector<float> _Lap{};
+    std::vector<float> _Base{}; // px each spring's rest sits below rest_y, 0 unless the surface isn't flat
+    std::array<std::vector<int>, AMBIENT_WAVES.size()> _Offset{}; // per spring table offset for each ambient wave
+
+    std::array<float, AMBIENT_WAVES.size()> _phase{}; // in table units
+    double _accumulator{0.0};
+
+    static const std::array<float, WAVE_TABLE_SIZE>& getTable();
+
+    void step();
+
+public:
+    WaveSurface()
+    {
+    }
+
+    WaveSurface(const double x, const double rest_y, const double width, const WaveConfig& config);
+
+    void init(const double x, const double rest_y, const double width, const WaveConfig& config);
+    void clear();
+
+    // steps the solver at a fixed rate, returns the number of steps taken
+    int update(const double& time_step);
+
+    // add velocity to a spring
+    void disturb(const int i, const double force);
+    // something moving through the surface, pushes the springs inside the area (px) it covers
+    void disturbArea(const double x, const double y, const double w, const double h, const double vel_x, const double vel_y, const double& time_step);
+    // for surfaces that follow the fluid under them (the cell fluid)
+    void setBase(const int i, const double base) {_Base[i] = static_cast<float>(base);}
+    void setVel(const int i, const double vel);
+    // flatten everything out
+    void reset();
+    // set the surface to the shape of the idle waves, so switching back to the simulation isn't visible
+    void resetToAmbient(const double amount);
+    bool isSettled(const double max_height, const double max_vel) const;
+
+    int getIndex(const double x) const;
+    int getSize() const {return static_cast<int>(_Height.size());}
+    double getX(const int i) const {return _x + _config.spacing * static_cast<double>(i);}
+    double getY(const int i) const {return _rest_y + static_cast<double>(_Base[i] + _Height[i]);}
+    double getRestY() const {return _rest_y;}
+    double getOffset(const int i) const {return static_cast<double>(_Height[i]);}
+    double getVel(const int i) const {return static_cast<double>(_Vel[i]);}
+    double getSpacing() const {return _config.spacing;}
+    const WaveConfig& getConfig() const {return _config;}
+};
+
+#endif
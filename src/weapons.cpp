@@ -11,18 +11,17 @@ Slash::Slash(bool vflip, bool flip, vec2<double> offset, TexMan* texman)
 
 Slash::~Slash()
 {
-    delete _anim;
 }
 
 void Slash::loadAnim(TexMan* texman)
 {
-    _anim = new Anim(16, 16, 15, 1.5, false, &(texman->slash));
+    _tex = &(texman->*SLASH_CLIP.texture);
 }
 
 void Slash::update(const double& time_step)
 {
-    _anim->tick(time_step);
-    _finished = _anim->getFinished();
+    _Anim.tick(time_step);
+    _finished = _Anim.getFinished();
 }
 
 void Slash::render(const int scrollX, const int scrollY, SDL_Renderer* renderer, void* target)
@@ -34,12 +33,12 @@ void Slash::render(const int scrollX, const int scrollY, SDL_Renderer* renderer,
     _flip = player->getFlipped();
     if (_vflip && _flip)
     {
-        _anim->setAngle(180.0);
+        _angle = 180.0;
     } else {
-        _anim->setFlipped(_vflip ? SDL_FLIP_VERTICAL : _anim->getFlipped());
-        _anim->setFlipped(_flip ? SDL_FLIP_HORIZONTAL : _anim->getFlipped());
+        _flipped = _vflip ? SDL_FLIP_VERTICAL : _flipped;
+        _flipped = _flip ? SDL_FLIP_HORIZONTAL : _flipped;
     }
-    _anim->render((int)render_pos.x, (int)render_pos.y, scrollX, scrollY, renderer);
+    _Anim.render(*_tex, (int)render_pos.x, (int)render_pos.y, scrollX, scrollY, renderer, _angle, _flipped);
 }
 
 // -------------------------------------------------- Sword -------------------------------------------------- //
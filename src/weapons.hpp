@@ -7,13 +7,18 @@
 
 // -------------------------------------------------- Slash -------------------------------------------------- //
 
+inline constexpr ClipDef SLASH_CLIP{&TexMan::slash, {16, 16, 15, 1.5, false}};
+
 class Slash
 {
 private:
     bool _vflip; // flipped vertically?
     bool _flip; // flipped horizontally?
     vec2<double> _offset;
-    Anim* _anim;
+    Anim _Anim{SLASH_CLIP.anim};
+    Texture* _tex{nullptr};
+    SDL_RendererFlip _flipped{SDL_FLIP_NONE};
+    double _angle{0.0};
     bool _finished{false};
 
 public: